@@ -0,0 +1,169 @@
+/**
+*******************************************************************************
+*
+*  @file       BenchmarkRunner.cpp
+*
+*  @brief      Class to time the hot paths and write the results as JSON
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "BenchmarkRunner.h"
+
+//------------------------------------------------------------------------------
+Types::float_matrix BenchmarkRunner::createSyntheticImage(unsigned int size)
+//------------------------------------------------------------------------------
+{
+	Types::float_matrix image(size, Types::float_line(size));
+
+	//Linear congruential generator, identical on every platform
+	unsigned int seed(12345u);
+
+	for(unsigned int i(0); i < size; i++)
+	{
+		for(unsigned int j(0); j < size; j++)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			float noise(float(seed >> 8) / float(1u << 24));
+
+			float x(float(i) / float(size)), y(float(j) / float(size));
+
+			//Smooth hills, terraces for the edges and a bit of noise
+			float height(0.5f + 0.25f * sinf(6.f * float(M_PI) * x) * cosf(4.f * float(M_PI) * y));
+			height = floorf(height * 8.f) / 8.f;
+
+			image[i][j] = std::min(1.f, std::max(0.f, 0.9f * height + 0.1f * noise));
+		}
+	}
+
+	return image;
+}
+
+//------------------------------------------------------------------------------
+std::vector<double> BenchmarkRunner::measure(unsigned int repeatCount,
+											 std::function<void()> const& prepare,
+											 std::function<void()> const& function)
+//------------------------------------------------------------------------------
+{
+	std::vector<double> durationsMs;
+
+	for(unsigned int repeat(0); repeat < repeatCount; repeat++)
+	{
+		if(prepare)
+			prepare();
+
+		std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+
+		function();
+
+		std::chrono::duration<double, std::milli> duration(std::chrono::steady_clock::now() - start);
+		durationsMs.push_back(duration.count());
+	}
+
+	return durationsMs;
+}
+
+//------------------------------------------------------------------------------
+void BenchmarkRunner::addResult(Result const& result)
+//------------------------------------------------------------------------------
+{
+	if(!result.durationsMs.empty())
+		m_results.push_back(result);
+}
+
+//------------------------------------------------------------------------------
+double BenchmarkRunner::getMedian(std::vector<double> values)
+//------------------------------------------------------------------------------
+{
+	std::sort(values.begin(), values.end());
+
+	size_t middle(values.size() / 2);
+
+	if(values.size() % 2)
+		return values[middle];
+	else
+		return (values[middle - 1] + values[middle]) / 2.;
+}
+
+//------------------------------------------------------------------------------
+double BenchmarkRunner::getPercentile(std::vector<double> values, double percent)
+//------------------------------------------------------------------------------
+{
+	std::sort(values.begin(), values.end());
+
+	//nearest rank
+	size_t rank(size_t(ceil(percent / 100. * double(values.size()))));
+
+	return values[std::min(values.size() - 1, std::max(rank, size_t(1)) - 1)];
+}
+
+//------------------------------------------------------------------------------
+BenchmarkRunner::Result const* BenchmarkRunner::findSingleThreadResult(Result const& result) const
+//------------------------------------------------------------------------------
+{
+	for(Result const& singleThreadResult : m_results)
+	{
+		if(singleThreadResult.threadCount == 1 && singleThreadResult.name == result.name &&
+				singleThreadResult.size == result.size && singleThreadResult.mode == result.mode)
+			return &singleThreadResult;
+	}
+
+	return nullptr;
+}
+
+//------------------------------------------------------------------------------
+void BenchmarkRunner::writeJson(std::ostream &stream) const
+//------------------------------------------------------------------------------
+{
+	stream << "{" << std::endl;
+	stream << "  \"hardwareConcurrency\": " << std::thread::hardware_concurrency() << "," << std::endl;
+	stream << "  \"results\": [" << std::endl;
+
+	for(size_t resultIndex(0); resultIndex < m_results.size(); resultIndex++)
+	{
+		Result const& result(m_results[resultIndex]);
+
+		double medianMs(getMedian(result.durationsMs));
+		double minMs(*std::min_element(result.durationsMs.begin(), result.durationsMs.end()));
+
+		stream << "    {\"benchmark\": \"" << result.name << "\"";
+
+		if(!result.mode.empty())
+			stream << ", \"mode\": \"" << result.mode << "\"";
+
+		stream << ", \"size\": " << result.size
+			<< ", \"threads\": " << result.threadCount
+			<< ", \"repetitions\": " << result.durationsMs.size()
+			<< ", \"medianMs\": " << medianMs
+			<< ", \"minMs\": " << minMs
+			<< ", \"p50Ms\": " << getPercentile(result.durationsMs, 50.)
+			<< ", \"p90Ms\": " << getPercentile(result.durationsMs, 90.)
+			<< ", \"p99Ms\": " << getPercentile(result.durationsMs, 99.)
+			<< ", \"nsPerPixel\": " << medianMs * 1e6 / double(std::max(result.pixelCount, 1LL))
+			<< ", \"gbPerS\": " << double(result.byteCount) / (medianMs * 1e6);
+
+		//Speedup divided by the number of threads, 1 for a perfect scaling
+		Result const* singleThreadResult(findSingleThreadResult(result));
+
+		if(singleThreadResult)
+		{
+			stream << ", \"scalingEfficiency\": "
+				<< getMedian(singleThreadResult->durationsMs) / (medianMs * double(result.threadCount));
+		}
+
+		stream << "}" << (resultIndex + 1 < m_results.size() ? "," : "") << std::endl;
+	}
+
+	stream << "  ]" << std::endl;
+	stream << "}" << std::endl;
+}
@@ -0,0 +1,110 @@
+#ifndef BENCHMARKRUNNER_H
+#define BENCHMARKRUNNER_H
+
+/**
+*******************************************************************************
+*
+*  @file       BenchmarkRunner.h
+*
+*  @brief      Class to time the hot paths and write the results as JSON
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <string>
+#include <vector>
+#include <ostream>
+#include <functional>
+
+#include "tools/Types.h"
+
+
+//==============================================================================
+/**
+*  @class  BenchmarkRunner
+*  @brief  BenchmarkRunner is a class to time the hot paths over synthetic
+*			images and write the throughput, the scaling and the distribution
+*			of the durations as JSON
+*/
+//==============================================================================
+class BenchmarkRunner
+{
+public:
+	/**
+	 * @brief The Result struct the measures of a benchmark for a size and a number of threads
+	 */
+	struct Result
+	{
+		std::string name;
+		unsigned int size; //number of rows and columns of the image
+		unsigned int threadCount;
+		std::vector<double> durationsMs; //one per repetition
+		long long pixelCount; //pixels processed by one repetition
+		long long byteCount; //bytes read and written by one repetition
+		std::string mode; //variant of the benchmark, such as the mesh mode, empty if none
+	};
+
+	/**
+	 * @brief createSyntheticImage create a reproducible terrain with edges
+	 * @param size number of rows and columns
+	 * @return the image, in the [0,1] range
+	 */
+	static Types::float_matrix createSyntheticImage(unsigned int size);
+
+	/**
+	 * @brief measure time a function several times
+	 * @param repeatCount number of repetitions
+	 * @param prepare called before each repetition, not timed
+	 * @param function the function to time
+	 * @return the duration of each repetition in milliseconds
+	 */
+	static std::vector<double> measure(unsigned int repeatCount,
+									   std::function<void()> const& prepare,
+									   std::function<void()> const& function);
+
+	/**
+	 * @brief addResult store the result of a benchmark
+	 * @param result the result
+	 */
+	void addResult(Result const& result);
+
+	/**
+	 * @brief writeJson write all the results: median and minimum durations, percentiles,
+	 * ns per pixel, GB/s and the scaling efficiency compared with the single thread result
+	 * @param stream where to write
+	 */
+	void writeJson(std::ostream &stream) const;
+
+//******************************************************************************
+private:
+	/**
+	 * @brief getMedian
+	 * @param values some values, not empty
+	 * @return the median of the values
+	 */
+	static double getMedian(std::vector<double> values);
+
+	/**
+	 * @brief getPercentile
+	 * @param values some values, not empty
+	 * @param percent in the [0,100] range
+	 * @return the smallest value greater or equal to percent % of the values
+	 */
+	static double getPercentile(std::vector<double> values, double percent);
+
+	/**
+	 * @brief findSingleThreadResult
+	 * @param result a result
+	 * @return the result of the same benchmark, size and mode with one thread, null if none
+	 */
+	Result const* findSingleThreadResult(Result const& result) const;
+
+	std::vector<Result> m_results;
+};
+
+#endif // BENCHMARKRUNNER_H
@@ -0,0 +1,29 @@
+TARGET = benchmarks
+TEMPLATE = app
+
+QT       += core gui
+
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += ../src
+
+HEADERS += BenchmarkRunner.h
+
+SOURCES += main.cpp \
+    BenchmarkRunner.cpp \
+    ../src/imageProcessing/ImageProcessor.cpp \
+    ../src/rendering/HeightMapMesh.cpp \
+    ../src/rendering/Mesh.cpp \
+    ../src/rendering/SoftwareRenderer.cpp \
+    ../src/rendering/ColourRamp.cpp \
+    ../src/terrainAnalysis/HeightPyramid.cpp \
+    ../src/terrainAnalysis/HeightFieldTracer.cpp \
+    ../src/terrainAnalysis/Viewshed.cpp \
+    ../src/tools/MatrixPool.cpp \
+    ../src/tools/DirtyRanges.cpp \
+    ../src/tools/Instrumentation.cpp \
+    ../src/tools/Tracer.cpp \
+    ../src/tools/PerfCounters.cpp
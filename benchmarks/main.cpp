@@ -0,0 +1,327 @@
+/**
+*******************************************************************************
+*
+*  @file       main.cpp
+*
+*  @brief      Benchmark of the CPU hot paths over synthetic images of several sizes,
+*				with several numbers of threads. Write the results as JSON.
+*
+*  usage: benchmarks [--sizes 256,512,...] [--threads 1,2,...] [--repeat n]
+*			[--mesh-max-size n] [--index-max-size n] [--output file.json]
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <memory>
+#include <cstdlib>
+
+#include "BenchmarkRunner.h"
+#include "imageProcessing/ImageProcessor.h"
+#include "rendering/HeightMapMesh.h"
+#include "rendering/SoftwareRenderer.h"
+#include "terrainAnalysis/Viewshed.h"
+#include "tools/ParallelTool.h"
+#include "tools/Instrumentation.h"
+
+//******************************************************************************
+//  constant variables
+//******************************************************************************
+//bytes of a vertex: position and normal, the colour is read from the height by the shader
+const long long VERTEX_BYTES = 2 * 3 * sizeof(float);
+
+//the exact viewshed is O(n^3), only timed on the small images
+const unsigned int VIEWSHED_R3_MAX_SIZE = 512;
+
+//size of the software rendered snapshots
+const unsigned int SNAPSHOT_WIDTH = 1920;
+const unsigned int SNAPSHOT_HEIGHT = 1080;
+
+///@cond
+/**
+ * @brief The Options struct the settings given on the command line
+ */
+struct Options
+{
+	std::vector<unsigned int> sizes = {256, 512, 1024, 2048, 4096};
+	std::vector<unsigned int> threadCounts;
+	unsigned int repeatCount = 5;
+	//the meshes use 144 bytes per pixel, creating the index is much slower
+	unsigned int meshMaxSize = 2048;
+	unsigned int indexMaxSize = 1024;
+	std::string outputFile;
+};
+///@endcond
+
+/**
+ * @brief parseList parse a comma separated list of numbers
+ * @param text the list
+ * @return the numbers
+ */
+std::vector<unsigned int> parseList(std::string const& text)
+{
+	std::vector<unsigned int> values;
+	std::istringstream stream(text);
+	std::string value;
+
+	while(std::getline(stream, value, ','))
+		values.push_back((unsigned int)(std::strtoul(value.c_str(), nullptr, 10)));
+
+	return values;
+}
+
+/**
+ * @brief parseOptions read the command line
+ * @return the options
+ * @throws std::runtime_error if an option is unknown
+ */
+Options parseOptions(int argc, char *argv[])
+{
+	Options options;
+
+	for(int arg(1); arg + 1 < argc; arg += 2)
+	{
+		std::string name(argv[arg]), value(argv[arg + 1]);
+
+		if(name == "--sizes")
+			options.sizes = parseList(value);
+		else if(name == "--threads")
+			options.threadCounts = parseList(value);
+		else if(name == "--repeat")
+			options.repeatCount = (unsigned int)(std::strtoul(value.c_str(), nullptr, 10));
+		else if(name == "--mesh-max-size")
+			options.meshMaxSize = (unsigned int)(std::strtoul(value.c_str(), nullptr, 10));
+		else if(name == "--index-max-size")
+			options.indexMaxSize = (unsigned int)(std::strtoul(value.c_str(), nullptr, 10));
+		else if(name == "--output")
+			options.outputFile = value;
+		else
+			throw std::runtime_error("Unknown option " + name);
+	}
+
+	//ParallelTool splits in halves: use powers of two up to the number of cores
+	if(options.threadCounts.empty())
+	{
+		for(unsigned int threadCount(1); threadCount <= std::max(1u, std::thread::hardware_concurrency());
+			threadCount *= 2)
+		{
+			options.threadCounts.push_back(threadCount);
+		}
+	}
+
+	return options;
+}
+
+/**
+ * @brief benchmarkImageProcessor time each stage of the processing,
+ * thanks to the timers of the instrumentation
+ */
+void benchmarkImageProcessor(BenchmarkRunner &runner, Types::shared_matrix const& image,
+							 unsigned int size, unsigned int threadCount, unsigned int repeatCount)
+{
+	const ImageProcessor::Stage STAGES[] = {ImageProcessor::LINEAR_FILTERING,
+		ImageProcessor::GRADIENT_NORM, ImageProcessor::CANNY_ALGORITHM};
+
+	//floats read and written per pixel by each stage
+	const long long STAGE_FLOATS[] = {2, 3, 3};
+
+	std::vector<double> durationsMs[3];
+	ImageProcessor imageProcessor;
+
+	for(unsigned int repeat(0); repeat < repeatCount; repeat++)
+	{
+		Instrumentation::resetTimers();
+		imageProcessor.setRawData(image, size, size);
+
+		ProcessingStats stats(Instrumentation::getStats());
+
+		for(unsigned int stage(0); stage < 3; stage++)
+			durationsMs[stage].push_back(stats.timers[ImageProcessor::getStageName(STAGES[stage])].totalMs);
+	}
+
+	for(unsigned int stage(0); stage < 3; stage++)
+	{
+		long long pixelCount((long long)(size) * size);
+
+		runner.addResult({ImageProcessor::getStageName(STAGES[stage]), size, threadCount,
+			durationsMs[stage], pixelCount, pixelCount * STAGE_FLOATS[stage] * (long long)(sizeof(float))});
+	}
+}
+
+/**
+ * @brief benchmarkMesh time the creation of the mesh, the creation of its index
+ * and the copy of its vertices into a single upload buffer
+ */
+void benchmarkMesh(BenchmarkRunner &runner, Options const& options, Types::shared_matrix const& image,
+				   unsigned int size, unsigned int threadCount)
+{
+	long long pixelCount((long long)(size) * size);
+	long long vertexCount((long long)(size - 1) * (size - 1) * 6);
+
+	std::unique_ptr<HeightMapMesh> mesh;
+
+	runner.addResult({"HeightMapMesh::create", size, threadCount,
+		BenchmarkRunner::measure(options.repeatCount,
+			[&mesh]()
+			{
+				mesh.reset();
+			},
+			[&mesh, &image, size]()
+			{
+				mesh.reset(new HeightMapMesh(*image, size, size));
+			}),
+		pixelCount, pixelCount * (long long)(sizeof(float)) + vertexCount * VERTEX_BYTES});
+
+	//Vertex packing: the bytes handed to glBufferData, gathered in one buffer
+	std::vector<float> uploadBuffer;
+
+	runner.addResult({"vertexPacking", size, threadCount,
+		BenchmarkRunner::measure(options.repeatCount, std::function<void()>(),
+			[&mesh, &uploadBuffer]()
+			{
+				Types::vertices_data positions(mesh->getVerticesPosition()),
+					normals(mesh->getVerticesNormal());
+
+				uploadBuffer.resize((positions.size() + normals.size()) * 3);
+				float *destination(uploadBuffer.data());
+
+				for(Types::vertices_data const* attribute : {&positions, &normals})
+				{
+					for(QVector3D const& vector : *attribute)
+					{
+						*(destination++) = vector.x();
+						*(destination++) = vector.y();
+						*(destination++) = vector.z();
+					}
+				}
+			}),
+		pixelCount, 3 * vertexCount * VERTEX_BYTES});
+
+	if(size <= options.indexMaxSize)
+	{
+		runner.addResult({"Mesh::setIndex", size, threadCount,
+			BenchmarkRunner::measure(options.repeatCount,
+				[&mesh, &image, size]()
+				{
+					//setIndex does nothing on a mesh that already has an index
+					mesh.reset();
+					mesh.reset(new HeightMapMesh(*image, size, size));
+				},
+				[&mesh]()
+				{
+					mesh->setIndex();
+				}),
+			pixelCount, vertexCount * (VERTEX_BYTES + (long long)(sizeof(unsigned int)))});
+	}
+}
+
+/**
+ * @brief benchmarkSoftwareRenderer time a 1080p snapshot from the default camera of the render window
+ */
+void benchmarkSoftwareRenderer(BenchmarkRunner &runner, Options const& options, Types::shared_matrix const& image,
+							   unsigned int size, unsigned int threadCount)
+{
+	SoftwareRenderer renderer(image, size, size);
+
+	QMatrix4x4 pMatrix, vMatrix;
+	pMatrix.perspective(70.f, 16.f / 9.f, 0.1f, renderer.getWidth() + renderer.getLength());
+	vMatrix.lookAt(QVector3D(renderer.getLength()/2, renderer.getWidth()/2, 250.f),
+				   QVector3D(0.f, 0.f, -40.f), QVector3D(0.f, 0.f, 1.f));
+
+	runner.addResult({"SoftwareRenderer::render", size, threadCount,
+		BenchmarkRunner::measure(options.repeatCount, std::function<void()>(),
+			[&renderer, &pMatrix, &vMatrix]()
+			{
+				renderer.render(SNAPSHOT_WIDTH, SNAPSHOT_HEIGHT, pMatrix * vMatrix,
+								QVector3D(3.f, -3.f, 5.f).normalized());
+			}),
+		(long long)(size) * size, (long long)(SNAPSHOT_WIDTH) * SNAPSHOT_HEIGHT * (long long)(sizeof(QRgb))});
+}
+
+/**
+ * @brief benchmarkViewshed time the viewshed of an observer near the center,
+ * with each algorithm
+ */
+void benchmarkViewshed(BenchmarkRunner &runner, Options const& options, Types::shared_matrix const& image,
+					   unsigned int size, unsigned int threadCount)
+{
+	const Viewshed::Algorithm ALGORITHMS[] = {Viewshed::R3, Viewshed::R2, Viewshed::XDRAW};
+	const char *NAMES[] = {"Viewshed::compute R3", "Viewshed::compute R2", "Viewshed::compute XDRAW"};
+
+	for(unsigned int index(0); index < 3; index++)
+	{
+		Viewshed::Algorithm algorithm(ALGORITHMS[index]);
+
+		if(algorithm == Viewshed::R3 && size > VIEWSHED_R3_MAX_SIZE)
+			continue;
+
+		runner.addResult({NAMES[index], size, threadCount,
+			BenchmarkRunner::measure(options.repeatCount, std::function<void()>(),
+				[&image, size, algorithm]()
+				{
+					Viewshed::compute(*image, size, size, size / 3, size / 2, 2.f,
+									  HeightMapMesh::getHeightScale(size, size), algorithm);
+				}),
+			(long long)(size) * size, (long long)(size) * size * 2 * (long long)(sizeof(float))});
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	try
+	{
+		Options options(parseOptions(argc, argv));
+		BenchmarkRunner runner;
+
+		//The stage timers are enough, the trace and the counters would add noise
+		Tracer::stop();
+		PerfCounters::setEnabled(false);
+
+		for(unsigned int size : options.sizes)
+		{
+			std::cerr << "size " << size << std::endl;
+
+			Types::shared_matrix image(std::make_shared<const Types::float_matrix>(
+				BenchmarkRunner::createSyntheticImage(size)));
+
+			for(unsigned int threadCount : options.threadCounts)
+			{
+				ParallelTool::setDefaultParallelism((unsigned char)(threadCount));
+
+				benchmarkImageProcessor(runner, image, size, threadCount, options.repeatCount);
+
+				if(size <= options.meshMaxSize)
+					benchmarkMesh(runner, options, image, size, threadCount);
+
+				benchmarkSoftwareRenderer(runner, options, image, size, threadCount);
+
+				benchmarkViewshed(runner, options, image, size, threadCount);
+			}
+
+			//Do not keep the buffers of this size for the next ones
+			MatrixPool::getSharedPool()->trim();
+		}
+
+		if(options.outputFile.empty())
+			runner.writeJson(std::cout);
+		else
+		{
+			std::ofstream file(options.outputFile.c_str());
+			runner.writeJson(file);
+		}
+	}
+	catch(std::exception const& e)
+	{
+		std::cerr << "ERROR : " << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
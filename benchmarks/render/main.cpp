@@ -0,0 +1,315 @@
+/**
+*******************************************************************************
+*
+*  @file       main.cpp
+*
+*  @brief      Offscreen benchmark of the rendering: replay a camera path over height
+*				maps of several sizes in each mesh mode. Write, for each pass, the CPU
+*				time, the GPU time measured with timer queries and the frame times as JSON.
+*
+*  usage: renderBenchmarks [--sizes 256,512,...] [--path file.path] [--frames n]
+*			[--warmup n] [--width n] [--height n] [--output file.json]
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <stdexcept>
+#include <QGuiApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLTimerQuery>
+#include <QSurfaceFormat>
+
+#include "BenchmarkRunner.h"
+#include "rendering/ChunkedHeightMap.h"
+#include "rendering/HeightMapRenderer.h"
+#include "rendering/CameraPath.h"
+#include "tools/Tracer.h"
+#include "tools/PerfCounters.h"
+
+//******************************************************************************
+//  constant variables
+//******************************************************************************
+//bytes of a vertex: position and normal, the colour is read from the height by the shader
+const long long VERTEX_BYTES = 2 * 3 * sizeof(float);
+
+///@cond
+/**
+ * @brief The Options struct the settings given on the command line
+ */
+struct Options
+{
+	std::vector<unsigned int> sizes = {256, 512, 1024, 2048};
+	std::string pathFile; //orbit around the height map if empty
+	unsigned int frameCount = 120; //frames of the orbit
+	unsigned int warmupCount = 10; //frames rendered before the measures
+	unsigned int width = 1280;
+	unsigned int height = 720;
+	std::string outputFile;
+};
+
+/**
+ * @brief The FrameTimes struct the durations of each frame of a replay
+ */
+struct FrameTimes
+{
+	std::vector<double> shadowCpuMs, shadowGpuMs, sceneCpuMs, sceneGpuMs, frameMs;
+};
+///@endcond
+
+/**
+ * @brief parseList parse a comma separated list of numbers
+ * @param text the list
+ * @return the numbers
+ */
+std::vector<unsigned int> parseList(std::string const& text)
+{
+	std::vector<unsigned int> values;
+	std::istringstream stream(text);
+	std::string value;
+
+	while(std::getline(stream, value, ','))
+		values.push_back((unsigned int)(std::strtoul(value.c_str(), nullptr, 10)));
+
+	return values;
+}
+
+/**
+ * @brief parseOptions read the command line
+ * @return the options
+ * @throws std::runtime_error if an option is unknown
+ */
+Options parseOptions(int argc, char *argv[])
+{
+	Options options;
+
+	for(int arg(1); arg + 1 < argc; arg += 2)
+	{
+		std::string name(argv[arg]), value(argv[arg + 1]);
+
+		if(name == "--sizes")
+			options.sizes = parseList(value);
+		else if(name == "--path")
+			options.pathFile = value;
+		else if(name == "--frames")
+			options.frameCount = (unsigned int)(std::strtoul(value.c_str(), nullptr, 10));
+		else if(name == "--warmup")
+			options.warmupCount = (unsigned int)(std::strtoul(value.c_str(), nullptr, 10));
+		else if(name == "--width")
+			options.width = (unsigned int)(std::strtoul(value.c_str(), nullptr, 10));
+		else if(name == "--height")
+			options.height = (unsigned int)(std::strtoul(value.c_str(), nullptr, 10));
+		else if(name == "--output")
+			options.outputFile = value;
+		else
+			throw std::runtime_error("Unknown option " + name);
+	}
+
+	return options;
+}
+
+/**
+ * @brief getElapsedMs
+ * @param start the beginning of the measure
+ * @return the time since start in milliseconds
+ */
+double getElapsedMs(std::chrono::steady_clock::time_point const& start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief replay render each frame of the path to the target framebuffer.
+ * Wait for the GPU at the end of each frame so that the frames do not overlap
+ */
+FrameTimes replay(HeightMapRenderer &renderer, CameraPath const& path, Options const& options,
+				  QOpenGLFramebufferObject &target, QOpenGLFunctions &gl)
+{
+	FrameTimes times;
+
+	QOpenGLTimerQuery shadowQuery, sceneQuery;
+	shadowQuery.create();
+	sceneQuery.create();
+
+	std::vector<CameraPath::Frame> const& frames(path.getFrames());
+
+	for(size_t frameIndex(0); frameIndex < options.warmupCount + frames.size(); frameIndex++)
+	{
+		//the warmup frames go through the beginning of the path
+		CameraPath::Frame const& frame(frames[frameIndex < options.warmupCount ?
+			frameIndex % frames.size() : frameIndex - options.warmupCount]);
+
+		QMatrix4x4 pMatrix, vMatrix;
+		pMatrix.perspective(frame.zoomAngle, float(options.width) / float(options.height),
+							0.1f, renderer.getWidth() + renderer.getLength());
+		vMatrix.lookAt(frame.eyePos, QVector3D(0.f, 0.f, -40.f), QVector3D(0.f, 0.f, 1.f));
+
+		std::chrono::steady_clock::time_point frameStart(std::chrono::steady_clock::now());
+
+		//the light moves with the path: the shadow map is rendered each frame
+		shadowQuery.begin();
+		renderer.setLightDir(frame.lightDir);
+		shadowQuery.end();
+
+		double shadowCpuMs(getElapsedMs(frameStart));
+
+		std::chrono::steady_clock::time_point sceneStart(std::chrono::steady_clock::now());
+
+		sceneQuery.begin();
+		target.bind();
+		gl.glViewport(0, 0, options.width, options.height);
+		gl.glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		renderer.renderScene(pMatrix * vMatrix);
+		sceneQuery.end();
+
+		double sceneCpuMs(getElapsedMs(sceneStart));
+
+		gl.glFinish();
+
+		double frameMs(getElapsedMs(frameStart));
+
+		if(frameIndex >= options.warmupCount)
+		{
+			times.shadowCpuMs.push_back(shadowCpuMs);
+			times.sceneCpuMs.push_back(sceneCpuMs);
+			times.frameMs.push_back(frameMs);
+
+			//nanoseconds
+			times.shadowGpuMs.push_back(double(shadowQuery.waitForResult()) * 1e-6);
+			times.sceneGpuMs.push_back(double(sceneQuery.waitForResult()) * 1e-6);
+		}
+	}
+
+	shadowQuery.destroy();
+	sceneQuery.destroy();
+
+	return times;
+}
+
+/**
+ * @brief benchmarkRendering create the height map of a synthetic image, wait for
+ * all its full resolution chunks and replay the path
+ */
+void benchmarkRendering(BenchmarkRunner &runner, Options const& options, Types::shared_matrix const& image,
+						unsigned int size, ChunkedHeightMap::MeshMode meshMode, QOpenGLFramebufferObject &target,
+						QOpenGLFunctions &gl)
+{
+	std::shared_ptr<ChunkedHeightMap> heightMap(std::make_shared<ChunkedHeightMap>(image, size, size, meshMode));
+	heightMap->buildInBackground();
+
+	HeightMapRenderer renderer(heightMap);
+	renderer.initialize();
+
+	//Measure the full resolution meshes only
+	while(!heightMap->isComplete())
+	{
+		heightMap->uploadReadyChunks();
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	//without path, orbit with the angle of view of the render windows
+	CameraPath path(options.pathFile.empty() ?
+		CameraPath::createOrbit(options.frameCount, 0.75f * float(size), 250.f, 70.f) :
+		CameraPath(options.pathFile));
+
+	if(!path.getFrameCount())
+		throw std::runtime_error("Empty camera path");
+
+	FrameTimes times(replay(renderer, path, options, target, gl));
+
+	long long pixelCount((long long)(size) * size);
+	long long vertexBytes((long long)(size - 1) * (size - 1) * 6 * VERTEX_BYTES);
+	std::string mode(meshMode == ChunkedHeightMap::INDEXED ? "index" : "noIndex");
+
+	//the vertex shader reads the texture of the heights, one float per pixel
+	if(meshMode == ChunkedHeightMap::HEIGHT_TEXTURE)
+	{
+		vertexBytes = pixelCount * (long long)(sizeof(float));
+		mode = "heightTexture";
+	}
+
+	runner.addResult({"shadowPassCpu", size, 1, times.shadowCpuMs, pixelCount, vertexBytes, mode});
+	runner.addResult({"shadowPassGpu", size, 1, times.shadowGpuMs, pixelCount, vertexBytes, mode});
+	runner.addResult({"scenePassCpu", size, 1, times.sceneCpuMs, pixelCount, vertexBytes, mode});
+	runner.addResult({"scenePassGpu", size, 1, times.sceneGpuMs, pixelCount, vertexBytes, mode});
+	runner.addResult({"frame", size, 1, times.frameMs, pixelCount, 2 * vertexBytes, mode});
+}
+
+int main(int argc, char *argv[])
+{
+	//Without a display, run with QT_QPA_PLATFORM=offscreen
+	QGuiApplication app(argc, argv);
+
+	try
+	{
+		Options options(parseOptions(argc, argv));
+		BenchmarkRunner runner;
+
+		//The trace and the counters would add noise
+		Tracer::stop();
+		PerfCounters::setEnabled(false);
+
+		//The shaders need OpenGL 3.3
+		QSurfaceFormat format;
+		format.setDepthBufferSize(24);
+		format.setVersion(3, 3);
+		format.setProfile(QSurfaceFormat::CoreProfile);
+
+		QOffscreenSurface surface;
+		surface.setFormat(format);
+		surface.create();
+
+		QOpenGLContext context;
+		context.setFormat(format);
+
+		if(!context.create() || !context.makeCurrent(&surface))
+			throw std::runtime_error("Cannot create an OpenGL 3.3 context");
+
+		{
+			QOpenGLFramebufferObject target(options.width, options.height,
+											QOpenGLFramebufferObject::Depth);
+
+			for(unsigned int size : options.sizes)
+			{
+				std::cerr << "size " << size << std::endl;
+
+				Types::shared_matrix image(std::make_shared<const Types::float_matrix>(
+					BenchmarkRunner::createSyntheticImage(size)));
+
+				for(ChunkedHeightMap::MeshMode meshMode :
+						{ChunkedHeightMap::INDEXED, ChunkedHeightMap::NON_INDEXED, ChunkedHeightMap::HEIGHT_TEXTURE})
+					benchmarkRendering(runner, options, image, size, meshMode, target, *context.functions());
+			}
+		}
+
+		context.doneCurrent();
+
+		if(options.outputFile.empty())
+			runner.writeJson(std::cout);
+		else
+		{
+			std::ofstream file(options.outputFile.c_str());
+			runner.writeJson(file);
+		}
+	}
+	catch(std::exception const& e)
+	{
+		std::cerr << "ERROR : " << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
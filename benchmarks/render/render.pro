@@ -0,0 +1,42 @@
+TARGET = renderBenchmarks
+TEMPLATE = app
+
+QT       += core gui
+
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += .. ../../src
+
+RESOURCES = ../../src/src.qrc
+
+HEADERS += ../BenchmarkRunner.h
+
+SOURCES += main.cpp \
+    ../BenchmarkRunner.cpp \
+    ../../src/rendering/HeightMapRenderer.cpp \
+    ../../src/rendering/ColourRamp.cpp \
+    ../../src/rendering/CameraPath.cpp \
+    ../../src/rendering/ChunkedHeightMap.cpp \
+    ../../src/rendering/HeightTextureMesh.cpp \
+    ../../src/rendering/GLResourceCache.cpp \
+    ../../src/rendering/DepthMap.cpp \
+    ../../src/rendering/LvlPlan.cpp \
+    ../../src/rendering/ContourLines.cpp \
+    ../../src/rendering/HeightMapMesh.cpp \
+    ../../src/rendering/Mesh.cpp \
+    ../../src/rendering/DrawList.cpp \
+    ../../src/terrainAnalysis/HorizonShadows.cpp \
+    ../../src/terrainAnalysis/AmbientOcclusion.cpp \
+    ../../src/terrainAnalysis/NormalMap.cpp \
+    ../../src/terrainAnalysis/HeightPyramid.cpp \
+    ../../src/terrainAnalysis/HeightFieldTracer.cpp \
+    ../../src/terrainAnalysis/ContourExtractor.cpp \
+    ../../src/terrainAnalysis/LevelStatistics.cpp \
+    ../../src/tools/MatrixPool.cpp \
+    ../../src/tools/DirtyRanges.cpp \
+    ../../src/tools/Instrumentation.cpp \
+    ../../src/tools/Tracer.cpp \
+    ../../src/tools/PerfCounters.cpp
@@ -1,4 +1,7 @@
 TEMPLATE  = subdirs
 CONFIG   += ordered
-SUBDIRS = src
+SUBDIRS = src \
+    benchmarks \
+    benchmarks/render \
+    snapshot
 
@@ -0,0 +1,360 @@
+/**
+*******************************************************************************
+*
+*  @file       main.cpp
+*
+*  @brief      Render snapshots of a height map without display, on the CPU or
+*				offscreen with OpenGL, tile by tile, at any resolution.
+*				The camera and the light are the ones of the render window,
+*				or each frame of a recorded camera path, of a turntable or of a light sweep.
+*				With OpenGL, the frames of a sequence are read back and encoded
+*				while the next ones are rendered.
+*
+*  usage: snapshot --input image [--stage raw|smoothed|gradient|canny] [--output file.png]
+*			[--width n] [--height n] [--path file.path | --orbit frames | --light-sweep frames]
+*			[--eye x,y,z] [--light x,y,z] [--zoom angle] [--ambient-occlusion 0|1]
+*			[--renderer cpu|gpu] [--tile-size n]
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <math.h>
+#include <iostream>
+#include <sstream>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <cstdlib>
+#include <stdexcept>
+#include <QCoreApplication>
+#include <QGuiApplication>
+#include <QImage>
+#include <QString>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QSurfaceFormat>
+
+#include "imageProcessing/ImageProcessor.h"
+#include "rendering/SoftwareRenderer.h"
+#include "rendering/ChunkedHeightMap.h"
+#include "rendering/HeightMapRenderer.h"
+#include "rendering/TiledExporter.h"
+#include "rendering/SequenceExporter.h"
+#include "rendering/HeightMapMesh.h"
+#include "rendering/CameraPath.h"
+#include "terrainAnalysis/AmbientOcclusion.h"
+
+///@cond
+/**
+ * @brief The Options struct the settings given on the command line
+ */
+struct Options
+{
+	std::string inputFile;
+	std::string stage = "raw";
+	std::string outputFile = "snapshot.png";
+	unsigned int width = 1920;
+	unsigned int height = 1080;
+	std::string pathFile; //a single snapshot if empty
+	unsigned int orbitFrameCount = 0; //the camera and the light turn around the height map
+	unsigned int lightSweepFrameCount = 0; //the light turns around the height map
+	std::vector<float> eyePos; //above the center of the height map if empty
+	std::vector<float> lightDir = {3.f, -3.f, 5.f};
+	float zoomAngle = 70.f;
+	bool useAmbientOcclusion = true;
+	bool useOpenGL = false; //ray traced on the CPU by default
+	unsigned int tileSize = 2048; //maximum size of the tiles rendered with OpenGL
+};
+///@endcond
+
+/**
+ * @brief parseVector parse a comma separated vector
+ * @param text the vector
+ * @return the three coordinates
+ * @throws std::runtime_error if there are not three coordinates
+ */
+std::vector<float> parseVector(std::string const& text)
+{
+	std::vector<float> values;
+	std::istringstream stream(text);
+	std::string value;
+
+	while(std::getline(stream, value, ','))
+		values.push_back(std::strtof(value.c_str(), nullptr));
+
+	if(values.size() != 3)
+		throw std::runtime_error("Wrong vector " + text + ", expected x,y,z");
+
+	return values;
+}
+
+/**
+ * @brief parseOptions read the command line
+ * @return the options
+ * @throws std::runtime_error if an option is unknown or if there is no input
+ */
+Options parseOptions(int argc, char *argv[])
+{
+	Options options;
+
+	for(int arg(1); arg + 1 < argc; arg += 2)
+	{
+		std::string name(argv[arg]), value(argv[arg + 1]);
+
+		if(name == "--input")
+			options.inputFile = value;
+		else if(name == "--stage")
+			options.stage = value;
+		else if(name == "--output")
+			options.outputFile = value;
+		else if(name == "--width")
+			options.width = (unsigned int)(std::strtoul(value.c_str(), nullptr, 10));
+		else if(name == "--height")
+			options.height = (unsigned int)(std::strtoul(value.c_str(), nullptr, 10));
+		else if(name == "--path")
+			options.pathFile = value;
+		else if(name == "--orbit")
+			options.orbitFrameCount = (unsigned int)(std::strtoul(value.c_str(), nullptr, 10));
+		else if(name == "--light-sweep")
+			options.lightSweepFrameCount = (unsigned int)(std::strtoul(value.c_str(), nullptr, 10));
+		else if(name == "--eye")
+			options.eyePos = parseVector(value);
+		else if(name == "--light")
+			options.lightDir = parseVector(value);
+		else if(name == "--zoom")
+			options.zoomAngle = std::strtof(value.c_str(), nullptr);
+		else if(name == "--ambient-occlusion")
+			options.useAmbientOcclusion = value != "0";
+		else if(name == "--renderer" && (value == "cpu" || value == "gpu"))
+			options.useOpenGL = value == "gpu";
+		else if(name == "--tile-size")
+			options.tileSize = (unsigned int)(std::strtoul(value.c_str(), nullptr, 10));
+		else
+			throw std::runtime_error("Unknown option " + name);
+	}
+
+	if(options.inputFile.empty())
+		throw std::runtime_error("No input image, use --input");
+
+	if(!options.width || !options.height)
+		throw std::runtime_error("Wrong size of the snapshots");
+
+	return options;
+}
+
+/**
+ * @brief getStageData
+ * @param imageProcessor the processed image
+ * @param stage the name of the stage
+ * @return the data of the stage
+ * @throws std::runtime_error if the stage is unknown
+ */
+Types::shared_matrix getStageData(ImageProcessor const& imageProcessor, std::string const& stage)
+{
+	if(stage == "raw")
+		return imageProcessor.getRawData();
+	else if(stage == "smoothed")
+		return imageProcessor.getSmoothedData();
+	else if(stage == "gradient")
+		return imageProcessor.getGradientData();
+	else if(stage == "canny")
+		return imageProcessor.getCannyData();
+
+	throw std::runtime_error("Unknown stage " + stage);
+}
+
+/**
+ * @brief isSequence
+ * @param options the options
+ * @return true if several numbered images are rendered
+ */
+bool isSequence(Options const& options)
+{
+	return !options.pathFile.empty() || options.orbitFrameCount || options.lightSweepFrameCount;
+}
+
+/**
+ * @brief getPath
+ * @param options the options, with the camera and the light of the single snapshot
+ * @param length length of the mesh of the height map
+ * @param width width of the mesh of the height map
+ * @return the recorded path, the turntable, the light sweep or the single snapshot
+ */
+CameraPath getPath(Options const& options, float length, float width)
+{
+	if(!options.pathFile.empty())
+		return CameraPath(options.pathFile);
+
+	QVector3D eyePos(options.eyePos.empty() ?
+		QVector3D(length/2, width/2, 250.f) :
+		QVector3D(options.eyePos[0], options.eyePos[1], options.eyePos[2]));
+
+	//the turntable starts at the horizontal distance and the height of the camera
+	if(options.orbitFrameCount)
+	{
+		return CameraPath::createOrbit(options.orbitFrameCount,
+			sqrtf(eyePos.x() * eyePos.x() + eyePos.y() * eyePos.y()), eyePos.z(), options.zoomAngle);
+	}
+
+	if(options.lightSweepFrameCount)
+		return CameraPath::createLightSweep(options.lightSweepFrameCount, eyePos, options.zoomAngle);
+
+	CameraPath path;
+	path.addFrame({eyePos, QVector3D(options.lightDir[0], options.lightDir[1], options.lightDir[2]),
+				   options.zoomAngle});
+
+	return path;
+}
+
+/**
+ * @brief getPvMatrix the camera of the render window, with the aspect ratio of the snapshots
+ * @return the projection matrix multiplied by the view matrix
+ */
+QMatrix4x4 getPvMatrix(Options const& options, CameraPath::Frame const& frame, float length, float width)
+{
+	QMatrix4x4 pMatrix, vMatrix;
+	pMatrix.perspective(frame.zoomAngle, float(options.width) / float(options.height),
+						0.1f, width + length);
+	vMatrix.lookAt(frame.eyePos, QVector3D(0.f, 0.f, -40.f), QVector3D(0.f, 0.f, 1.f));
+
+	return pMatrix * vMatrix;
+}
+
+/**
+ * @brief saveSnapshot save a snapshot, numbered if there are several ones
+ * @throws std::runtime_error if the image cannot be saved
+ */
+void saveSnapshot(QImage const& image, Options const& options, size_t frame)
+{
+	std::string fileName(isSequence(options) ?
+		SequenceExporter::getFrameFileName(options.outputFile, frame) : options.outputFile);
+
+	if(!image.save(QString::fromStdString(fileName)))
+		throw std::runtime_error("Cannot write the snapshot " + fileName);
+
+	std::cerr << fileName << std::endl;
+}
+
+/**
+ * @brief renderOnCpu ray trace the snapshots with SoftwareRenderer
+ */
+void renderOnCpu(Options const& options, Types::shared_matrix const& heights, unsigned int n, unsigned int m)
+{
+	SoftwareRenderer renderer(heights, n, m);
+
+	if(options.useAmbientOcclusion)
+	{
+		renderer.setAmbientOcclusion(std::make_shared<const Types::float_matrix>(
+			AmbientOcclusion::bake(*heights, n, m, HeightMapMesh::getHeightScale(n, m))));
+	}
+
+	CameraPath path(getPath(options, renderer.getLength(), renderer.getWidth()));
+	std::vector<CameraPath::Frame> const& frames(path.getFrames());
+
+	for(size_t frame(0); frame < frames.size(); frame++)
+	{
+		saveSnapshot(renderer.render(options.width, options.height,
+			getPvMatrix(options, frames[frame], renderer.getLength(), renderer.getWidth()),
+			frames[frame].lightDir.normalized()), options, frame);
+	}
+}
+
+/**
+ * @brief renderWithOpenGL render the snapshots offscreen with HeightMapRenderer
+ * once all the full resolution chunks and the ambient occlusion are uploaded.
+ * A single snapshot is rendered tile by tile, the frames of a sequence at once
+ * @throws std::runtime_error if no OpenGL 3.3 context can be created
+ */
+void renderWithOpenGL(Options const& options, Types::shared_matrix const& heights, unsigned int n, unsigned int m)
+{
+	//The shaders need OpenGL 3.3
+	QSurfaceFormat format;
+	format.setDepthBufferSize(24);
+	format.setVersion(3, 3);
+	format.setProfile(QSurfaceFormat::CoreProfile);
+
+	QOffscreenSurface surface;
+	surface.setFormat(format);
+	surface.create();
+
+	QOpenGLContext context;
+	context.setFormat(format);
+
+	if(!context.create() || !context.makeCurrent(&surface))
+		throw std::runtime_error("Cannot create an OpenGL 3.3 context");
+
+	{
+		std::shared_ptr<ChunkedHeightMap> heightMap(std::make_shared<ChunkedHeightMap>(heights, n, m, ChunkedHeightMap::INDEXED));
+		heightMap->buildInBackground();
+
+		HeightMapRenderer renderer(heightMap);
+		renderer.initialize();
+
+		//the ambient occlusion is baked after the chunks
+		while(!heightMap->isComplete() || (options.useAmbientOcclusion && !heightMap->getAmbientOcclusion()))
+		{
+			heightMap->uploadReadyChunks();
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+
+		CameraPath path(getPath(options, renderer.getLength(), renderer.getWidth()));
+
+		if(isSequence(options))
+		{
+			SequenceExporter exporter;
+			exporter.initialize();
+			exporter.render(renderer, path, options.width, options.height, options.outputFile);
+
+			std::cerr << path.getFrameCount() << " frames" << std::endl;
+		}
+		else
+		{
+			CameraPath::Frame const& frame(path.getFrames().front());
+
+			TiledExporter exporter(options.tileSize);
+			exporter.initialize();
+
+			renderer.setLightDir(frame.lightDir.normalized());
+
+			saveSnapshot(exporter.render(renderer,
+				getPvMatrix(options, frame, renderer.getLength(), renderer.getWidth()),
+				options.width, options.height), options, 0);
+		}
+	}
+
+	//the meshes, and their vertex array objects, are destroyed with the context current
+	context.doneCurrent();
+}
+
+int main(int argc, char *argv[])
+{
+	try
+	{
+		Options options(parseOptions(argc, argv));
+
+		//Without a display, run the OpenGL renderer with QT_QPA_PLATFORM=offscreen.
+		//The ray tracer only needs the image plugins
+		std::unique_ptr<QCoreApplication> app(options.useOpenGL ?
+			new QGuiApplication(argc, argv) : new QCoreApplication(argc, argv));
+
+		ImageProcessor imageProcessor(options.inputFile);
+		Types::shared_matrix heights(getStageData(imageProcessor, options.stage));
+		unsigned int n(imageProcessor.getN()), m(imageProcessor.getM());
+
+		if(options.useOpenGL)
+			renderWithOpenGL(options, heights, n, m);
+		else
+			renderOnCpu(options, heights, n, m);
+	}
+	catch(std::exception const& e)
+	{
+		std::cerr << "ERROR : " << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,43 @@
+TARGET = snapshot
+TEMPLATE = app
+
+QT       += core gui
+
+CONFIG   += console c++11
+CONFIG   -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+INCLUDEPATH += ../src
+
+RESOURCES = ../src/src.qrc
+
+SOURCES += main.cpp \
+    ../src/imageProcessing/ImageProcessor.cpp \
+    ../src/rendering/SoftwareRenderer.cpp \
+    ../src/rendering/ColourRamp.cpp \
+    ../src/rendering/TiledExporter.cpp \
+    ../src/rendering/SequenceExporter.cpp \
+    ../src/rendering/HeightMapRenderer.cpp \
+    ../src/rendering/CameraPath.cpp \
+    ../src/rendering/ChunkedHeightMap.cpp \
+    ../src/rendering/HeightTextureMesh.cpp \
+    ../src/rendering/GLResourceCache.cpp \
+    ../src/rendering/DepthMap.cpp \
+    ../src/rendering/LvlPlan.cpp \
+    ../src/rendering/ContourLines.cpp \
+    ../src/rendering/HeightMapMesh.cpp \
+    ../src/rendering/Mesh.cpp \
+    ../src/rendering/DrawList.cpp \
+    ../src/terrainAnalysis/HeightPyramid.cpp \
+    ../src/terrainAnalysis/HeightFieldTracer.cpp \
+    ../src/terrainAnalysis/ContourExtractor.cpp \
+    ../src/terrainAnalysis/LevelStatistics.cpp \
+    ../src/terrainAnalysis/HorizonShadows.cpp \
+    ../src/terrainAnalysis/AmbientOcclusion.cpp \
+    ../src/terrainAnalysis/NormalMap.cpp \
+    ../src/tools/MatrixPool.cpp \
+    ../src/tools/DirtyRanges.cpp \
+    ../src/tools/Instrumentation.cpp \
+    ../src/tools/Tracer.cpp \
+    ../src/tools/PerfCounters.cpp
@@ -18,6 +18,8 @@
 
 #include "MainWindow.h"
 #include "ui_mainwindow.h"
+#include "tools/Instrumentation.h"
+#include "tools/Tracer.h"
 
 //------------------------------------------------------------------------------
 MainWindow::MainWindow(QWidget *parent):
@@ -33,6 +35,18 @@ MainWindow::MainWindow(QWidget *parent):
 	ui->errorText->setTextColor(QColor(255, 0, 0));
 	ui->imageFileText->setText(m_imageFile.c_str());
 
+	//The processing thread emits the signals, queue them to handle them in the GUI thread
+	connect(this, &MainWindow::processingProgressed,
+			this, &MainWindow::handleProcessingProgress, Qt::QueuedConnection);
+	connect(this, &MainWindow::processingFinished,
+			this, &MainWindow::handleProcessingFinished, Qt::QueuedConnection);
+
+	//Hardware counters are only available on Linux
+	ui->perfCountersCheckBox->setEnabled(PerfCounters::isSupported());
+
+	//Nothing to display until the first processing succeeds
+	setDisplayButtonsEnabled(false);
+
 	updateImageProcessor();
 
 	setWindowTitle("Control panel");
@@ -42,6 +56,12 @@ MainWindow::MainWindow(QWidget *parent):
 MainWindow::~MainWindow()
 //------------------------------------------------------------------------------
 {
+	cancelProcessing();
+
+	//the threads use this window, the loads that cannot be cancelled are waited for
+	for(ProcessingJob &job : m_cancelledJobs)
+		job.thread.join();
+
 	delete ui;
 }
 
@@ -49,28 +69,28 @@ MainWindow::~MainWindow()
 void MainWindow::on_originalImageButton_clicked()
 //------------------------------------------------------------------------------
 {
-	launchRenderWindow("Original image", m_imageProcessor.getRawData());
+	launchRenderWindow("Original image", m_imageProcessor->getRawData());
 }
 
 //------------------------------------------------------------------------------
 void MainWindow::on_smoothedImageButton_clicked()
 //------------------------------------------------------------------------------
 {
-	launchRenderWindow("Smoothed image", m_imageProcessor.getSmoothedData());
+	launchRenderWindow("Smoothed image", m_imageProcessor->getSmoothedData());
 }
 
 //------------------------------------------------------------------------------
 void MainWindow::on_gradientNormButton_clicked()
 //------------------------------------------------------------------------------
 {
-	launchRenderWindow("Gradient norm image", m_imageProcessor.getGradientData());
+	launchRenderWindow("Gradient norm image", m_imageProcessor->getGradientData());
 }
 
 //------------------------------------------------------------------------------
 void MainWindow::on_cannyImageButton_clicked()
 //------------------------------------------------------------------------------
 {
-	launchRenderWindow("Cany image", m_imageProcessor.getCannyData());
+	launchRenderWindow("Cany image", m_imageProcessor->getCannyData());
 }
 
 //------------------------------------------------------------------------------
@@ -96,24 +116,78 @@ void MainWindow::on_choseImageButton_clicked()
 
 
 //------------------------------------------------------------------------------
-void MainWindow::on_useIndexButton_clicked()
+void MainWindow::on_meshModeButton_clicked()
+//------------------------------------------------------------------------------
+{
+	//index, no index, height texture, index...
+	if(m_meshMode == ChunkedHeightMap::INDEXED)
+	{
+		m_meshMode = ChunkedHeightMap::NON_INDEXED;
+		ui->meshModeButton->setText("Mesh: no index");
+	}
+	else if(m_meshMode == ChunkedHeightMap::NON_INDEXED)
+	{
+		m_meshMode = ChunkedHeightMap::HEIGHT_TEXTURE;
+		ui->meshModeButton->setText("Mesh: height texture");
+	}
+	else
+	{
+		m_meshMode = ChunkedHeightMap::INDEXED;
+		ui->meshModeButton->setText("Mesh: index");
+	}
+}
+
+
+//------------------------------------------------------------------------------
+void MainWindow::on_refreshStatsButton_clicked()
+//------------------------------------------------------------------------------
+{
+	displayStats();
+}
+
+//------------------------------------------------------------------------------
+void MainWindow::on_traceCheckBox_toggled(bool checked)
 //------------------------------------------------------------------------------
 {
-    if(m_useIndex)
-    {
-        m_useIndex = false;
-		ui->useIndexButton->setText("Use index");
-    }
+	if(checked)
+	{
+		//Record everything until the box is unchecked
+		Tracer::start();
+	}
 	else
 	{
-		m_useIndex = true;
-		ui->useIndexButton->setText("do not use index");
+		Tracer::stop();
+
+		QString fileName = QFileDialog::getSaveFileName(nullptr, "Save trace file",
+								QCoreApplication::applicationDirPath() + "/trace.json",
+								"Chrome trace (*.json)");
+
+		if(fileName.size())
+		{
+			try
+			{
+				Tracer::writeJson(fileName.toUtf8().constData());
+			}
+			catch(std::exception const& e)
+			{
+				//display the error message
+				ui->errorText->setText(e.what());
+				std::cerr << "ERROR : " << e.what() << std::endl;
+			}
+		}
 	}
 }
 
+//------------------------------------------------------------------------------
+void MainWindow::on_perfCountersCheckBox_toggled(bool checked)
+//------------------------------------------------------------------------------
+{
+	//Used by the next stages, the unavailable counters are displayed as such
+	PerfCounters::setEnabled(checked);
+}
 
 //------------------------------------------------------------------------------
-void MainWindow::launchRenderWindow(QString const& windowName, const Types::float_matrix &imageData)
+void MainWindow::launchRenderWindow(QString const& windowName, Types::shared_matrix const& imageData)
 //------------------------------------------------------------------------------
 {
 	//set the size of the depth buffer
@@ -124,8 +198,8 @@ void MainWindow::launchRenderWindow(QString const& windowName, const Types::floa
 	try
 	{
 		RenderWindow *renderWindow(new RenderWindow(imageData,
-								m_imageProcessor.getN(), m_imageProcessor.getM(),
-								m_useIndex));
+								m_imageProcessor->getN(), m_imageProcessor->getM(),
+								m_meshMode));
 
 		renderWindow->setFormat(format);
 		renderWindow->setTitle(windowName);
@@ -144,31 +218,167 @@ void MainWindow::launchRenderWindow(QString const& windowName, const Types::floa
 void MainWindow::updateImageProcessor()
 //------------------------------------------------------------------------------
 {
-	//Disable buttons before processing
-	ui->originalImageButton->setDisabled(true);
-	ui->smoothedImageButton->setDisabled(true);
-	ui->gradientNormButton->setDisabled(true);
-	ui->cannyImageButton->setDisabled(true);
+	//Stop the previous processing, its results are not needed anymore
+	cancelProcessing();
+	joinFinishedJobs();
 
-	try
+	//the results of a processing that finished before being replaced are not swapped in
 	{
-		//launch processing
-		m_imageProcessor = ImageProcessor(m_imageFile);
+		std::lock_guard<std::mutex> lock(m_pendingMutex);
+		m_pendingImageProcessor.reset();
+	}
+
+	//The previous results stay displayable until the new ones are ready
+	setDisplayButtonsEnabled(m_imageProcessor != nullptr);
+
+	ui->processingProgressBar->setValue(0);
+	ui->errorText->clear();
+
+	//Only show the measures of the new processing and of the meshes created afterwards
+	Instrumentation::resetTimers();
+
+	unsigned int jobId(++m_jobId);
+	std::string imageFile(m_imageFile);
+	ImageProcessor::cancellation_token cancellationToken(std::make_shared<std::atomic<bool>>(false));
+	std::shared_ptr<std::atomic<bool>> isFinished(std::make_shared<std::atomic<bool>>(false));
+	m_cancellationToken = cancellationToken;
 
-		//Enable buttons if everything has gone well
-		ui->originalImageButton->setEnabled(true);
-		ui->smoothedImageButton->setEnabled(true);
-		ui->gradientNormButton->setEnabled(true);
-		ui->cannyImageButton->setEnabled(true);
+	std::shared_ptr<ImageProcessor> imageProcessor(std::make_shared<ImageProcessor>());
+	imageProcessor->setCancellationToken(m_cancellationToken);
+	imageProcessor->setProgressCallback(
+		[this, jobId](ImageProcessor::Stage stage, float progress)
+		{
+			emit processingProgressed(jobId, int(stage), progress);
+		});
 
-		ui->errorText->clear();
+	//launch processing in the background
+	m_processingJob.isFinished = isFinished;
+	m_processingJob.thread = std::thread(
+		[this, jobId, imageFile, imageProcessor, cancellationToken, isFinished]()
+		{
+			try
+			{
+				imageProcessor->loadData(imageFile);
+				imageProcessor->processImage();
+
+				{
+					//checked under the lock: once cancelled, the pending processor stays cleared
+					std::lock_guard<std::mutex> lock(m_pendingMutex);
+
+					if(!cancellationToken->load())
+						m_pendingImageProcessor = imageProcessor;
+				}
+
+				emit processingFinished(jobId, QString());
+			}
+			catch(ProcessingCancelled const&)
+			{
+				//A new processing has been requested, nothing to report
+			}
+			catch(std::exception const& e)
+			{
+				emit processingFinished(jobId, QString(e.what()));
+			}
+
+			isFinished->store(true);
+		});
+}
+
+//------------------------------------------------------------------------------
+void MainWindow::cancelProcessing()
+//------------------------------------------------------------------------------
+{
+	if(m_cancellationToken)
+		m_cancellationToken->store(true);
+
+	//The processing stops at the next tile, but the load goes on: no wait on the GUI thread
+	if(m_processingJob.thread.joinable())
+		m_cancelledJobs.push_back(std::move(m_processingJob));
+
+	m_processingJob = ProcessingJob();
+}
+
+//------------------------------------------------------------------------------
+void MainWindow::joinFinishedJobs()
+//------------------------------------------------------------------------------
+{
+	for(auto ite(m_cancelledJobs.begin()); ite != m_cancelledJobs.end();)
+	{
+		//the thread only has to return after setting its flag
+		if(ite->isFinished->load())
+		{
+			ite->thread.join();
+			ite = m_cancelledJobs.erase(ite);
+		}
+		else
+			++ite;
 	}
-	catch(std::exception const& e)
+}
+
+//------------------------------------------------------------------------------
+void MainWindow::setDisplayButtonsEnabled(bool enabled)
+//------------------------------------------------------------------------------
+{
+	ui->originalImageButton->setEnabled(enabled);
+	ui->smoothedImageButton->setEnabled(enabled);
+	ui->gradientNormButton->setEnabled(enabled);
+	ui->cannyImageButton->setEnabled(enabled);
+}
+
+//------------------------------------------------------------------------------
+void MainWindow::displayStats()
+//------------------------------------------------------------------------------
+{
+	ui->statsText->setText(QString::fromStdString(Instrumentation::getStats().toString()));
+}
+
+//------------------------------------------------------------------------------
+void MainWindow::handleProcessingProgress(unsigned int jobId, int stage, float progress)
+//------------------------------------------------------------------------------
+{
+	//Ignore notifications of cancelled processings
+	if(jobId == m_jobId)
 	{
-		//display the error message
-		ui->errorText->setText(e.what());
-		std::cerr << "ERROR : " << e.what() << std::endl;
+		//Each stage is given the same share of the progress bar
+		float totalProgress((float(stage) + progress) / float(ImageProcessor::STAGE_COUNT));
+
+		ui->processingProgressBar->setValue(int(100.f * totalProgress));
+		ui->processingProgressBar->setFormat(QString::fromStdString(
+			ImageProcessor::getStageName(ImageProcessor::Stage(stage))) + " %p%");
 	}
+}
+
+//------------------------------------------------------------------------------
+void MainWindow::handleProcessingFinished(unsigned int jobId, QString errorMessage)
+//------------------------------------------------------------------------------
+{
+	joinFinishedJobs();
+
+	if(jobId == m_jobId)
+	{
+		if(errorMessage.isEmpty())
+		{
+			//Swap the results now that the new ones are ready
+			{
+				std::lock_guard<std::mutex> lock(m_pendingMutex);
+				m_imageProcessor = m_pendingImageProcessor;
+				m_pendingImageProcessor.reset();
+			}
 
+			ui->processingProgressBar->setValue(100);
+			ui->processingProgressBar->setFormat(QString::fromStdString(
+				ImageProcessor::getStageName(ImageProcessor::STAGE_COUNT)));
+			ui->errorText->clear();
 
+			displayStats();
+		}
+		else
+		{
+			//display the error message, the previous results are kept
+			ui->errorText->setText(errorMessage);
+			std::cerr << "ERROR : " << errorMessage.toUtf8().constData() << std::endl;
+		}
+
+		setDisplayButtonsEnabled(m_imageProcessor != nullptr);
+	}
 }
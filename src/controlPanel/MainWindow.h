@@ -17,6 +17,11 @@
 //******************************************************************************
 #include <QMainWindow>
 #include <string>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <vector>
 
 #include "imageProcessing/ImageProcessor.h"
 #include "rendering/RenderWindow.h"
@@ -53,27 +58,116 @@ private slots:
 
 	void on_choseImageButton_clicked();
 
-	void on_useIndexButton_clicked();
+	void on_meshModeButton_clicked();
+
+	void on_refreshStatsButton_clicked();
+
+	void on_traceCheckBox_toggled(bool checked);
+
+	void on_perfCountersCheckBox_toggled(bool checked);
+
+//******************************************************************************
+//  slots that receive the notifications of the processing thread
+//******************************************************************************
+private slots:
+	/**
+	 * @brief handleProcessingProgress display the progress of the processing
+	 * @param jobId the processing job that made progress
+	 * @param stage the current ImageProcessor::Stage
+	 * @param progress progress of the stage in the [0,1] range
+	 */
+	void handleProcessingProgress(unsigned int jobId, int stage, float progress);
+
+	/**
+	 * @brief handleProcessingFinished swap the results if the processing succeeded
+	 * @param jobId the processing job that ended
+	 * @param errorMessage empty if the processing succeeded
+	 */
+	void handleProcessingFinished(unsigned int jobId, QString errorMessage);
+
+//******************************************************************************
+//  signals emitted from the processing thread
+//******************************************************************************
+signals:
+	void processingProgressed(unsigned int jobId, int stage, float progress);
+
+	void processingFinished(unsigned int jobId, QString errorMessage);
 
 //******************************************************************************
 private:
 	/**
 	 * @brief launchRenderWindow launch a new render window to display a height map
 	 * @param windowName the name of the window to be created
-	 * @param imageData data corresponding to the height map to be displayed
+	 * @param imageData data corresponding to the height map to be displayed, shared without copy
 	 */
-	void launchRenderWindow(QString const& windowName, Types::float_matrix const& imageData);
+	void launchRenderWindow(QString const& windowName, Types::shared_matrix const& imageData);
 
 	/**
 	 * @brief updateImageProcessor Update the image processor
-	 * by changing the original image and process it
+	 * by changing the original image and process it in a background thread.
+	 * Cancel the processing in progress if any.
 	 */
 	void updateImageProcessor();
 
+	/**
+	 * @brief cancelProcessing Cancel the processing in progress if any.
+	 * Its thread is not waited for: a load cannot be cancelled, the thread is joined once it has finished
+	 */
+	void cancelProcessing();
+
+	/**
+	 * @brief joinFinishedJobs join the threads of the cancelled processings that have returned
+	 */
+	void joinFinishedJobs();
+
+	/**
+	 * @brief setDisplayButtonsEnabled Enable or disable the buttons that launch render windows
+	 * @param enabled true to enable the buttons
+	 */
+	void setDisplayButtonsEnabled(bool enabled);
+
+	/**
+	 * @brief displayStats display the time spent and the memory held
+	 * by the processing and the meshes
+	 */
+	void displayStats();
+
 	Ui::MainWindow *ui;
 
-	//image processor that store the height maps data and process them
-	ImageProcessor m_imageProcessor;
+	//image processor that store the height maps data that can be displayed.
+	//Null until a processing succeeds
+	std::shared_ptr<ImageProcessor> m_imageProcessor;
+
+	//image processor written by the processing thread,
+	//swapped with m_imageProcessor once the processing succeeded
+	std::shared_ptr<ImageProcessor> m_pendingImageProcessor;
+
+	//protect m_pendingImageProcessor
+	std::mutex m_pendingMutex;
+
+	///@cond
+	/**
+	 * @brief The ProcessingJob struct a thread running a processing
+	 * and the flag it sets when it returns
+	 */
+	struct ProcessingJob
+	{
+		std::thread thread;
+		std::shared_ptr<std::atomic<bool>> isFinished;
+	};
+	///@endcond
+
+	//the processing in progress
+	ProcessingJob m_processingJob;
+
+	//processings cancelled but still running, joined once finished
+	std::vector<ProcessingJob> m_cancelledJobs;
+
+	//flag shared with the image processor to cancel the processing
+	ImageProcessor::cancellation_token m_cancellationToken;
+
+	//identify the last processing job to ignore notifications from cancelled ones
+	unsigned int m_jobId = 0;
 
 	/**
 	 * @brief m_imageFile name of the image file.
@@ -81,8 +175,8 @@ private:
 	 */
 	std::string m_imageFile = (":/data/data.png");
 
-	//To know if the index needs to be set
-	bool m_useIndex = true;
+	//how the vertices of the next height maps are given to OpenGL
+	ChunkedHeightMap::MeshMode m_meshMode = ChunkedHeightMap::INDEXED;
 };
 
 #endif // MAINWINDOW_H
@@ -16,6 +16,13 @@
 const float THRESHOLD_1 = 0.029f;
 const float THRESHOLD_2 = 0.065f;
 
+//number of rows processed between two checks of the cancellation token
+const unsigned int TILE_ROWS = 32;
+
+//names of the stages in the order of ImageProcessor::Stage, also used for the instrumentation
+const char * const STAGE_NAMES[] =
+	{"Loading", "Linear filtering", "Gradient norm", "Canny algorithm", "Done"};
+
 //******************************************************************************
 //  Include
 //******************************************************************************
@@ -25,9 +32,20 @@ const float THRESHOLD_2 = 0.065f;
 #include <iostream>
 #include "ImageProcessor.h"
 #include "tools/ParallelTool.h"
+#include "tools/Instrumentation.h"
 
 //------------------------------------------------------------------------------
-ImageProcessor::ImageProcessor(std::string const& fileName)
+ProcessingCancelled::ProcessingCancelled():
+//------------------------------------------------------------------------------
+	std::runtime_error("Processing cancelled")
+//------------------------------------------------------------------------------
+{
+}
+
+//------------------------------------------------------------------------------
+ImageProcessor::ImageProcessor(std::string const& fileName):
+//------------------------------------------------------------------------------
+	m_matrixPool(MatrixPool::getSharedPool())
 //------------------------------------------------------------------------------
 {
 	loadData(fileName);
@@ -35,7 +53,9 @@ ImageProcessor::ImageProcessor(std::string const& fileName)
 }
 
 //------------------------------------------------------------------------------
-ImageProcessor::ImageProcessor()
+ImageProcessor::ImageProcessor():
+//------------------------------------------------------------------------------
+	m_matrixPool(MatrixPool::getSharedPool())
 //------------------------------------------------------------------------------
 {
 }
@@ -43,37 +63,83 @@ ImageProcessor::ImageProcessor()
 //------------------------------------------------------------------------------
 void ImageProcessor::setRawData(Types::float_matrix const & imageData, unsigned int n, unsigned int m)
 //------------------------------------------------------------------------------
+{
+	setRawData(std::make_shared<const Types::float_matrix>(imageData), n, m);
+}
+
+//------------------------------------------------------------------------------
+void ImageProcessor::setRawData(Types::float_matrix && imageData, unsigned int n, unsigned int m)
+//------------------------------------------------------------------------------
+{
+	setRawData(std::make_shared<const Types::float_matrix>(std::move(imageData)), n, m);
+}
+
+//------------------------------------------------------------------------------
+void ImageProcessor::setRawData(Types::shared_matrix const& imageData, unsigned int n, unsigned int m)
+//------------------------------------------------------------------------------
 {
 	m_rawData = imageData;
 	m_n = n;
 	m_m = m;
+	Instrumentation::setBytes("Raw data", getMatrixBytes());
 
 	processImage();
 }
 
 //------------------------------------------------------------------------------
-Types::float_matrix ImageProcessor::getRawData() const
+void ImageProcessor::setProgressCallback(progress_callback const& progressCallback)
+//------------------------------------------------------------------------------
+{
+	m_progressCallback = progressCallback;
+}
+
+//------------------------------------------------------------------------------
+void ImageProcessor::setCancellationToken(cancellation_token const& cancellationToken)
+//------------------------------------------------------------------------------
+{
+	m_cancellationToken = cancellationToken;
+}
+
+//------------------------------------------------------------------------------
+void ImageProcessor::setMatrixPool(std::shared_ptr<MatrixPool> const& matrixPool)
+//------------------------------------------------------------------------------
+{
+	m_matrixPool = matrixPool;
+}
+
+//------------------------------------------------------------------------------
+std::string ImageProcessor::getStageName(Stage stage)
+//------------------------------------------------------------------------------
+{
+	if(stage >= LOADING && stage < STAGE_COUNT)
+		return STAGE_NAMES[stage];
+	else
+		return STAGE_NAMES[STAGE_COUNT];
+}
+
+//------------------------------------------------------------------------------
+Types::shared_matrix ImageProcessor::getRawData() const
 //------------------------------------------------------------------------------
 {
 	return m_rawData;
 }
 
 //------------------------------------------------------------------------------
-Types::float_matrix ImageProcessor::getSmoothedData() const
+Types::shared_matrix ImageProcessor::getSmoothedData() const
 //------------------------------------------------------------------------------
 {
 	return m_smoothedData;
 }
 
 //------------------------------------------------------------------------------
-Types::float_matrix ImageProcessor::getGradientData() const
+Types::shared_matrix ImageProcessor::getGradientData() const
 //------------------------------------------------------------------------------
 {
 	return m_gradientData;
 }
 
 //------------------------------------------------------------------------------
-Types::float_matrix ImageProcessor::getCannyData() const
+Types::shared_matrix ImageProcessor::getCannyData() const
 //------------------------------------------------------------------------------
 {
 	return m_cannyData;
@@ -97,6 +163,8 @@ unsigned int ImageProcessor::getN() const
 void ImageProcessor::loadData(std::string const& fileName)
 //------------------------------------------------------------------------------
 {
+	ScopedTimer timer(STAGE_NAMES[LOADING]);
+
 	//Load the image
 	QImage image(fileName.c_str());
 
@@ -108,8 +176,9 @@ void ImageProcessor::loadData(std::string const& fileName)
 	{
 		if(image.format() == QImage::Format_Grayscale8)
 		{
-			//Allocate memory
-			m_rawData.resize(m_n, Types::float_line(m_m));
+			//Give the previous image back to the pool before taking a buffer
+			m_rawData.reset();
+			std::shared_ptr<Types::float_matrix> rawData(m_matrixPool->acquire(m_n, m_m));
 
 			unsigned char * pLine;
 
@@ -121,9 +190,15 @@ void ImageProcessor::loadData(std::string const& fileName)
 				//read all the data of the line and store them as floats in the [0,1] range
 				for(unsigned int j(0); j < m_m; j++)
 				{
-					m_rawData[i][j] = float(pLine[j])/255.f;
+					(*rawData)[i][j] = float(pLine[j])/255.f;
 				}
 			}
+
+			//The raw data is not modified anymore
+			m_rawData = rawData;
+			Instrumentation::setBytes("Raw data", getMatrixBytes());
+
+			reportProgress(LOADING, 1.f);
 		}
 		else
 			throw std::runtime_error("Wrong file : unsusual format, requires grayscale");
@@ -132,6 +207,92 @@ void ImageProcessor::loadData(std::string const& fileName)
 		throw std::runtime_error("Wrong file name : cannot process " + fileName);
 }
 
+//------------------------------------------------------------------------------
+void ImageProcessor::prepareOutput(std::shared_ptr<Types::float_matrix> &output)
+//------------------------------------------------------------------------------
+{
+	//The pool hands the same buffer back unless a getter's caller still uses it,
+	//since they must not see it change
+	output.reset();
+	output = m_matrixPool->acquire(m_n, m_m);
+}
+
+//------------------------------------------------------------------------------
+Types::float_matrix ImageProcessor::createLinearFilter()
+//------------------------------------------------------------------------------
+{
+	Types::float_matrix linearFilter({Types::float_line({2, 4, 5, 4, 2}),
+										Types::float_line({4, 9, 12, 9, 4}),
+										Types::float_line({5, 12, 15, 12, 5}),
+										Types::float_line({4, 9, 12, 9, 4}),
+										Types::float_line({2, 4, 5, 4, 2})});
+
+	for_each(linearFilter.begin(), linearFilter.end(),
+			 [](Types::float_line &l){for_each(l.begin(), l.end(),
+			 [](float &n){n /= 159.f;});});
+
+	return linearFilter;
+}
+
+//------------------------------------------------------------------------------
+long long ImageProcessor::getMatrixBytes() const
+//------------------------------------------------------------------------------
+{
+	return (long long)(m_n) * (sizeof(Types::float_line) + m_m * sizeof(float));
+}
+
+//------------------------------------------------------------------------------
+bool ImageProcessor::isCancelled() const
+//------------------------------------------------------------------------------
+{
+	return m_cancellationToken && m_cancellationToken->load();
+}
+
+//------------------------------------------------------------------------------
+void ImageProcessor::reportProgress(Stage stage, float progress) const
+//------------------------------------------------------------------------------
+{
+	if(m_progressCallback)
+		m_progressCallback(stage, progress);
+}
+
+//------------------------------------------------------------------------------
+template<class F> void ImageProcessor::performStage(Stage stage, F const& functor)
+//------------------------------------------------------------------------------
+{
+	//wall time of the stage, the functions called by the functor measure the busy time
+	ScopedTimer timer(STAGE_NAMES[stage]);
+
+	//hardware events of the stage, the worker threads included
+	ScopedCounters counters(STAGE_NAMES[stage], (long long)(m_n) * m_m);
+
+	//number of rows processed by all the threads
+	std::atomic<unsigned int> processedRows(0);
+
+	ParallelTool::performInParallel(
+		[this, stage, &functor, &processedRows](unsigned int leftIndex, unsigned int rightIndex)
+		{
+			for(unsigned int tileBegin(leftIndex); tileBegin < rightIndex; tileBegin += TILE_ROWS)
+			{
+				//Stop between two tiles if the processing has been cancelled
+				if(isCancelled())
+					return;
+
+				unsigned int tileEnd(std::min(tileBegin + TILE_ROWS, rightIndex));
+
+				functor(tileBegin, tileEnd);
+
+				unsigned int rowCount(processedRows += tileEnd - tileBegin);
+				reportProgress(stage, float(rowCount) / float(m_n));
+			}
+		},
+		0, m_n);
+
+	//The threads have stopped, make the caller aware of the cancellation
+	if(isCancelled())
+		throw ProcessingCancelled();
+}
+
 //------------------------------------------------------------------------------
 std::pair<int, int> ImageProcessor::obtainLowerIndices(int i, int j)
 //------------------------------------------------------------------------------
@@ -163,6 +324,8 @@ void ImageProcessor::applyLinearFilter(const Types::float_matrix &linearFilter,
 								unsigned int leftIndex, unsigned int rightIndex)
 //------------------------------------------------------------------------------
 {
+	ScopedTimer timer("applyLinearFilter");
+
 	//Make sure the filter's dimentions are odd numbers
 	if(linearFilter.size() % 2 && linearFilter[0].size() % 2)
 	{
@@ -173,6 +336,9 @@ void ImageProcessor::applyLinearFilter(const Types::float_matrix &linearFilter,
 		int n(m_n);
 		int m(m_m);
 
+		Types::float_matrix const& rawData(*m_rawData);
+		Types::float_matrix& smoothedData(*m_smoothedData);
+
 		for(int i((int)(leftIndex)); i < (int)(rightIndex); i++)
 		{
 			for(int j(0); j < m; j++)
@@ -209,13 +375,13 @@ void ImageProcessor::applyLinearFilter(const Types::float_matrix &linearFilter,
 
 						//Add the value of the read index multiplied by the corresponding
 						//value in the filter to the result for the current pixel
-						pixelSum += m_rawData[iReadIndex][jReadIndex] *
+						pixelSum += rawData[iReadIndex][jReadIndex] *
 							linearFilter[iFilter + filterIRadius][jFilter + filterJRadius];
 					}
 				}
 
 				//Set the data
-				m_smoothedData[i][j] = pixelSum;
+				smoothedData[i][j] = pixelSum;
 			}
 		}
 	}
@@ -227,8 +393,14 @@ void ImageProcessor::applyLinearFilter(const Types::float_matrix &linearFilter,
 void ImageProcessor::applyGradientNorm(unsigned int leftIndex, unsigned int rightIndex)
 //------------------------------------------------------------------------------
 {
+	ScopedTimer timer("applyGradientNorm");
+
 	QVector2D gradient;
 
+	Types::float_matrix const& smoothedData(*m_smoothedData);
+	Types::float_matrix& gradientData(*m_gradientData);
+	Types::float_matrix& gradientsAngles(*m_gradientsAngles);
+
 	for(unsigned int i(leftIndex); i < rightIndex; i++)
 	{
 		for(unsigned int j(0); j < m_m; j++)
@@ -237,19 +409,19 @@ void ImageProcessor::applyGradientNorm(unsigned int leftIndex, unsigned int righ
 			std::pair<int, int> upperIndices(obtainUpperIndices(i, j));
 
 			//gradient for the x axis
-			gradient.setX(m_smoothedData[upperIndices.first][j] -
-					m_smoothedData[lowerIndices.first][j]);
+			gradient.setX(smoothedData[upperIndices.first][j] -
+					smoothedData[lowerIndices.first][j]);
 
 			//gradient for the y axis
-			gradient.setY(m_smoothedData[i][upperIndices.second] -
-					m_smoothedData[i][lowerIndices.second]);
+			gradient.setY(smoothedData[i][upperIndices.second] -
+					smoothedData[i][lowerIndices.second]);
 
 			//Store angles to apply Canny algorithm Later
-			m_gradientsAngles[i][j] = atan((gradient.x() /
+			gradientsAngles[i][j] = atan((gradient.x() /
 											gradient.y()) * 4 / M_PI);
 
 			//Store gradient norm
-			m_gradientData[i][j] = gradient.length();
+			gradientData[i][j] = gradient.length();
 		}
 	}
 }
@@ -258,20 +430,26 @@ void ImageProcessor::applyGradientNorm(unsigned int leftIndex, unsigned int righ
 void ImageProcessor::applyCannyAlgorithm(unsigned int leftIndex, unsigned int rightIndex)
 //------------------------------------------------------------------------------
 {
+	ScopedTimer timer("applyCannyAlgorithm");
+
+	Types::float_matrix const& gradientData(*m_gradientData);
+	Types::float_matrix const& gradientsAngles(*m_gradientsAngles);
+	Types::float_matrix& cannyData(*m_cannyData);
+
 	for(unsigned int i(leftIndex); i < rightIndex; i++)
 	{
 		for(unsigned int j(0); j < m_m; j++)
 		{
 			//In case the value of the gradient is below the first threshold,
 			//we ignore the corresponding pixel
-			if(m_gradientData[i][j] < THRESHOLD_1)
+			if(gradientData[i][j] < THRESHOLD_1)
 			{
-				m_cannyData[i][j] = 0;
+				cannyData[i][j] = 0;
 			}
 			else
 			{
 				//Calculate the value of gradient norm for the adjacent pixels in the gradient directions
-				float theta = m_gradientsAngles[i][j];
+				float theta = gradientsAngles[i][j];
 
 				std::pair<int, int> lowerIndices(obtainLowerIndices(i, j));
 				std::pair<int, int> upperIndices(obtainUpperIndices(i, j));
@@ -282,100 +460,108 @@ void ImageProcessor::applyCannyAlgorithm(unsigned int leftIndex, unsigned int ri
 				if(theta < - 1)
 				{
 					//Interpolate the value for both directions
-					maxChecker1 = m_gradientData[lowerIndices.first][j] * ( -1 - theta) +
-						m_gradientData[lowerIndices.first][upperIndices.second] * (2 + theta);
+					maxChecker1 = gradientData[lowerIndices.first][j] * ( -1 - theta) +
+						gradientData[lowerIndices.first][upperIndices.second] * (2 + theta);
 
-					maxChecker2 = m_gradientData[upperIndices.first][j] * ( -1 - theta) +
-						m_gradientData[upperIndices.first][lowerIndices.second] * (2 + theta);
+					maxChecker2 = gradientData[upperIndices.first][j] * ( -1 - theta) +
+						gradientData[upperIndices.first][lowerIndices.second] * (2 + theta);
 				}
 				else if(theta < 0)
 				{
-					maxChecker1 = m_gradientData[lowerIndices.first][upperIndices.second] * (- theta) +
-						m_gradientData[i][upperIndices.second] * (1 + theta);
+					maxChecker1 = gradientData[lowerIndices.first][upperIndices.second] * (- theta) +
+						gradientData[i][upperIndices.second] * (1 + theta);
 
-					maxChecker2 = m_gradientData[upperIndices.first][lowerIndices.second] * (- theta) +
-						m_gradientData[i][lowerIndices.second] * (1 + theta);
+					maxChecker2 = gradientData[upperIndices.first][lowerIndices.second] * (- theta) +
+						gradientData[i][lowerIndices.second] * (1 + theta);
 				}
 				else if(theta < 1)
 				{
-					maxChecker1 = m_gradientData[i][upperIndices.second] * (1 - theta) +
-							m_gradientData[upperIndices.first][upperIndices.second] * (theta);
+					maxChecker1 = gradientData[i][upperIndices.second] * (1 - theta) +
+							gradientData[upperIndices.first][upperIndices.second] * (theta);
 
-					maxChecker2 = m_gradientData[i][lowerIndices.second] * (1 - theta) +
-							m_gradientData[lowerIndices.first][lowerIndices.second] * (theta);
+					maxChecker2 = gradientData[i][lowerIndices.second] * (1 - theta) +
+							gradientData[lowerIndices.first][lowerIndices.second] * (theta);
 				}
 
 				else
 				{
-					maxChecker1 = m_gradientData[upperIndices.first][j] * (theta - 1) +
-						m_gradientData[upperIndices.first][upperIndices.second] * (2 - theta);
+					maxChecker1 = gradientData[upperIndices.first][j] * (theta - 1) +
+						gradientData[upperIndices.first][upperIndices.second] * (2 - theta);
 
-					maxChecker2 = m_gradientData[lowerIndices.first][j] * (theta - 1) +
-						m_gradientData[lowerIndices.first][lowerIndices.second] * (2 - theta);
+					maxChecker2 = gradientData[lowerIndices.first][j] * (theta - 1) +
+						gradientData[lowerIndices.first][lowerIndices.second] * (2 - theta);
 				}
 
 				//If the value of the pixel is not bigger than the value of adjacent pixels
 				//in the gradient directions, we ignore it to make edges thinner
-				if(m_gradientData[i][j] < std::max(maxChecker1, maxChecker2))
+				if(gradientData[i][j] < std::max(maxChecker1, maxChecker2))
 				{
-					m_cannyData[i][j] = 0;
+					cannyData[i][j] = 0;
 				}
 				//if the value is bigger than the second threshold, we keep it
-				else if(m_gradientData[i][j] > THRESHOLD_2)
+				else if(gradientData[i][j] > THRESHOLD_2)
 				{
-					m_cannyData[i][j] = 1;
+					cannyData[i][j] = 1;
 				}
 				//If the value is between the two thresholds, we apply the last part of Canny
 				//algorithm: hysteresis
-				else if(m_gradientData[i][j] > THRESHOLD_1)
+				else if(gradientData[i][j] > THRESHOLD_1)
 				{
 					//Values of gradient norm in the two directions of the gradient's normal vector
 					float hysteresisChecker1, hysteresisChecker2;
 
 					if(theta < - 1)
 					{
-						hysteresisChecker1 = m_gradientData[i][upperIndices.second] * (-1 - theta) +
-							m_gradientData[upperIndices.first][upperIndices.second] * (2 + theta);
+						hysteresisChecker1 = gradientData[i][upperIndices.second] * (-1 - theta) +
+							gradientData[upperIndices.first][upperIndices.second] * (2 + theta);
 
-						hysteresisChecker2 = m_gradientData[i][lowerIndices.second] * (-1 - theta) +
-							m_gradientData[lowerIndices.first][lowerIndices.second] * (2 + theta);
+						hysteresisChecker2 = gradientData[i][lowerIndices.second] * (-1 - theta) +
+							gradientData[lowerIndices.first][lowerIndices.second] * (2 + theta);
 					}
 					else if(theta < 0)
 					{
-						hysteresisChecker1 = m_gradientData[upperIndices.first][upperIndices.second] *
+						hysteresisChecker1 = gradientData[upperIndices.first][upperIndices.second] *
 								(- theta) +
-							m_gradientData[upperIndices.first][j] * (1 + theta);
+							gradientData[upperIndices.first][j] * (1 + theta);
 
-						hysteresisChecker2 = m_gradientData[lowerIndices.first][upperIndices.second] *
+						hysteresisChecker2 = gradientData[lowerIndices.first][upperIndices.second] *
 								(- theta) +
-							m_gradientData[lowerIndices.first][j] * (1 + theta);
+							gradientData[lowerIndices.first][j] * (1 + theta);
 					}
 					else if(theta < 1)
 					{
-						hysteresisChecker1 = m_gradientData[upperIndices.first][j] * (1 - theta) +
-							m_gradientData[upperIndices.first][lowerIndices.second] * (theta);
+						hysteresisChecker1 = gradientData[upperIndices.first][j] * (1 - theta) +
+							gradientData[upperIndices.first][lowerIndices.second] * (theta);
 
-						hysteresisChecker2 = m_gradientData[lowerIndices.first][j] * (1 - theta) +
-							m_gradientData[lowerIndices.first][lowerIndices.second] * (theta);
+						hysteresisChecker2 = gradientData[lowerIndices.first][j] * (1 - theta) +
+							gradientData[lowerIndices.first][lowerIndices.second] * (theta);
 					}
 					else
 					{
-						hysteresisChecker1 = m_gradientData[upperIndices.first][lowerIndices.second] *
+						hysteresisChecker1 = gradientData[upperIndices.first][lowerIndices.second] *
 								(2 - theta) +
-							m_gradientData[i][lowerIndices.second] * (theta - 1);
+							gradientData[i][lowerIndices.second] * (theta - 1);
 
-						hysteresisChecker2 = m_gradientData[lowerIndices.first][upperIndices.second] *
+						hysteresisChecker2 = gradientData[lowerIndices.first][upperIndices.second] *
 								(2 - theta) +
-							m_gradientData[i][upperIndices.second] * (theta - 1);
+							gradientData[i][upperIndices.second] * (theta - 1);
 					}
 
 					//If the value of adjacent pixels in gradient's normal vector directions,
 					//we keep it
 					if(std::max(hysteresisChecker1, hysteresisChecker2) > THRESHOLD_1)
 					{
-						m_cannyData[i][j] = 1;
+						cannyData[i][j] = 1;
+					}
+					//The buffer may be reused, every pixel has to be written
+					else
+					{
+						cannyData[i][j] = 0;
 					}
-
+				}
+				else
+				{
+					cannyData[i][j] = 0;
 				}
 			}
 		}
@@ -386,28 +572,26 @@ void ImageProcessor::applyCannyAlgorithm(unsigned int leftIndex, unsigned int ri
 void ImageProcessor::processImage()
 //------------------------------------------------------------------------------
 {
-	if(m_n != 0 && m_m != 0 && m_rawData.size() == m_n && m_rawData[0].size() == m_m)
+	if(m_n != 0 && m_m != 0 && m_rawData && m_rawData->size() == m_n && (*m_rawData)[0].size() == m_m)
 	{
-		//Alocate memory
-		m_smoothedData.resize(m_n, Types::float_line(m_m));
-		m_gradientsAngles.resize(m_n, Types::float_line(m_m));
-		m_gradientData.resize(m_n, Types::float_line(m_m));
-		m_cannyData.resize(m_n, Types::float_line(m_m));
-
-		//Create the linear filter
-		Types::float_matrix linearFilter({Types::float_line({2, 4, 5, 4, 2}),
-											Types::float_line({4, 9, 12, 9, 4}),
-											Types::float_line({5, 12, 15, 12, 5}),
-											Types::float_line({4, 9, 12, 9, 4}),
-											Types::float_line({2, 4, 5, 4, 2})});
-
-		for_each(linearFilter.begin(), linearFilter.end(),
-				 [](Types::float_line &l){for_each(l.begin(), l.end(),
-				 [](float &n){n /= 159.f;});});
+		//Take the buffers from the pool, no allocation if an image of the same size
+		//has already been processed and its results are not used anymore
+		prepareOutput(m_smoothedData);
+		prepareOutput(m_gradientData);
+		prepareOutput(m_cannyData);
+		prepareOutput(m_gradientsAngles);
+
+		Instrumentation::setBytes("Smoothed data", getMatrixBytes());
+		Instrumentation::setBytes("Gradient data", getMatrixBytes());
+		Instrumentation::setBytes("Gradient angles", getMatrixBytes());
+		Instrumentation::setBytes("Canny data", getMatrixBytes());
+
+		//Create the linear filter once
+		static const Types::float_matrix linearFilter(createLinearFilter());
 
 		//Perform image processing in parallel to reduce computation time
-		ParallelTool::performInParallel(
-			[this, linearFilter](unsigned int leftIndex, unsigned int rightIndex)
+		performStage(LINEAR_FILTERING,
+			[this](unsigned int leftIndex, unsigned int rightIndex)
 			{
 				try
 				{
@@ -417,22 +601,19 @@ void ImageProcessor::processImage()
 				{
 					std::cerr << "ERROR : " << e.what() << std::endl;
 				}
-			},
-			0, m_n);
+			});
 
-		ParallelTool::performInParallel(
+		performStage(GRADIENT_NORM,
 			[this](unsigned int leftIndex, unsigned int rightIndex)
 			{
 				applyGradientNorm(leftIndex, rightIndex);
-			},
-			0, m_n);
+			});
 
-		ParallelTool::performInParallel(
+		performStage(CANNY_ALGORITHM,
 			[this](unsigned int leftIndex, unsigned int rightIndex)
 			{
 				applyCannyAlgorithm(leftIndex, rightIndex);
-			},
-			0, m_n);
+			});
 	}
 	else
 	{
@@ -19,8 +19,26 @@
 //******************************************************************************
 #include <QVector2D>
 #include <QImage>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <stdexcept>
 
 #include "tools/Types.h"
+#include "tools/MatrixPool.h"
+
+//==============================================================================
+/**
+*  @class  ProcessingCancelled
+*  @brief  ProcessingCancelled is thrown when the processing has been
+*			cancelled through the cancellation token of the image processor
+*/
+//==============================================================================
+class ProcessingCancelled: public std::runtime_error
+{
+public:
+	ProcessingCancelled();
+};
 
 //==============================================================================
 /**
@@ -32,6 +50,30 @@
 class ImageProcessor
 {
 public:
+	/**
+	 * @brief The Stage enum lists the steps of the processing, in order
+	 */
+	enum Stage
+	{
+		LOADING,
+		LINEAR_FILTERING,
+		GRADIENT_NORM,
+		CANNY_ALGORITHM,
+		STAGE_COUNT
+	};
+
+	/**
+	 * @brief progress_callback called with the current stage and its progress in the [0,1] range.
+	 * It may be called from several worker threads at the same time.
+	 */
+	typedef std::function<void(Stage stage, float progress)> progress_callback;
+
+	/**
+	 * @brief cancellation_token set it to true to stop the processing
+	 * at the next tile boundary
+	 */
+	typedef std::shared_ptr<std::atomic<bool>> cancellation_token;
+
 	/**
 	 * @brief ImageProcessor Overloaded constructor with the name of the image file
 	 * Load the file and perform the procesing
@@ -61,7 +103,7 @@ public:
 	/**
 	 * @brief setRawData Set the raw data of the imageProcessor and call processImage
 	 * to apply Canny algorithm and update all the atributes
-	 * @param imageData Data to be treated, should be in the [0,1] range
+	 * @param imageData Data to be treated, should be in the [0,1] range. It is copied
 	 * @param n number of columns
 	 * @param m number of rows
 	 */
@@ -69,29 +111,75 @@ public:
 					unsigned int n, unsigned int m);
 
 	/**
-	 * @brief getRawData get data corresponding to an image
+	 * @brief setRawData Same as above without copy
+	 * @param imageData Data to be treated, should be in the [0,1] range. It is moved
+	 * @param n number of columns
+	 * @param m number of rows
+	 */
+	void setRawData(Types::float_matrix && imageData,
+					unsigned int n, unsigned int m);
+
+	/**
+	 * @brief setRawData Same as above, the data is shared with the caller
+	 * @param imageData Data to be treated, should be in the [0,1] range
+	 * @param n number of columns
+	 * @param m number of rows
+	 */
+	void setRawData(Types::shared_matrix const& imageData,
+					unsigned int n, unsigned int m);
+
+	/**
+	 * @brief setProgressCallback Set the function notified after each processed tile
+	 * @param progressCallback the callback, must be thread safe
+	 */
+	void setProgressCallback(progress_callback const& progressCallback);
+
+	/**
+	 * @brief setCancellationToken Set the flag checked between tiles.
+	 * processImage() throws ProcessingCancelled once it is set to true
+	 * @param cancellationToken the shared flag
+	 */
+	void setCancellationToken(cancellation_token const& cancellationToken);
+
+	/**
+	 * @brief setMatrixPool Set the pool providing the buffers of the stages.
+	 * The shared pool is used by default, so that the buffers are reused between images
+	 * @param matrixPool the pool
+	 */
+	void setMatrixPool(std::shared_ptr<MatrixPool> const& matrixPool);
+
+	/**
+	 * @brief getStageName get a displayable name for a stage
+	 * @param stage the stage
+	 * @return the name of the stage
+	 */
+	static std::string getStageName(Stage stage);
+
+	/**
+	 * @brief getRawData get data corresponding to an image, without copy.
+	 * The data will not change, a new buffer is used if the image is processed again
 	 * @return data before processing
 	 * @throws
 	 */
-	Types::float_matrix getRawData() const;
+	Types::shared_matrix getRawData() const;
 
 	/**
-	 * @brief getSmoothedData get data corresponding to an image
+	 * @brief getSmoothedData get data corresponding to an image, without copy
 	 * @return data after linear filtering
 	 */
-	Types::float_matrix getSmoothedData() const;
+	Types::shared_matrix getSmoothedData() const;
 
 	/**
-	 * @brief getGradientData get data corresponding to an image
+	 * @brief getGradientData get data corresponding to an image, without copy
 	 * @return gradient norm for each pixel
 	 */
-	Types::float_matrix getGradientData() const;
+	Types::shared_matrix getGradientData() const;
 
 	/**
-	 * @brief getCannyData get data corresponding to an image
+	 * @brief getCannyData get data corresponding to an image, without copy
 	 * @return data after Canny  algorithm
 	 */
-	Types::float_matrix getCannyData() const;
+	Types::shared_matrix getCannyData() const;
 
 	/**
 	 * @brief getM get the size of the image
@@ -123,6 +211,47 @@ private:
 	 */
 	std::pair<int, int> obtainUpperIndices(int i, int j);
 
+	/**
+	 * @brief prepareOutput get an output buffer from the pool with the size of the image,
+	 * not shared before writing into it. The previous buffer is given back to the pool
+	 * @param output the output buffer
+	 */
+	void prepareOutput(std::shared_ptr<Types::float_matrix> &output);
+
+	/**
+	 * @brief createLinearFilter create the gaussian filter used to smooth the image
+	 * @return the normalised 5x5 filter
+	 */
+	static Types::float_matrix createLinearFilter();
+
+	/**
+	 * @brief getMatrixBytes
+	 * @return the memory used by a matrix of the size of the image
+	 */
+	long long getMatrixBytes() const;
+
+	/**
+	 * @brief isCancelled check the cancellation token
+	 * @return true if the processing has to stop
+	 */
+	bool isCancelled() const;
+
+	/**
+	 * @brief reportProgress call the progress callback if there is one
+	 * @param stage the current stage
+	 * @param progress progress of the stage in the [0,1] range
+	 */
+	void reportProgress(Stage stage, float progress) const;
+
+	/**
+	 * @brief performStage Apply a row functor in parallel, tile by tile,
+	 * checking the cancellation token and reporting the progress between tiles
+	 * @param stage the current stage
+	 * @param functor the functor to apply on a range of rows
+	 * @throws ProcessingCancelled
+	 */
+	template<class F> void performStage(Stage stage, F const& functor);
+
 	/**
 	 * @brief applyLinearFilter Apply a linear filter on the raw data
 	 * and produce the smoother preprocessed data m_smoothedData
@@ -151,16 +280,28 @@ private:
 	 */
 	void applyCannyAlgorithm(unsigned int leftIndex, unsigned int rightIndex);
 
-	Types::float_matrix m_rawData, //Data before processing
-		m_smoothedData, //Data after the first step of the processing: the linear filtering
+	//Data before processing, never modified
+	Types::shared_matrix m_rawData;
+
+	//Outputs of the stages, shared with the callers of the getters
+	std::shared_ptr<Types::float_matrix> m_smoothedData, //Data after the first step of the processing: the linear filtering
 		m_gradientData, //Data after gradient processing
 		m_cannyData; //Data after edge detection using Canny algorithm
 
 	//Save all the gradients angles to apply Canny Algorithm
-	Types::float_matrix m_gradientsAngles;
+	std::shared_ptr<Types::float_matrix> m_gradientsAngles;
+
+	//Provide the buffers above
+	std::shared_ptr<MatrixPool> m_matrixPool;
 
 	unsigned int m_m, //number of columns
 		m_n; //number of rows
+
+	//Notified after each tile, may be empty
+	progress_callback m_progressCallback;
+
+	//Checked between tiles, may be null
+	cancellation_token m_cancellationToken;
 };
 
 #endif // IMAGEPROCESSOR_H
@@ -21,6 +21,9 @@
 int main(int argc, char **argv)
 //------------------------------------------------------------------------------
 {
+	//Share programs and buffers between the render windows
+	QApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
+
 	QApplication app(argc, argv);
 
 	MainWindow w;
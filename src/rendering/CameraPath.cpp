@@ -0,0 +1,131 @@
+/**
+*******************************************************************************
+*
+*  @file       CameraPath.cpp
+*
+*  @brief      Class to record and replay the positions of the camera and the light
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//	Include
+//******************************************************************************
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include "CameraPath.h"
+
+//------------------------------------------------------------------------------
+CameraPath::CameraPath():
+//------------------------------------------------------------------------------
+	m_frames()
+//------------------------------------------------------------------------------
+{
+}
+
+//------------------------------------------------------------------------------
+CameraPath::CameraPath(std::string const& fileName):
+//------------------------------------------------------------------------------
+	m_frames()
+//------------------------------------------------------------------------------
+{
+	std::ifstream file(fileName.c_str());
+
+	if(!file)
+		throw std::runtime_error("Cannot open the camera path " + fileName);
+
+	float eyeX, eyeY, eyeZ, lightX, lightY, lightZ, zoomAngle;
+
+	while(file >> eyeX >> eyeY >> eyeZ >> lightX >> lightY >> lightZ >> zoomAngle)
+	{
+		m_frames.push_back({QVector3D(eyeX, eyeY, eyeZ),
+			QVector3D(lightX, lightY, lightZ), zoomAngle});
+	}
+
+	if(!file.eof())
+		throw std::runtime_error("Invalid camera path " + fileName);
+}
+
+//------------------------------------------------------------------------------
+CameraPath CameraPath::createOrbit(unsigned int frameCount, float radius, float height, float zoomAngle)
+//------------------------------------------------------------------------------
+{
+	CameraPath path;
+
+	for(unsigned int frame(0); frame < frameCount; frame++)
+	{
+		float angle(2.f * float(M_PI) * float(frame) / float(std::max(frameCount, 1u)));
+
+		path.addFrame({QVector3D(radius * cosf(angle), radius * sinf(angle), height),
+			QVector3D(3.f * cosf(-angle), 3.f * sinf(-angle), 5.f).normalized(), zoomAngle});
+	}
+
+	return path;
+}
+
+//------------------------------------------------------------------------------
+CameraPath CameraPath::createLightSweep(unsigned int frameCount, QVector3D const& eyePos, float zoomAngle)
+//------------------------------------------------------------------------------
+{
+	CameraPath path;
+
+	for(unsigned int frame(0); frame < frameCount; frame++)
+	{
+		float angle(2.f * float(M_PI) * float(frame) / float(std::max(frameCount, 1u)));
+
+		//same elevation as the default light
+		path.addFrame({eyePos, QVector3D(3.f * cosf(angle), 3.f * sinf(angle), 5.f).normalized(), zoomAngle});
+	}
+
+	return path;
+}
+
+//------------------------------------------------------------------------------
+void CameraPath::addFrame(Frame const& frame)
+//------------------------------------------------------------------------------
+{
+	m_frames.push_back(frame);
+}
+
+//------------------------------------------------------------------------------
+void CameraPath::clear()
+//------------------------------------------------------------------------------
+{
+	m_frames.clear();
+}
+
+//------------------------------------------------------------------------------
+void CameraPath::save(std::string const& fileName) const
+//------------------------------------------------------------------------------
+{
+	std::ofstream file(fileName.c_str());
+
+	if(!file)
+		throw std::runtime_error("Cannot write the camera path " + fileName);
+
+	for(Frame const& frame : m_frames)
+	{
+		file << frame.eyePos.x() << " " << frame.eyePos.y() << " " << frame.eyePos.z() << " "
+			<< frame.lightDir.x() << " " << frame.lightDir.y() << " " << frame.lightDir.z() << " "
+			<< frame.zoomAngle << std::endl;
+	}
+}
+
+//------------------------------------------------------------------------------
+std::vector<CameraPath::Frame> const& CameraPath::getFrames() const
+//------------------------------------------------------------------------------
+{
+	return m_frames;
+}
+
+//------------------------------------------------------------------------------
+size_t CameraPath::getFrameCount() const
+//------------------------------------------------------------------------------
+{
+	return m_frames.size();
+}
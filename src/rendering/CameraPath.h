@@ -0,0 +1,104 @@
+#ifndef CAMERAPATH_H
+#define CAMERAPATH_H
+
+/**
+*******************************************************************************
+*
+*  @file       CameraPath.h
+*
+*  @brief      Class to record and replay the positions of the camera and the light
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <QVector3D>
+#include <string>
+#include <vector>
+
+//==============================================================================
+/**
+*  @class  CameraPath
+*  @brief  CameraPath is a class to record the camera and the light of each
+*			rendered frame, save them to a file and replay them.
+*			The file contains one frame per line: the position of the camera,
+*			the direction of the light and the zoom angle, separated by spaces
+*/
+//==============================================================================
+class CameraPath
+{
+public:
+	/**
+	 * @brief The Frame struct the camera and the light of one frame
+	 */
+	struct Frame
+	{
+		QVector3D eyePos; //the position of the camera, looking at the center of the height map
+		QVector3D lightDir; //the direction from the vertices to the light
+		float zoomAngle; //vertical angle of the perspective
+	};
+
+	/**
+	 * @brief CameraPath create an empty path
+	 */
+	CameraPath();
+
+	/**
+	 * @brief CameraPath Overloaded constructor loading a path saved by save()
+	 * @param fileName the name of the file
+	 * @throws std::runtime_error if the file cannot be read
+	 */
+	CameraPath(std::string const& fileName);
+
+	/**
+	 * @brief createOrbit create a path turning around the height map
+	 * while the light turns the other way
+	 * @param frameCount number of frames
+	 * @param radius horizontal distance between the camera and the center
+	 * @param height height of the camera
+	 * @param zoomAngle the vertical angle of view of the camera
+	 * @return the path
+	 */
+	static CameraPath createOrbit(unsigned int frameCount, float radius, float height, float zoomAngle);
+
+	/**
+	 * @brief createLightSweep create a path where the camera stays still
+	 * while the light turns around the height map
+	 * @param frameCount number of frames
+	 * @param eyePos the position of the camera
+	 * @param zoomAngle the vertical angle of view of the camera
+	 * @return the path
+	 */
+	static CameraPath createLightSweep(unsigned int frameCount, QVector3D const& eyePos, float zoomAngle);
+
+	/**
+	 * @brief addFrame add a frame at the end of the path
+	 * @param frame the frame
+	 */
+	void addFrame(Frame const& frame);
+
+	/**
+	 * @brief clear remove all the frames
+	 */
+	void clear();
+
+	/**
+	 * @brief save write the path to a file
+	 * @param fileName the name of the file
+	 * @throws std::runtime_error if the file cannot be written
+	 */
+	void save(std::string const& fileName) const;
+
+	//Getters
+	std::vector<Frame> const& getFrames() const;
+	size_t getFrameCount() const;
+
+//******************************************************************************
+private:
+	std::vector<Frame> m_frames;
+};
+
+#endif // CAMERAPATH_H
@@ -0,0 +1,393 @@
+/**
+*******************************************************************************
+*
+*  @file       ChunkedHeightMap.cpp
+*
+*  @brief      Class to handle a height map split into chunks of rows.
+* A decimated preview of each chunk is available immediately
+* while the full resolution chunks are created in a background thread.
+* With the height texture, the whole height map is a single mesh generated
+* by the shaders and only the analysis is built in the background.
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//	Include
+//******************************************************************************
+#include <iostream>
+#include <algorithm>
+
+#include "ChunkedHeightMap.h"
+#include "terrainAnalysis/AmbientOcclusion.h"
+#include "terrainAnalysis/NormalMap.h"
+
+//******************************************************************************
+//  constant variables
+//******************************************************************************
+//number of rows of a full resolution chunk
+const unsigned int CHUNK_ROWS = 256;
+
+//maximum number of rows or columns of the whole preview
+const unsigned int PREVIEW_SIZE = 256;
+
+//------------------------------------------------------------------------------
+ChunkedHeightMap::ChunkedHeightMap(std::string const& fileName, MeshMode meshMode):
+//------------------------------------------------------------------------------
+	m_isCancelled(false),
+	m_uploadedChunksCount(0),
+	m_meshMode(meshMode)
+//------------------------------------------------------------------------------
+{
+	m_imageData = std::make_shared<const Types::float_matrix>(
+		HeightMapMesh::readFile(fileName, m_n, m_m));
+
+	createPreview();
+}
+
+//------------------------------------------------------------------------------
+ChunkedHeightMap::ChunkedHeightMap(Types::shared_matrix const& imageData,
+								   unsigned int n, unsigned int m, MeshMode meshMode):
+//------------------------------------------------------------------------------
+	m_imageData(imageData),
+	m_n(n),
+	m_m(m),
+	m_isCancelled(false),
+	m_uploadedChunksCount(0),
+	m_meshMode(meshMode)
+//------------------------------------------------------------------------------
+{
+	createPreview();
+}
+
+//------------------------------------------------------------------------------
+ChunkedHeightMap::~ChunkedHeightMap()
+//------------------------------------------------------------------------------
+{
+	//Stop after the chunk in progress
+	m_isCancelled = true;
+
+	if(m_buildingThread.joinable())
+		m_buildingThread.join();
+}
+
+//------------------------------------------------------------------------------
+void ChunkedHeightMap::createPreview()
+//------------------------------------------------------------------------------
+{
+	if(m_imageData && m_n > 1 && m_m > 1 && m_imageData->size() == m_n && (*m_imageData)[0].size() == m_m)
+	{
+		//Nothing to build nor to preview, the texture is uploaded by the first render
+		if(m_meshMode == HEIGHT_TEXTURE)
+		{
+			m_heightTextureMesh.reset(new HeightTextureMesh(m_imageData, m_n, m_m));
+
+			m_length = HeightMapMesh::getStep(m_n, m_m) * m_n;
+			m_width = HeightMapMesh::getStep(m_n, m_m) * m_m;
+			return;
+		}
+
+		//Split the rows, adjacent chunks share a row so that they join
+		for(unsigned int row(0); row < m_n - 1; row += CHUNK_ROWS)
+		{
+			m_chunkRows.push_back(row);
+		}
+		m_chunkRows.push_back(m_n - 1);
+
+		unsigned int chunkCount((unsigned int)(m_chunkRows.size() - 1));
+
+		//keep one row and one column every step so that the whole preview stays small
+		unsigned int step((std::max(m_n, m_m) + PREVIEW_SIZE - 1) / PREVIEW_SIZE);
+
+		m_previewChunks.resize(chunkCount);
+		m_fullChunks.resize(chunkCount);
+		m_builtChunks.resize(chunkCount);
+
+		for(unsigned int chunk(0); chunk < chunkCount; chunk++)
+		{
+			m_previewChunks[chunk].reset(new HeightMapMesh(*m_imageData, m_n, m_m,
+				m_chunkRows[chunk], m_chunkRows[chunk + 1], std::max(step, 1u)));
+		}
+
+		//All the chunks have the size of the whole mesh
+		m_length = m_previewChunks[0]->getLength();
+		m_width = m_previewChunks[0]->getWidth();
+	}
+	else
+	{
+		throw std::runtime_error("Wrong data, cannot create the model");
+	}
+}
+
+//------------------------------------------------------------------------------
+void ChunkedHeightMap::buildInBackground()
+//------------------------------------------------------------------------------
+{
+	if(!m_buildingThread.joinable())
+	{
+		m_buildingThread = std::thread(
+			[this]()
+			{
+				buildFullChunks();
+			});
+	}
+}
+
+//------------------------------------------------------------------------------
+void ChunkedHeightMap::addChunkReadyListener(const void *listener,
+											 std::function<void()> const& chunkReadyCallback)
+//------------------------------------------------------------------------------
+{
+	std::lock_guard<std::mutex> lock(m_listenersMutex);
+	m_chunkReadyListeners[listener] = chunkReadyCallback;
+}
+
+//------------------------------------------------------------------------------
+void ChunkedHeightMap::removeChunkReadyListener(const void *listener)
+//------------------------------------------------------------------------------
+{
+	//Wait for the notification in progress if any
+	std::lock_guard<std::mutex> lock(m_listenersMutex);
+	m_chunkReadyListeners.erase(listener);
+}
+
+//------------------------------------------------------------------------------
+void ChunkedHeightMap::buildFullChunks()
+//------------------------------------------------------------------------------
+{
+	try
+	{
+		//The pyramid is built in parallel in a single pass, the picking is ready before the meshes
+		std::shared_ptr<const HeightFieldTracer> tracer(std::make_shared<const HeightFieldTracer>(
+			m_imageData, m_n, m_m, HeightMapMesh::getHeightScale(m_n, m_m)));
+
+		{
+			std::lock_guard<std::mutex> lock(m_builtChunksMutex);
+			m_tracer = tracer;
+		}
+
+		//a parallel sort of the heights, the queries of the lvl plan are binary searches
+		std::shared_ptr<const LevelStatistics> levelStatistics(std::make_shared<const LevelStatistics>(
+			*m_imageData, m_n, m_m));
+
+		{
+			std::lock_guard<std::mutex> lock(m_builtChunksMutex);
+			m_levelStatistics = levelStatistics;
+		}
+
+		//a parallel pass over the cells and a counting sort, each level visits only the cells spanning it
+		std::shared_ptr<const ContourExtractor> contourExtractor(std::make_shared<const ContourExtractor>(
+			m_imageData, m_n, m_m));
+
+		{
+			std::lock_guard<std::mutex> lock(m_builtChunksMutex);
+			m_contourExtractor = contourExtractor;
+		}
+
+		//a single pass over the heights: the previews get the lighting of the full resolution
+		std::shared_ptr<const std::vector<unsigned char>> normalMap(
+			std::make_shared<const std::vector<unsigned char>>(
+				NormalMap::bake(*m_imageData, m_n, m_m, HeightMapMesh::getHeightScale(m_n, m_m))));
+
+		{
+			std::lock_guard<std::mutex> lock(m_builtChunksMutex);
+			m_normalMap = normalMap;
+		}
+
+		notifyChunkReadyListeners();
+
+		for(unsigned int chunk(0); chunk < m_builtChunks.size() && !m_isCancelled; chunk++)
+		{
+			//generateVertices runs in parallel inside each chunk
+			std::unique_ptr<HeightMapMesh> fullChunk(new HeightMapMesh(*m_imageData, m_n, m_m,
+				m_chunkRows[chunk], m_chunkRows[chunk + 1], 1));
+
+			//No OpenGL call as long as the chunk has not been initialized
+			//the normals of the rows shared with the adjacent chunks come from both sides
+			if(m_meshMode == INDEXED)
+			{
+				fullChunk->setIndex();
+				fullChunk->joinBorderNormals(*m_imageData);
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(m_builtChunksMutex);
+				m_builtChunks[chunk] = std::move(fullChunk);
+			}
+
+			//Notify the listeners that a chunk is ready to be uploaded
+			notifyChunkReadyListeners();
+		}
+
+		//The meshes first: the ambient occlusion only refines the lighting
+		if(!m_isCancelled)
+		{
+			Types::shared_matrix ambientOcclusion(std::make_shared<const Types::float_matrix>(
+				AmbientOcclusion::bake(*m_imageData, m_n, m_m, HeightMapMesh::getHeightScale(m_n, m_m))));
+
+			{
+				std::lock_guard<std::mutex> lock(m_builtChunksMutex);
+				m_ambientOcclusion = ambientOcclusion;
+			}
+
+			notifyChunkReadyListeners();
+		}
+	}
+	catch(std::exception const& e)
+	{
+		//The preview stays displayed
+		std::cerr << "ERROR : " << e.what() << std::endl;
+	}
+}
+
+//------------------------------------------------------------------------------
+void ChunkedHeightMap::notifyChunkReadyListeners()
+//------------------------------------------------------------------------------
+{
+	std::lock_guard<std::mutex> lock(m_listenersMutex);
+
+	for(auto const& listener : m_chunkReadyListeners)
+	{
+		listener.second();
+	}
+}
+
+//------------------------------------------------------------------------------
+bool ChunkedHeightMap::uploadReadyChunks()
+//------------------------------------------------------------------------------
+{
+	std::vector<unsigned int> readyChunks;
+
+	{
+		std::lock_guard<std::mutex> lock(m_builtChunksMutex);
+
+		for(unsigned int chunk(0); chunk < m_builtChunks.size(); chunk++)
+		{
+			if(m_builtChunks[chunk])
+			{
+				m_fullChunks[chunk] = std::move(m_builtChunks[chunk]);
+				readyChunks.push_back(chunk);
+			}
+		}
+	}
+
+	//Upload outside of the lock so that the background thread is not blocked
+	for(unsigned int chunk : readyChunks)
+	{
+		m_fullChunks[chunk]->initialize();
+		m_previewChunks[chunk].reset();
+		m_uploadedChunksCount++;
+	}
+
+	return !readyChunks.empty();
+}
+
+//------------------------------------------------------------------------------
+std::vector<Mesh*> ChunkedHeightMap::getMeshes() const
+//------------------------------------------------------------------------------
+{
+	std::vector<Mesh*> meshes;
+
+	if(m_heightTextureMesh)
+		meshes.push_back(m_heightTextureMesh.get());
+
+	for(unsigned int chunk(0); chunk < m_fullChunks.size(); chunk++)
+	{
+		if(m_fullChunks[chunk])
+			meshes.push_back(m_fullChunks[chunk].get());
+		else
+			meshes.push_back(m_previewChunks[chunk].get());
+	}
+
+	return meshes;
+}
+
+//------------------------------------------------------------------------------
+unsigned int ChunkedHeightMap::getUploadedChunksCount() const
+//------------------------------------------------------------------------------
+{
+	return m_uploadedChunksCount;
+}
+
+//------------------------------------------------------------------------------
+bool ChunkedHeightMap::isComplete() const
+//------------------------------------------------------------------------------
+{
+	return m_uploadedChunksCount == m_fullChunks.size();
+}
+
+//------------------------------------------------------------------------------
+Types::shared_matrix ChunkedHeightMap::getAmbientOcclusion() const
+//------------------------------------------------------------------------------
+{
+	std::lock_guard<std::mutex> lock(m_builtChunksMutex);
+	return m_ambientOcclusion;
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<const HeightFieldTracer> ChunkedHeightMap::getTracer() const
+//------------------------------------------------------------------------------
+{
+	std::lock_guard<std::mutex> lock(m_builtChunksMutex);
+	return m_tracer;
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<const LevelStatistics> ChunkedHeightMap::getLevelStatistics() const
+//------------------------------------------------------------------------------
+{
+	std::lock_guard<std::mutex> lock(m_builtChunksMutex);
+	return m_levelStatistics;
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<const ContourExtractor> ChunkedHeightMap::getContourExtractor() const
+//------------------------------------------------------------------------------
+{
+	std::lock_guard<std::mutex> lock(m_builtChunksMutex);
+	return m_contourExtractor;
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<const std::vector<unsigned char>> ChunkedHeightMap::getNormalMap() const
+//------------------------------------------------------------------------------
+{
+	std::lock_guard<std::mutex> lock(m_builtChunksMutex);
+	return m_normalMap;
+}
+
+//------------------------------------------------------------------------------
+float ChunkedHeightMap::getLength() const
+//------------------------------------------------------------------------------
+{
+	return m_length;
+}
+
+//------------------------------------------------------------------------------
+float ChunkedHeightMap::getWidth() const
+//------------------------------------------------------------------------------
+{
+	return m_width;
+}
+
+//------------------------------------------------------------------------------
+unsigned int ChunkedHeightMap::getN() const
+//------------------------------------------------------------------------------
+{
+	return m_n;
+}
+
+//------------------------------------------------------------------------------
+unsigned int ChunkedHeightMap::getM() const
+//------------------------------------------------------------------------------
+{
+	return m_m;
+}
+
+//------------------------------------------------------------------------------
+Types::shared_matrix const& ChunkedHeightMap::getImageData() const
+//------------------------------------------------------------------------------
+{
+	return m_imageData;
+}
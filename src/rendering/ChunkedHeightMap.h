@@ -0,0 +1,270 @@
+#ifndef CHUNKEDHEIGHTMAP_H
+#define CHUNKEDHEIGHTMAP_H
+
+/**
+*******************************************************************************
+*
+*  @file       ChunkedHeightMap.h
+*
+*  @brief      Class to handle a height map split into chunks of rows.
+* A decimated preview of each chunk is available immediately
+* while the full resolution chunks are created in a background thread.
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <map>
+
+#include "tools/Types.h"
+#include "HeightMapMesh.h"
+#include "HeightTextureMesh.h"
+#include "terrainAnalysis/HeightFieldTracer.h"
+#include "terrainAnalysis/LevelStatistics.h"
+#include "terrainAnalysis/ContourExtractor.h"
+
+//==============================================================================
+/**
+*  @class  ChunkedHeightMap
+*  @brief  ChunkedHeightMap is a class to handle a height map split into chunks of rows.
+* A decimated preview of each chunk is available immediately
+* while the full resolution chunks are created in a background thread.
+* With the height texture, the whole height map is a single mesh generated
+* by the shaders and only the analysis is built in the background.
+*/
+//==============================================================================
+class ChunkedHeightMap
+{
+public:
+	/**
+	 * @brief The MeshMode enum how the vertices of the full resolution height map are given to OpenGL
+	 */
+	enum MeshMode
+	{
+		INDEXED, //one normal per vertex and an index per chunk
+		NON_INDEXED, //one normal per face, six vertices per cell
+		HEIGHT_TEXTURE //no vertex buffer, the vertices are generated from a texture of the heights
+	};
+
+	/**
+	 * @brief ChunkedHeightMap Overloaded constructor with the name of the file.
+	 * The file has to contain the width, the height and then the data in the [0,1] range
+	 * @param fileName the name of the height map file
+	 * @param meshMode how the vertices are given to OpenGL
+	 */
+	ChunkedHeightMap(std::string const& fileName, MeshMode meshMode);
+
+	/**
+	 * @brief ChunkedHeightMap Overloaded constructor with the image size and data.
+	 * Create the preview chunks.
+	 * @param imageData the data of the image as floats in the [0,1] range, shared without copy
+	 * @param n height of the image
+	 * @param m width of the image
+	 * @param meshMode how the vertices are given to OpenGL
+	 */
+	ChunkedHeightMap(Types::shared_matrix const& imageData,
+					 unsigned int n, unsigned int m, MeshMode meshMode);
+
+	/**
+	 * @brief ~ChunkedHeightMap stop the background creation.
+	 * An OpenGL context of the share group has to be current.
+	 */
+	~ChunkedHeightMap();
+
+	/**
+	 * @brief buildInBackground launch the creation of the full resolution chunks
+	 * if it has not been launched yet
+	 */
+	void buildInBackground();
+
+	/**
+	 * @brief addChunkReadyListener register a function to call each time a chunk, the normal map
+	 * or the ambient occlusion is ready
+	 * @param listener identify the listener to remove it later
+	 * @param chunkReadyCallback called from the background thread
+	 */
+	void addChunkReadyListener(const void *listener, std::function<void()> const& chunkReadyCallback);
+
+	/**
+	 * @brief removeChunkReadyListener stop calling the function of a listener.
+	 * Once it returns, the function is not being called anymore
+	 * @param listener the listener given to addChunkReadyListener
+	 */
+	void removeChunkReadyListener(const void *listener);
+
+	/**
+	 * @brief uploadReadyChunks Initialize the VBO of the full resolution chunks
+	 * that are ready and release the corresponding previews.
+	 * An OpenGL context of the share group has to be current.
+	 * @return true if at least one chunk has been replaced
+	 */
+	bool uploadReadyChunks();
+
+	/**
+	 * @brief getUploadedChunksCount
+	 * @return the number of full resolution chunks that have been uploaded,
+	 * changes each time the meshes to render change
+	 */
+	unsigned int getUploadedChunksCount() const;
+
+	/**
+	 * @brief getMeshes get the meshes to render, the full resolution chunk
+	 * when it has been uploaded, its preview otherwise
+	 * @return the meshes to render
+	 */
+	std::vector<Mesh*> getMeshes() const;
+
+	/**
+	 * @brief isComplete
+	 * @return true if all the full resolution chunks have been uploaded,
+	 * always true with the height texture
+	 */
+	bool isComplete() const;
+
+	/**
+	 * @brief getAmbientOcclusion get the ambient occlusion baked in the background
+	 * once the full resolution chunks are built
+	 * @return the fraction of the sky seen by each pixel, null if it is not ready yet
+	 */
+	Types::shared_matrix getAmbientOcclusion() const;
+
+	/**
+	 * @brief getTracer get the ray tracer of the height map, built in the background
+	 * before the full resolution chunks, to pick the pixels or test the lines of sight
+	 * @return the tracer, null if it is not ready yet
+	 */
+	std::shared_ptr<const HeightFieldTracer> getTracer() const;
+
+	/**
+	 * @brief getLevelStatistics get the sorted heights, built in the background
+	 * after the tracer, to know the area and the volume above the lvl plan
+	 * @return the statistics, null if they are not ready yet
+	 */
+	std::shared_ptr<const LevelStatistics> getLevelStatistics() const;
+
+	/**
+	 * @brief getContourExtractor get the sorted cells of the height map, built in the background
+	 * after the level statistics, to extract the isolines at the height of the lvl plan
+	 * @return the extractor, null if it is not ready yet
+	 */
+	std::shared_ptr<const ContourExtractor> getContourExtractor() const;
+
+	/**
+	 * @brief getNormalMap get the normal vectors of the full resolution height map,
+	 * baked in the background before the full resolution chunks so that the previews use them
+	 * @return two bytes per pixel as computed by NormalMap, null if they are not ready yet
+	 */
+	std::shared_ptr<const std::vector<unsigned char>> getNormalMap() const;
+
+	/**
+	 * @brief getLength Calculate the length of the heightmap's mesh
+	 * @return the length of the heightmap's mesh
+	 */
+	float getLength() const;
+
+	/**
+	 * @brief getWidth Calculate the width of the heightmap's mesh
+	 * @return the width of the heightmap's mesh
+	 */
+	float getWidth() const;
+
+	//Getters
+	unsigned int getN() const;
+	unsigned int getM() const;
+	Types::shared_matrix const& getImageData() const;
+
+//******************************************************************************
+private:
+	//No default constructor
+	ChunkedHeightMap();
+
+	//No copy constructor
+	ChunkedHeightMap(ChunkedHeightMap const&);
+
+	/**
+	 * @brief createPreview Split the rows into chunks and create their decimated preview,
+	 * or create the mesh of the height texture
+	 */
+	void createPreview();
+
+	/**
+	 * @brief buildFullChunks Build the tracer, the level statistics, the contour extractor
+	 * and the normal map,
+	 * create the full resolution chunks one after another,
+	 * then bake the ambient occlusion. Run in the background thread
+	 */
+	void buildFullChunks();
+
+	/**
+	 * @brief notifyChunkReadyListeners call the functions of the listeners
+	 */
+	void notifyChunkReadyListeners();
+
+	//data of the image, shared with the background thread
+	Types::shared_matrix m_imageData;
+
+	unsigned int m_n, //number of rows
+		m_m; //number of columns
+
+	float m_length, //length of the mesh
+		m_width; //width of the mesh
+
+	//first row of each chunk, the last row of a chunk is the first of the next one
+	Types::uint_line m_chunkRows;
+
+	//the whole height map with the height texture, null otherwise
+	std::unique_ptr<HeightTextureMesh> m_heightTextureMesh;
+
+	std::vector<std::unique_ptr<HeightMapMesh>> m_previewChunks, //decimated chunks
+		m_fullChunks, //full resolution chunks that have been uploaded
+		m_builtChunks; //full resolution chunks created by the background thread, not uploaded yet
+
+	//ambient occlusion of the pixels, baked once for all the windows sharing the height map
+	Types::shared_matrix m_ambientOcclusion;
+
+	//ray queries on the height map, with its min/max pyramid
+	std::shared_ptr<const HeightFieldTracer> m_tracer;
+
+	//area and volume above a level
+	std::shared_ptr<const LevelStatistics> m_levelStatistics;
+
+	//cells of the height map sorted by the heights they span
+	std::shared_ptr<const ContourExtractor> m_contourExtractor;
+
+	//normal vectors of the pixels, packed in two bytes
+	std::shared_ptr<const std::vector<unsigned char>> m_normalMap;
+
+	//protect m_builtChunks, m_ambientOcclusion, m_tracer, m_levelStatistics,
+	//m_contourExtractor and m_normalMap
+	mutable std::mutex m_builtChunksMutex;
+
+	//functions to call each time a chunk is ready
+	std::map<const void*, std::function<void()>> m_chunkReadyListeners;
+
+	//protect m_chunkReadyListeners
+	std::mutex m_listenersMutex;
+
+	//thread creating the full resolution chunks
+	std::thread m_buildingThread;
+
+	//set to stop the creation of the full resolution chunks
+	std::atomic<bool> m_isCancelled;
+
+	//number of full resolution chunks that have been uploaded
+	unsigned int m_uploadedChunksCount;
+
+	//how the vertices are given to OpenGL
+	MeshMode m_meshMode;
+};
+
+#endif // CHUNKEDHEIGHTMAP_H
@@ -0,0 +1,81 @@
+/**
+*******************************************************************************
+*
+*  @file       ColourRamp.cpp
+*
+*  @brief      Class to give a colour to each height of the terrain,
+*				sampled in a texture by the display shader
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <algorithm>
+
+#include "ColourRamp.h"
+
+//******************************************************************************
+//  constant variables
+//******************************************************************************
+///@cond
+/**
+ * @brief The ColourStop struct the colour of a palette at a value
+ */
+struct ColourStop
+{
+	float value;
+	float red, green, blue;
+};
+///@endcond
+
+//the stops of each palette, from 0 to 1. RED_BLUE is the former colour of the vertices, (h, 0, 1 - h)
+const std::vector<ColourStop> PALETTES[ColourRamp::PALETTE_COUNT] =
+{
+	{{0.f, 0.f, 0.f, 1.f}, {1.f, 1.f, 0.f, 0.f}},
+	{{0.f, 0.1f, 0.2f, 0.6f}, {0.25f, 0.2f, 0.6f, 0.2f}, {0.6f, 0.55f, 0.45f, 0.3f},
+	 {0.85f, 0.6f, 0.6f, 0.6f}, {1.f, 1.f, 1.f, 1.f}},
+	{{0.f, 0.1f, 0.1f, 0.1f}, {1.f, 1.f, 1.f, 1.f}}
+};
+
+//------------------------------------------------------------------------------
+QVector3D ColourRamp::getColour(Palette palette, float value)
+//------------------------------------------------------------------------------
+{
+	std::vector<ColourStop> const& stops(PALETTES[palette]);
+	float clamped(std::min(std::max(value, 0.f), 1.f));
+
+	//the first stop above the value, the last one for 1
+	unsigned int upper(1);
+
+	while(upper < stops.size() - 1 && stops[upper].value < clamped)
+		upper++;
+
+	ColourStop const& low(stops[upper - 1]);
+	ColourStop const& high(stops[upper]);
+	float weight((clamped - low.value) / (high.value - low.value));
+
+	return QVector3D(low.red + weight * (high.red - low.red),
+					 low.green + weight * (high.green - low.green),
+					 low.blue + weight * (high.blue - low.blue));
+}
+
+//------------------------------------------------------------------------------
+std::vector<unsigned char> ColourRamp::createTexels(Palette palette, unsigned int texelCount)
+//------------------------------------------------------------------------------
+{
+	std::vector<unsigned char> texels(size_t(texelCount) * 3);
+
+	for(unsigned int texel(0); texel < texelCount; texel++)
+	{
+		QVector3D colour(getColour(palette, texelCount > 1 ? float(texel) / float(texelCount - 1) : 0.f));
+
+		texels[3 * texel] = (unsigned char)(colour.x() * 255.f + 0.5f);
+		texels[3 * texel + 1] = (unsigned char)(colour.y() * 255.f + 0.5f);
+		texels[3 * texel + 2] = (unsigned char)(colour.z() * 255.f + 0.5f);
+	}
+
+	return texels;
+}
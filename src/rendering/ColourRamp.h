@@ -0,0 +1,68 @@
+#ifndef COLOURRAMP_H
+#define COLOURRAMP_H
+
+/**
+*******************************************************************************
+*
+*  @file       ColourRamp.h
+*
+*  @brief      Class to give a colour to each height of the terrain,
+*				sampled in a texture by the display shader
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <vector>
+#include <QVector3D>
+
+//==============================================================================
+/**
+*  @class  ColourRamp
+*  @brief  ColourRamp is a class to map the values of the pixels to colours.
+*			A palette is a few colours at increasing values, linearly
+*			interpolated between them. The display shader reads the colour of
+*			each fragment in a ramp texture from its height, so the meshes
+*			carry no colour and the palette changes without rebuilding them
+*/
+//==============================================================================
+class ColourRamp
+{
+public:
+	/**
+	 * @brief The Palette enum the colours available
+	 */
+	enum Palette
+	{
+		RED_BLUE, //blue at the bottom, red at the top
+		TERRAIN, //water, grass, rock and snow
+		GREYSCALE, //dark at the bottom, white at the top
+		PALETTE_COUNT
+	};
+
+	/**
+	 * @brief getColour
+	 * @param palette the palette to sample
+	 * @param value the value of a pixel, clamped to the [0,1] range
+	 * @return the colour of this value, each component in the [0,1] range
+	 */
+	static QVector3D getColour(Palette palette, float value);
+
+	/**
+	 * @brief createTexels sample a palette for a ramp texture
+	 * @param palette the palette to sample
+	 * @param texelCount number of texels, the first one for the value 0 and the last one for 1
+	 * @return 3 bytes per texel, red, green and blue
+	 */
+	static std::vector<unsigned char> createTexels(Palette palette, unsigned int texelCount);
+
+//******************************************************************************
+private:
+	//No instance
+	ColourRamp();
+};
+
+#endif // COLOURRAMP_H
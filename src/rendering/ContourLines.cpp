@@ -0,0 +1,100 @@
+/**
+*******************************************************************************
+*
+*  @file       ContourLines.cpp
+*
+*  @brief      Class to handle the isolines of the height map at the height
+*				of the lvl plan
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include "ContourLines.h"
+#include "HeightMapMesh.h"
+
+//******************************************************************************
+//  constant variables
+//******************************************************************************
+//Lift of the lines above the terrain, so that they are not hidden by the triangles they lie on
+const float CONTOUR_OFFSET = 0.05f;
+
+//------------------------------------------------------------------------------
+ContourLines::ContourLines(unsigned int n, unsigned int m):
+//------------------------------------------------------------------------------
+	m_extractor(),
+	m_step(HeightMapMesh::getStep(n, m)),
+	m_heightFactor(HeightMapMesh::getHeightScale(n, m) * m_step),
+	m_height(0.f),
+	m_hasLines(false),
+	m_isVBOOutdated(false)
+//------------------------------------------------------------------------------
+{
+	m_primitive = GL_LINES;
+
+	//the lines change with each step of the lvl plan
+	m_usage = GL_DYNAMIC_DRAW;
+}
+
+//------------------------------------------------------------------------------
+void ContourLines::setExtractor(std::shared_ptr<const ContourExtractor> const& extractor)
+//------------------------------------------------------------------------------
+{
+	m_extractor = extractor;
+	m_hasLines = false;
+}
+
+//------------------------------------------------------------------------------
+bool ContourLines::hasExtractor() const
+//------------------------------------------------------------------------------
+{
+	return bool(m_extractor);
+}
+
+//------------------------------------------------------------------------------
+void ContourLines::setHeight(float height)
+//------------------------------------------------------------------------------
+{
+	if(!m_extractor || (m_hasLines && height == m_height))
+		return;
+
+	m_height = height;
+	Types::vertices_data lines(m_extractor->extract(height / m_heightFactor));
+
+	//The buffer only grows: the lines are written at its beginning
+	//and only them are uploaded, the vertices after them are not drawn
+	if(lines.size() > m_verticesPosition.size())
+		m_verticesPosition.resize(lines.size());
+
+	//from the grid to the space of the mesh
+	for(unsigned int vertex(0); vertex < lines.size(); vertex++)
+	{
+		m_verticesPosition[vertex] = QVector3D(lines[vertex].x() * m_step, lines[vertex].y() * m_step,
+											   height + CONTOUR_OFFSET);
+	}
+
+	m_verticesCount = (unsigned int)(lines.size());
+	markDirty(0, m_verticesCount);
+
+	m_hasLines = true;
+
+	//nothing to upload without line
+	m_isVBOOutdated = (m_verticesCount > 0);
+
+	reportMemory();
+}
+
+//------------------------------------------------------------------------------
+void ContourLines::render()
+//------------------------------------------------------------------------------
+{
+	if(m_isInitialized && m_isVBOOutdated)
+		updateVBO();
+
+	m_isVBOOutdated = false;
+
+	Mesh::render();
+}
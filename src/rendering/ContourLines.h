@@ -0,0 +1,87 @@
+#ifndef CONTOURLINES_H
+#define CONTOURLINES_H
+
+/**
+*******************************************************************************
+*
+*  @file       ContourLines.h
+*
+*  @brief      Class to handle the isolines of the height map at the height
+*				of the lvl plan
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <memory>
+
+#include "Mesh.h"
+#include "terrainAnalysis/ContourExtractor.h"
+
+//==============================================================================
+/**
+*  @class  ContourLines
+*  @brief  ContourLines is a class to handle a mesh of lines where the lvl plan
+*			cuts the height map. Only the positions are sent to the VBO, which
+*			keeps the size of the most vertices extracted so far: the lines
+*			of each height are uploaded to its beginning, without new data store.
+*			The cells are sorted once in the background by ChunkedHeightMap,
+*			no line is extracted before they are.
+*/
+//==============================================================================
+class ContourLines: public Mesh
+{
+public:
+	/**
+	 * @brief ContourLines constructor, nothing is extracted before setExtractor() and setHeight()
+	 * @param n number of rows
+	 * @param m number of columns
+	 */
+	ContourLines(unsigned int n, unsigned int m);
+
+	/**
+	 * @brief setExtractor give the sorted cells of the height map,
+	 * the lines are extracted by the next setHeight()
+	 * @param extractor the extractor of the height map, of n rows and m columns
+	 */
+	void setExtractor(std::shared_ptr<const ContourExtractor> const& extractor);
+
+	/**
+	 * @brief hasExtractor
+	 * @return true if setExtractor() has been called
+	 */
+	bool hasExtractor() const;
+
+	/**
+	 * @brief setHeight extract the isolines at a height, do nothing without extractor.
+	 * The VBO is updated by the next render(), no OpenGL context is needed
+	 * @param height the height in the space of the mesh, as the one of LvlPlan
+	 */
+	void setHeight(float height);
+
+	/**
+	 * @brief render update the VBO if the lines changed and render them.
+	 * An OpenGL shader program need to be bound before calling this function.
+	 */
+	void render();
+
+//******************************************************************************
+private:
+	//No default constructor
+	ContourLines();
+
+	//built in the background, shared with the other renderers
+	std::shared_ptr<const ContourExtractor> m_extractor;
+
+	float m_step, //distance between two vertices of the mesh
+		m_heightFactor, //height of a pixel of value 1 in the mesh
+		m_height; //height of the lines extracted
+
+	bool m_hasLines, //to know if the lines at m_height have been extracted
+		m_isVBOOutdated; //to know if the lines changed since the last upload
+};
+
+#endif // CONTOURLINES_H
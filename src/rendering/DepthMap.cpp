@@ -15,6 +15,7 @@
 #include <iostream>
 #include <fstream>
 #include <QOpenGLFunctions>
+#include <QOpenGLContext>
 
 #include "DepthMap.h"
 
@@ -29,8 +30,7 @@ DepthMap::DepthMap() :
 //------------------------------------------------------------------------
 	m_isInitialized(false),
 	m_matrixID(0),
-	m_mapFrameBuffer(0),
-	m_mapTexture(0)
+	m_mapFrameBuffer(0)
 //------------------------------------------------------------------------
 {
 }
@@ -39,8 +39,53 @@ DepthMap::DepthMap() :
 DepthMap::~DepthMap()
 //------------------------------------------------------------------------
 {
-	glDeleteFramebuffers(1, &m_mapFrameBuffer);
-	glDeleteTextures(1, &m_mapTexture);
+	if(m_isInitialized)
+	{
+		glDeleteFramebuffers(1, &m_mapFrameBuffer);
+	}
+}
+
+//------------------------------------------------------------------------
+std::shared_ptr<DepthTexture> DepthMap::getSharedTexture()
+//------------------------------------------------------------------------
+{
+	//Only the GUI thread creates depth maps
+	static std::weak_ptr<DepthTexture> sharedTexture;
+
+	std::shared_ptr<DepthTexture> texture(sharedTexture.lock());
+
+	if(!texture)
+	{
+		//Delete the texture with the context current when the last depth map is destroyed.
+		//Without current context, the share group and its textures are already destroyed
+		texture.reset(new DepthTexture(),
+			[](DepthTexture *depthTexture)
+			{
+				QOpenGLContext *context(QOpenGLContext::currentContext());
+
+				if(context)
+					context->functions()->glDeleteTextures(1, &depthTexture->m_texture);
+
+				delete depthTexture;
+			});
+
+		//Intialize the buffer for the depth map texture and enable
+		//sampling in the fragment shader as a sampler2DShadow
+		glGenTextures(1, &texture->m_texture);
+		glBindTexture(GL_TEXTURE_2D, texture->m_texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT16,
+					 MAP_SIZE, MAP_SIZE, 0, GL_DEPTH_COMPONENT, GL_FLOAT, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_R_TO_TEXTURE);
+
+		sharedTexture = texture;
+	}
+
+	return texture;
 }
 
 //------------------------------------------------------------------------
@@ -49,18 +94,7 @@ void DepthMap::initialize()
 {
 	initializeOpenGLFunctions();
 
-	//Intialize the buffer for the depth map texture and enable
-	//sampling in the fragment shader as a sampler2DShadow
-	glGenTextures(1, &m_mapTexture);
-	glBindTexture(GL_TEXTURE_2D, m_mapTexture);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT16,
-				 MAP_SIZE, MAP_SIZE, 0, GL_DEPTH_COMPONENT, GL_FLOAT, 0);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_R_TO_TEXTURE);
+	m_mapTexture = getSharedTexture();
 
 	//initalize the frame buffer for the shadow map
 	glGenFramebuffers(1, &m_mapFrameBuffer);
@@ -68,7 +102,7 @@ void DepthMap::initialize()
 
 	//link the frame buffer and the texture buffer
 		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D,
-						   m_mapTexture, 0);
+						   m_mapTexture->m_texture, 0);
 
 	//check the creation of the buffer
 	if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
@@ -84,8 +118,8 @@ void DepthMap::initialize()
 }
 
 //------------------------------------------------------------------------
-void DepthMap::render(Mesh &mesh, QMatrix4x4 const& matrix,
-					  std::unique_ptr<QOpenGLShaderProgram> const& program)
+void DepthMap::render(std::vector<Mesh*> const& meshes, QMatrix4x4 const& matrix,
+					  std::shared_ptr<QOpenGLShaderProgram> const& program)
 //------------------------------------------------------------------------
 {
 	//Initialize if necessary
@@ -109,14 +143,28 @@ void DepthMap::render(Mesh &mesh, QMatrix4x4 const& matrix,
 	//send the matrix to the program
 	program->setUniformValue(m_matrixID, matrix);
 
-	mesh.render();
+	for(Mesh *mesh : meshes)
+	{
+		mesh->render();
+	}
 
 	program->release();
+
+	//The shared texture now contains this rendering
+	m_mapTexture->m_matrix = matrix;
+	m_mapTexture->m_meshes = meshes;
 }
 
 //------------------------------------------------------------------------
 GLuint DepthMap::getMapTexture() const
 //------------------------------------------------------------------------
 {
-	return m_mapTexture;
+	return m_mapTexture ? m_mapTexture->m_texture : 0;
+}
+
+//------------------------------------------------------------------------
+bool DepthMap::contains(std::vector<Mesh*> const& meshes, QMatrix4x4 const& matrix) const
+//------------------------------------------------------------------------
+{
+	return m_mapTexture && m_mapTexture->m_matrix == matrix && m_mapTexture->m_meshes == meshes;
 }
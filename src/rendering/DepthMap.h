@@ -23,6 +23,20 @@
 
 #include "Mesh.h"
 
+///@cond
+/**
+ * @brief The DepthTexture class store the ID of a depth texture shared by all the depth maps
+ * and what it currently contains: the matrix and the meshes of the last rendering
+ */
+class DepthTexture
+{
+public:
+	GLuint m_texture;
+	QMatrix4x4 m_matrix;
+	std::vector<Mesh*> m_meshes;
+};
+///@endcond
+
 //==============================================================================
 /**
 *  @class  DepthMap
@@ -37,19 +51,20 @@ public:
 	~DepthMap();
 
 	/**
-	 * @brief initialize Initialize the buffers
+	 * @brief initialize Initialize the frame buffer.
+	 * The texture is shared by all the depth maps of the share group to save VRAM
 	 */
 	void initialize();
 
 	/**
 	 * @brief render render to the frame buffer,
 	 * call initialize() if it has never been called before
-	 * @param mesh the mesh to be rendered
+	 * @param meshes the meshes to be rendered
 	 * @param matrix the projection matrix
 	 * @param program the OpenGL shader program to create the depth map
 	 */
-	void render(Mesh &mesh, QMatrix4x4 const& matrix,
-				std::unique_ptr<QOpenGLShaderProgram> const& program);
+	void render(std::vector<Mesh*> const& meshes, QMatrix4x4 const& matrix,
+				std::shared_ptr<QOpenGLShaderProgram> const& program);
 
 	/**
 	 * @brief getMapTexture
@@ -57,20 +72,38 @@ public:
 	 */
 	GLuint getMapTexture() const;
 
+	/**
+	 * @brief contains check that the shared texture already contains a rendering,
+	 * by this depth map or by another one of the share group
+	 * @param meshes the meshes to be rendered
+	 * @param matrix the projection matrix
+	 * @return false if render() needs to be called again
+	 */
+	bool contains(std::vector<Mesh*> const& meshes, QMatrix4x4 const& matrix) const;
+
 //******************************************************************************
 private:
 	//No copy constructor
 	DepthMap(DepthMap const&);
 
+	/**
+	 * @brief getSharedTexture get the depth texture shared by all the depth maps,
+	 * create it if no depth map uses it
+	 * @return the shared texture
+	 */
+	std::shared_ptr<DepthTexture> getSharedTexture();
+
 	//to know if initialize() has been called
 	bool m_isInitialized;
 
 	//ID of the MVP matrix for inputs in the shader program
 	GLuint m_matrixID;
 
-	//To create a buffer for the depth map
-	GLuint	m_mapFrameBuffer,
-		m_mapTexture;
+	//To create a buffer for the depth map, frame buffers cannot be shared between contexts
+	GLuint	m_mapFrameBuffer;
+
+	//the texture of the depth map, shared with the other depth maps
+	std::shared_ptr<DepthTexture> m_mapTexture;
 
 };
 
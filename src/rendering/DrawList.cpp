@@ -0,0 +1,126 @@
+/**
+*******************************************************************************
+*
+*  @file       DrawList.cpp
+*
+*  @brief      Class to collect the draws of a frame and submit them
+*				grouped by state and by program
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <algorithm>
+
+#include "DrawList.h"
+#include "tools/Instrumentation.h"
+
+//------------------------------------------------------------------------------
+DrawList::DrawList():
+//------------------------------------------------------------------------------
+	m_draws(),
+	m_programs(),
+	m_isInitialized(false)
+//------------------------------------------------------------------------------
+{
+}
+
+//------------------------------------------------------------------------------
+void DrawList::setUniforms(QOpenGLShaderProgram *program,
+						   std::function<void(QOpenGLShaderProgram &)> const& setUniforms)
+//------------------------------------------------------------------------------
+{
+	for(auto &entry : m_programs)
+	{
+		if(entry.first == program)
+		{
+			entry.second = setUniforms;
+			return;
+		}
+	}
+
+	m_programs.push_back(std::make_pair(program, setUniforms));
+}
+
+//------------------------------------------------------------------------------
+void DrawList::add(QOpenGLShaderProgram *program, Mesh *mesh, Blending blending)
+//------------------------------------------------------------------------------
+{
+	//a few programs per frame, a linear search is enough
+	unsigned int index(0);
+
+	while(index < m_programs.size() && m_programs[index].first != program)
+		index++;
+
+	if(index == m_programs.size())
+		m_programs.push_back(std::make_pair(program, std::function<void(QOpenGLShaderProgram &)>()));
+
+	m_draws.push_back({blending, index, mesh});
+}
+
+//------------------------------------------------------------------------------
+void DrawList::submit()
+//------------------------------------------------------------------------------
+{
+	ScopedTimer timer("DrawList::submit");
+
+	if(!m_isInitialized)
+	{
+		initializeOpenGLFunctions();
+		m_isInitialized = true;
+	}
+
+	//the draws of a program keep their order, the chunks are rendered as listed
+	std::stable_sort(m_draws.begin(), m_draws.end(), [](Draw const& left, Draw const& right)
+		{
+			return left.blending != right.blending ? left.blending < right.blending :
+													 left.program < right.program;
+		});
+
+	Blending blending(OPAQUE_DRAW);
+	QOpenGLShaderProgram *program(nullptr);
+	unsigned int programIndex(0);
+
+	for(Draw const& draw : m_draws)
+	{
+		if(draw.blending != blending)
+		{
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			glEnable(GL_BLEND);
+			blending = draw.blending;
+		}
+
+		if(!program || draw.program != programIndex)
+		{
+			if(program)
+				program->release();
+
+			programIndex = draw.program;
+			program = m_programs[programIndex].first;
+			program->bind();
+
+			if(m_programs[programIndex].second)
+				m_programs[programIndex].second(*program);
+		}
+
+		draw.mesh->render();
+	}
+
+	if(program)
+		program->release();
+
+	if(blending == BLENDED_DRAW)
+		glDisable(GL_BLEND);
+
+	m_draws.clear();
+}
+
+//------------------------------------------------------------------------------
+unsigned int DrawList::getDrawCount() const
+//------------------------------------------------------------------------------
+{
+	return (unsigned int)(m_draws.size());
+}
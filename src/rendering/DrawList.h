@@ -0,0 +1,104 @@
+#ifndef DRAWLIST_H
+#define DRAWLIST_H
+
+/**
+*******************************************************************************
+*
+*  @file       DrawList.h
+*
+*  @brief      Class to collect the draws of a frame and submit them
+*				grouped by state and by program
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <QtGui/QOpenGLFunctions>
+#include <QtGui/QOpenGLShaderProgram>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "Mesh.h"
+
+//==============================================================================
+/**
+*  @class  DrawList
+*  @brief  DrawList is a class to collect the meshes to render in a frame
+*			with their program, then to render them with as few changes of state
+*			as possible: the opaque draws before the blended ones, and the draws
+*			of a program together, in the order the programs were first used.
+*			Each program is bound and given its uniforms once per submit().
+*/
+//==============================================================================
+class DrawList: protected QOpenGLFunctions
+{
+public:
+	/**
+	 * @brief The Blending enum the state of a draw
+	 */
+	enum Blending
+	{
+		OPAQUE_DRAW, //depth tested and written, drawn first
+		BLENDED_DRAW //blended over the opaque draws with its alpha
+	};
+
+	DrawList();
+
+	/**
+	 * @brief setUniforms set the function giving its uniforms and textures to a program
+	 * @param program the program
+	 * @param setUniforms called with the program bound, before its first draw of each submit()
+	 */
+	void setUniforms(QOpenGLShaderProgram *program,
+					 std::function<void(QOpenGLShaderProgram &)> const& setUniforms);
+
+	/**
+	 * @brief add add a draw to the list
+	 * @param program the program to render the mesh with, linked
+	 * @param mesh the mesh, alive until submit()
+	 * @param blending the state of the draw
+	 */
+	void add(QOpenGLShaderProgram *program, Mesh *mesh, Blending blending = OPAQUE_DRAW);
+
+	/**
+	 * @brief submit render the draws in the current OpenGL context and clear the list
+	 */
+	void submit();
+
+	/**
+	 * @brief getDrawCount
+	 * @return the number of draws added since the last submit()
+	 */
+	unsigned int getDrawCount() const;
+
+//******************************************************************************
+private:
+	//No copy constructor
+	DrawList(DrawList const&);
+
+	///@cond
+	/**
+	 * @brief The Draw struct a mesh to render and its state
+	 */
+	struct Draw
+	{
+		Blending blending;
+		unsigned int program; //index in m_programs
+		Mesh *mesh;
+	};
+	///@endcond
+
+	//draws added since the last submit
+	std::vector<Draw> m_draws;
+
+	//programs in the order of their first use, with the function giving their uniforms
+	std::vector<std::pair<QOpenGLShaderProgram*, std::function<void(QOpenGLShaderProgram &)>>> m_programs;
+
+	bool m_isInitialized; //to know if the OpenGL functions have been initialized
+};
+
+#endif // DRAWLIST_H
@@ -0,0 +1,81 @@
+/**
+*******************************************************************************
+*
+*  @file       GLResourceCache.cpp
+*
+*  @brief      Class to share shader programs and height map meshes
+* between the render windows.
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//	Include
+//******************************************************************************
+#include "GLResourceCache.h"
+
+//******************************************************************************
+//  constant variables
+//******************************************************************************
+//the folder where the shaders are stored
+const std::string SHADER_FOLDER = ":/shader/";
+
+//******************************************************************************
+//  static variables
+//******************************************************************************
+std::map<std::string, std::weak_ptr<QOpenGLShaderProgram>> GLResourceCache::s_programs;
+
+std::map<std::pair<const Types::float_matrix*, ChunkedHeightMap::MeshMode>, std::weak_ptr<ChunkedHeightMap>>
+	GLResourceCache::s_heightMaps;
+
+//------------------------------------------------------------------------------
+std::shared_ptr<QOpenGLShaderProgram> GLResourceCache::getProgram(std::string const& shaderName)
+//------------------------------------------------------------------------------
+{
+	std::shared_ptr<QOpenGLShaderProgram> program(s_programs[shaderName].lock());
+
+	if(!program)
+	{
+		//Not owned by a window, the last one using it deletes it
+		program = std::make_shared<QOpenGLShaderProgram>();
+		program->addShaderFromSourceFile(QOpenGLShader::Vertex,
+			(SHADER_FOLDER + shaderName + ".vert").c_str());
+		program->addShaderFromSourceFile(QOpenGLShader::Fragment,
+			(SHADER_FOLDER + shaderName + ".frag").c_str());
+		program->link();
+
+		s_programs[shaderName] = program;
+	}
+
+	return program;
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<ChunkedHeightMap> GLResourceCache::getHeightMap(
+		Types::shared_matrix const& imageData, unsigned int n, unsigned int m, ChunkedHeightMap::MeshMode meshMode)
+//------------------------------------------------------------------------------
+{
+	//The height map keeps the data alive, so the address cannot be reused while it is cached
+	std::weak_ptr<ChunkedHeightMap> &cachedHeightMap(
+		s_heightMaps[std::make_pair(imageData.get(), meshMode)]);
+
+	std::shared_ptr<ChunkedHeightMap> heightMap(cachedHeightMap.lock());
+
+	if(!heightMap)
+	{
+		heightMap = std::make_shared<ChunkedHeightMap>(imageData, n, m, meshMode);
+		cachedHeightMap = heightMap;
+
+		//Forget the height maps that have been released
+		for(auto ite(s_heightMaps.begin()); ite != s_heightMaps.end();)
+		{
+			if(ite->second.expired())
+				ite = s_heightMaps.erase(ite);
+			else
+				++ite;
+		}
+	}
+
+	return heightMap;
+}
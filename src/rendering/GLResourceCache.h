@@ -0,0 +1,74 @@
+#ifndef GLRESOURCECACHE_H
+#define GLRESOURCECACHE_H
+
+/**
+*******************************************************************************
+*
+*  @file       GLResourceCache.h
+*
+*  @brief      Class to share shader programs and height map meshes
+* between the render windows. The windows have to be in the same
+* OpenGL share group (Qt::AA_ShareOpenGLContexts).
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <QtGui/QOpenGLShaderProgram>
+#include <string>
+#include <map>
+#include <memory>
+#include <utility>
+
+#include "tools/Types.h"
+#include "ChunkedHeightMap.h"
+
+//==============================================================================
+/**
+*  @class  GLResourceCache
+*  @brief  GLResourceCache is a class to share shader programs and height map meshes
+* between the render windows.
+* Resources are only referenced weakly: they are released with the last window using them.
+* Must only be used from the GUI thread.
+*/
+//==============================================================================
+class GLResourceCache
+{
+public:
+	/**
+	 * @brief getProgram get a linked shader program, compile it if no window uses it.
+	 * An OpenGL context of the share group has to be current.
+	 * @param shaderName name of the shaders in the resources, without extension
+	 * @return the shader program, check isLinked() before using it
+	 */
+	static std::shared_ptr<QOpenGLShaderProgram> getProgram(std::string const& shaderName);
+
+	/**
+	 * @brief getHeightMap get the height map created from some data, create it if no window uses it.
+	 * The shared data identifies both the image and the processing stage.
+	 * @param imageData the data of the image as floats in the [0,1] range
+	 * @param n height of the image
+	 * @param m width of the image
+	 * @param meshMode how the vertices are given to OpenGL
+	 * @return the height map
+	 */
+	static std::shared_ptr<ChunkedHeightMap> getHeightMap(Types::shared_matrix const& imageData,
+		unsigned int n, unsigned int m, ChunkedHeightMap::MeshMode meshMode);
+
+//******************************************************************************
+private:
+	//No instance
+	GLResourceCache();
+
+	//Shader programs, by name
+	static std::map<std::string, std::weak_ptr<QOpenGLShaderProgram>> s_programs;
+
+	//Height maps, by image data and mesh mode
+	static std::map<std::pair<const Types::float_matrix*, ChunkedHeightMap::MeshMode>,
+		std::weak_ptr<ChunkedHeightMap>> s_heightMaps;
+};
+
+#endif // GLRESOURCECACHE_H
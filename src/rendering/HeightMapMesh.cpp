@@ -19,6 +19,7 @@
 #include <cassert>
 
 #include "tools/ParallelTool.h"
+#include "tools/Instrumentation.h"
 #include "HeightMapMesh.h"
 
 //******************************************************************************
@@ -33,6 +34,49 @@ const float HEIGHT_FACTOR = 50.f;
 //------------------------------------------------------------------------------
 HeightMapMesh::HeightMapMesh(std::string const& fileName)
 //------------------------------------------------------------------------------
+{
+	Types::float_matrix imageData(readFile(fileName, m_n, m_m));
+
+	//create m_verticesPosition, m_verticesNormal
+	//and m_verticesCount thanks to the data
+	create(imageData, 0, m_n - 1, 1);
+}
+
+//------------------------------------------------------------------------------
+HeightMapMesh::HeightMapMesh(Types::float_matrix const& imageData,
+							 unsigned int n, unsigned int m):
+//------------------------------------------------------------------------------
+	m_n(n),
+	m_m(m)
+//------------------------------------------------------------------------------
+{
+	//create m_verticesPosition, m_verticesNormal
+	//and m_verticesCount thanks to the data
+	create(imageData, 0, m_n - 1, 1);
+}
+
+//------------------------------------------------------------------------------
+HeightMapMesh::HeightMapMesh(Types::float_matrix const& imageData,
+							 unsigned int n, unsigned int m,
+							 unsigned int firstRow, unsigned int lastRow, unsigned int step):
+//------------------------------------------------------------------------------
+	m_n(n),
+	m_m(m)
+//------------------------------------------------------------------------------
+{
+	create(imageData, firstRow, lastRow, step);
+}
+
+//------------------------------------------------------------------------------
+HeightMapMesh::~HeightMapMesh()
+//------------------------------------------------------------------------------
+{
+}
+
+//------------------------------------------------------------------------------
+Types::float_matrix HeightMapMesh::readFile(std::string const& fileName,
+											unsigned int &n, unsigned int &m)
+//------------------------------------------------------------------------------
 {
 	// Open the file
 	std::ifstream input(fileName, std::ios::in);
@@ -42,14 +86,14 @@ HeightMapMesh::HeightMapMesh(std::string const& fileName)
 	if(input)
 	{
 		//read the number of rows and columns
-		input >> m_m >> m_n;
+		input >> m >> n;
 
 		//allocate the vector
-		imageData.resize(m_n, Types::float_line(m_m));
+		imageData.resize(n, Types::float_line(m));
 
 		//read the imageData itself
-		for (unsigned int i(0); i < m_n; i++) {
-			for (unsigned int j(0); j < m_m; j++) {
+		for (unsigned int i(0); i < n; i++) {
+			for (unsigned int j(0); j < m; j++) {
 				input >> imageData[i][j];
 			}
 		}
@@ -59,43 +103,35 @@ HeightMapMesh::HeightMapMesh(std::string const& fileName)
 	else
 		throw std::runtime_error("Cannot open " + fileName);
 
-
-	//create m_verticesPosition, m_verticesColour, m_verticesNormal
-	//and m_verticesCount thanks to the data
-	create(imageData);
+	return imageData;
 }
 
 //------------------------------------------------------------------------------
-HeightMapMesh::HeightMapMesh(Types::float_matrix const& imageData,
-							 unsigned int n, unsigned int m):
-//------------------------------------------------------------------------------
-	m_n(n),
-	m_m(m)
+float HeightMapMesh::getLength() const
 //------------------------------------------------------------------------------
 {
-	//create m_verticesPosition, m_verticesColour, m_verticesNormal
-	//and m_verticesCount thanks to the data
-	create(imageData);
+	return SIDE_FACTOR * m_n / std::max(m_n,m_m);
 }
 
 //------------------------------------------------------------------------------
-HeightMapMesh::~HeightMapMesh()
+float HeightMapMesh::getWidth() const
 //------------------------------------------------------------------------------
 {
+	return SIDE_FACTOR * m_m / std::max(m_n,m_m);
 }
 
 //------------------------------------------------------------------------------
-float HeightMapMesh::getLength() const
+float HeightMapMesh::getHeightScale(unsigned int n, unsigned int m)
 //------------------------------------------------------------------------------
 {
-	return SIDE_FACTOR * m_n / std::max(m_n,m_m);
+	return HEIGHT_FACTOR * std::max(n, m) / SIDE_FACTOR;
 }
 
 //------------------------------------------------------------------------------
-float HeightMapMesh::getWidth() const
+float HeightMapMesh::getStep(unsigned int n, unsigned int m)
 //------------------------------------------------------------------------------
 {
-	return SIDE_FACTOR * m_m / std::max(m_n,m_m);
+	return SIDE_FACTOR / float(std::max(n, m));
 }
 
 
@@ -116,25 +152,37 @@ unsigned int HeightMapMesh::getM() const
 
 
 //------------------------------------------------------------------------------
-void HeightMapMesh::create(Types::float_matrix const& imageData)
+void HeightMapMesh::create(Types::float_matrix const& imageData,
+						   unsigned int firstRow, unsigned int lastRow, unsigned int step)
 //------------------------------------------------------------------------------
 {
-	m_verticesCount = (m_n - 1) * (m_m - 1) * 6;
-
-	m_verticesNormal.resize(m_verticesCount);
-	m_verticesPosition.resize(m_verticesCount);
-	m_verticesColour.resize(m_verticesCount);
+	ScopedTimer timer("HeightMapMesh::create");
 
-	if(m_n != 0 && m_m != 0 && imageData.size() == m_n && imageData[0].size() == m_m)
+	if(m_n > 1 && m_m > 1 && imageData.size() == m_n && imageData[0].size() == m_m &&
+			firstRow < lastRow && lastRow < m_n && step > 0)
 	{
+		m_rows = sampleIndices(firstRow, lastRow, step);
+		m_columns = sampleIndices(0, m_m - 1, step);
+
+		m_verticesCount = (unsigned int)((m_rows.size() - 1) * (m_columns.size() - 1) * 6);
+
+		m_verticesNormal.resize(m_verticesCount);
+		m_verticesPosition.resize(m_verticesCount);
+
 		float size(SIDE_FACTOR/(float(std::max(m_n, m_m))));
 
+		//hardware events of the vertices generation, the worker threads included
+		ScopedCounters counters("HeightMapMesh::generateVertices",
+			(long long)(m_rows.size()) * m_columns.size());
+
 		ParallelTool::performInParallel(
 			[this, size, &imageData](unsigned int leftIndex, unsigned int rightIndex)
 			{
 				generateVertices(size, imageData, leftIndex, rightIndex);
 			},
-			0, m_n - 1);
+			0, (unsigned int)(m_rows.size() - 1));
+
+		reportMemory();
 	}
 	else
 	{
@@ -142,50 +190,63 @@ void HeightMapMesh::create(Types::float_matrix const& imageData)
 	}
 }
 
+//------------------------------------------------------------------------------
+Types::uint_line HeightMapMesh::sampleIndices(unsigned int first, unsigned int last,
+											  unsigned int step)
+//------------------------------------------------------------------------------
+{
+	Types::uint_line indices;
+
+	for(unsigned int index(first); index < last; index += step)
+	{
+		indices.push_back(index);
+	}
+
+	//Always keep the last index so that adjacent parts join
+	indices.push_back(last);
+
+	return indices;
+}
+
 //------------------------------------------------------------------------------
 void HeightMapMesh::generateVertices(float size, const Types::float_matrix &imageData,
 									 unsigned int leftIndex, unsigned int rightIndex)
 //------------------------------------------------------------------------------
 {
+	ScopedTimer timer("HeightMapMesh::generateVertices");
+
+	unsigned int columnCount((unsigned int)(m_columns.size()));
+
 	for (unsigned int i(leftIndex); i < rightIndex; i++) {
-		for (unsigned int j(0); j < m_m - 1; j++) {
+		for (unsigned int j(0); j < columnCount - 1; j++) {
+
+			//indices of the corners in the image
+			unsigned int i1(m_rows[i]), i2(m_rows[i + 1]);
+			unsigned int j1(m_columns[j]), j2(m_columns[j + 1]);
 
-			float x = i * size;
-			float dx = 1 * size;
-			float y = j * size;
-			float dy = 1 * size;
+			float x = i1 * size;
+			float dx = (i2 - i1) * size;
+			float y = j1 * size;
+			float dy = (j2 - j1) * size;
 
 			//extract three vertices
-			QVector3D v1(x, y, imageData[i][j] * HEIGHT_FACTOR);
-			QVector3D v2(x + dx, y, imageData[i + 1][j] * HEIGHT_FACTOR);
-			QVector3D v3(x + dx, y + dy, imageData[i + 1][j + 1] * HEIGHT_FACTOR);
-			QVector3D v4(x, y + dy, imageData[i][j + 1] * HEIGHT_FACTOR);
-
-			//Generate the color depending on the height
-			QVector3D c1(imageData[i][j], 0, 1 - imageData[i][j]);
-			QVector3D c2(imageData[i + 1][j], 0, 1 - imageData[i + 1][j]);
-			QVector3D c3(imageData[i + 1][j + 1], 0, 1 - imageData[i + 1][j + 1]);
-			QVector3D c4(imageData[i][j + 1], 0, 1 - imageData[i][j + 1]);
-
-			int index(6 * (i * (m_m - 1) + j));
+			QVector3D v1(x, y, imageData[i1][j1] * HEIGHT_FACTOR);
+			QVector3D v2(x + dx, y, imageData[i2][j1] * HEIGHT_FACTOR);
+			QVector3D v3(x + dx, y + dy, imageData[i2][j2] * HEIGHT_FACTOR);
+			QVector3D v4(x, y + dy, imageData[i1][j2] * HEIGHT_FACTOR);
+
+			//no colour: the display shader reads it in the colour ramp from the height
+			int index(6 * (i * (columnCount - 1) + j));
 			//the first triangle
 			m_verticesPosition[index] = (v1);
 			m_verticesPosition[index + 1] = (v2);
 			m_verticesPosition[index + 2] = (v3);
 
-			m_verticesColour[index] = (c1);
-			m_verticesColour[index + 1] = (c2);
-			m_verticesColour[index + 2] = (c3);
-
 			//the second triangle
 			m_verticesPosition[index + 3] = (v1);
 			m_verticesPosition[index + 4] = (v3);
 			m_verticesPosition[index + 5] = (v4);
 
-			m_verticesColour[index + 3] = (c1);
-			m_verticesColour[index + 4] = (c3);
-			m_verticesColour[index + 5] = (c4);
-
 			//the order of the vertices is important to calculate the right normal vector
 
 			//create the normal vector for each triangle
@@ -205,3 +266,70 @@ void HeightMapMesh::generateVertices(float size, const Types::float_matrix &imag
 		}
 	}
 }
+
+//------------------------------------------------------------------------------
+void HeightMapMesh::joinBorderNormals(Types::float_matrix const& imageData)
+//------------------------------------------------------------------------------
+{
+	ScopedTimer timer("HeightMapMesh::joinBorderNormals");
+
+	//the decimated parts have no index and keep their one sided normals
+	if(!m_usesIndex || !m_hasNormalData || m_columns.size() != m_m || m_rows.size() < 2 ||
+			m_rows[1] != m_rows[0] + 1)
+		return;
+
+	unsigned int firstRow(m_rows.front()), lastRow(m_rows.back());
+	float size(SIDE_FACTOR/(float(std::max(m_n, m_m))));
+
+	for(unsigned int vertex(0); vertex < m_verticesPosition.size(); vertex++)
+	{
+		QVector3D const& position(m_verticesPosition[vertex]);
+		unsigned int i((unsigned int)(position.x() / size + 0.5f));
+		unsigned int j((unsigned int)(position.y() / size + 0.5f));
+
+		//the rows of the image borders have no triangle on the other side
+		if((i == firstRow && i > 0) || (i == lastRow && i < m_n - 1))
+			m_verticesNormal[vertex] = computePixelNormal(size, imageData, i, j);
+	}
+}
+
+//------------------------------------------------------------------------------
+QVector3D HeightMapMesh::computePixelNormal(float size, Types::float_matrix const& imageData,
+											unsigned int i, unsigned int j) const
+//------------------------------------------------------------------------------
+{
+	auto vertexAt = [&](unsigned int row, unsigned int column)
+		{
+			return QVector3D(row * size, column * size, imageData[row][column] * HEIGHT_FACTOR);
+		};
+
+	//the two triangles of the cell whose corner (i1, j1) is v1, as in generateVertices
+	auto addCell = [&](QVector3D &sum, unsigned int i1, unsigned int j1, bool first, bool second)
+		{
+			QVector3D v1(vertexAt(i1, j1)), v2(vertexAt(i1 + 1, j1)),
+				v3(vertexAt(i1 + 1, j1 + 1)), v4(vertexAt(i1, j1 + 1));
+
+			if(first)
+				sum += QVector3D::crossProduct(v2 - v1, v3 - v1).normalized();
+
+			if(second)
+				sum += QVector3D::crossProduct(v3 - v1, v4 - v1).normalized();
+		};
+
+	QVector3D sum;
+
+	//the pixel is v1 of the cell (i, j), v2 of (i - 1, j), v3 of (i - 1, j - 1) and v4 of (i, j - 1)
+	if(i + 1 < m_n && j + 1 < m_m)
+		addCell(sum, i, j, true, true);
+
+	if(i > 0 && j + 1 < m_m)
+		addCell(sum, i - 1, j, true, false);
+
+	if(i > 0 && j > 0)
+		addCell(sum, i - 1, j - 1, true, true);
+
+	if(i + 1 < m_n && j > 0)
+		addCell(sum, i, j - 1, false, true);
+
+	return sum.normalized();
+}
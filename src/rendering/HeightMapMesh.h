@@ -53,8 +53,33 @@ public:
 	 */
 	HeightMapMesh(const Types::float_matrix &imageData, unsigned int n, unsigned int m);
 
+	/**
+	 * @brief HeightMapMesh Overloaded constructor to create the part of the mesh
+	 * between two rows, possibly decimated
+	 * @param imageData the data of the image as floats in the [0,1] range
+	 * @param n height of the image
+	 * @param m width of the image
+	 * @param firstRow first row of the part
+	 * @param lastRow last row of the part (included)
+	 * @param step keep one row and one column every step, the last ones are always kept
+	 */
+	HeightMapMesh(const Types::float_matrix &imageData, unsigned int n, unsigned int m,
+				  unsigned int firstRow, unsigned int lastRow, unsigned int step);
+
 	virtual ~HeightMapMesh();
 
+	/**
+	 * @brief readFile Read a height map file
+	 * The file has to contain the width, the height and then the data in the [0,1] range
+	 * @param fileName the name of the height map file
+	 * @param n set to the height of the image
+	 * @param m set to the width of the image
+	 * @return the data of the image
+	 * @throws
+	 */
+	static Types::float_matrix readFile(std::string const& fileName,
+										unsigned int &n, unsigned int &m);
+
 	/**
 	 * @brief getLength Calculate the length of the heightmap's mesh
 	 * @return the length of the heightmap's mesh
@@ -67,6 +92,32 @@ public:
 	 */
 	float getWidth() const;
 
+	/**
+	 * @brief getHeightScale
+	 * @param n height of the image
+	 * @param m width of the image
+	 * @return the height of the vertex of a pixel of value 1,
+	 * in units of the distance between two adjacent vertices
+	 */
+	static float getHeightScale(unsigned int n, unsigned int m);
+
+	/**
+	 * @brief getStep
+	 * @param n height of the image
+	 * @param m width of the image
+	 * @return the distance between two adjacent vertices of the full resolution mesh
+	 */
+	static float getStep(unsigned int n, unsigned int m);
+
+	/**
+	 * @brief joinBorderNormals average the normal vectors of the first and the last rows
+	 * over the triangles on both sides, as the index of the whole height map would,
+	 * so that adjacent parts join without a lighting seam.
+	 * To be called after setIndex on a full resolution part, do nothing otherwise
+	 * @param imageData the data of the image the mesh has been created from
+	 */
+	void joinBorderNormals(Types::float_matrix const& imageData);
+
 	//Getters
 	unsigned int getN() const;
 	unsigned int getM() const;
@@ -82,23 +133,52 @@ private:
 	/**
 	 * @brief create Create the mesh
 	 * @param imageData the data of the image as floats in the [0,1] range
+	 * @param firstRow first row of the mesh
+	 * @param lastRow last row of the mesh (included)
+	 * @param step keep one row and one column every step
 	 */
-	void create(Types::float_matrix const& imageData);
+	void create(Types::float_matrix const& imageData,
+				unsigned int firstRow, unsigned int lastRow, unsigned int step);
+
+	/**
+	 * @brief sampleIndices List the indices kept between two indices
+	 * @param first the first index
+	 * @param last the last index, always kept
+	 * @param step keep one index every step
+	 * @return the kept indices
+	 */
+	static Types::uint_line sampleIndices(unsigned int first, unsigned int last, unsigned int step);
 
 	/**
 	 * @brief generateVertices translate the vector read into three vector<QVector3D>
-	 * that can be exploited by the rendering window (position, colour and normal vectors)
+	 * that can be exploited by the rendering window (position and normal vectors)
 	 * Proceed between two values to enable parallel processing
 	 * @param size multiply the position of all vertices by this value
 	 * @param imageData the data of the image as floats in the [0,1] range
-	 * @param leftIndex proceed from this index
+	 * @param leftIndex proceed from this index of m_rows
 	 * @param rightIndex to this index
 	 */
 	void generateVertices(float size, Types::float_matrix const& imageData,
 						  unsigned int leftIndex, unsigned int rightIndex);
 
+	/**
+	 * @brief computePixelNormal compute the normal vector of a pixel as setIndex does,
+	 * from the full resolution triangles around it in the whole image
+	 * @param size distance between two adjacent vertices
+	 * @param imageData the data of the image as floats in the [0,1] range
+	 * @param i row of the pixel
+	 * @param j column of the pixel
+	 * @return the normalized sum of the normal vectors of the triangles sharing the pixel
+	 */
+	QVector3D computePixelNormal(float size, Types::float_matrix const& imageData,
+								 unsigned int i, unsigned int j) const;
+
 	unsigned int m_n, //number of rows
 		m_m; //number of columns
+
+	//rows and columns of the image kept in the mesh
+	Types::uint_line m_rows,
+		m_columns;
 };
 
 #endif //HEIGHTMAPMESH_H
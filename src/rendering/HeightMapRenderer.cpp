@@ -0,0 +1,599 @@
+/**
+*******************************************************************************
+*
+*  @file       HeightMapRenderer.cpp
+*
+*  @brief      Class to render a height map with its shadows and its lvl plan
+*				in the current OpenGL context, independently of any window
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//	Include
+//******************************************************************************
+#include <iostream>
+
+#include "HeightMapRenderer.h"
+#include "GLResourceCache.h"
+#include "HeightMapMesh.h"
+#include "terrainAnalysis/HorizonShadows.h"
+#include "tools/Instrumentation.h"
+
+//******************************************************************************
+//  constant variables
+//******************************************************************************
+//number of texels of the colour ramp, RAMP_SIZE in the display shader
+const unsigned int COLOUR_RAMP_SIZE = 256;
+
+//------------------------------------------------------------------------------
+HeightMapRenderer::HeightMapRenderer(std::shared_ptr<ChunkedHeightMap> const& heightMap):
+//------------------------------------------------------------------------------
+	m_heightMap(heightMap),
+	m_lvlPlan(0),
+	m_contourLines(m_heightMap->getN(), m_heightMap->getM()),
+	m_shadowMap(),
+	m_drawList(),
+	m_shadowMode(DEPTH_MAP_SHADOWS),
+	m_palette(ColourRamp::RED_BLUE),
+	m_shadowMaskTexture(0),
+	m_ambientOcclusionTexture(0),
+	m_viewshedTexture(0),
+	m_normalMapTexture(0),
+	m_colourRampTexture(0),
+	m_ambientOcclusion(),
+	m_normalMap(),
+	m_shadowMapMatrix(),
+	m_mMatrix(),
+	m_length(m_heightMap->getLength()),
+	m_width(m_heightMap->getWidth()),
+	m_shadowMatrixSide(std::max(m_width, m_length)*0.8),
+	m_LvlPlanVisibility(false),
+	m_isViewshedVisible(false),
+	m_isNormalMapUsed(true),
+	m_isNormalMapUploaded(false),
+	m_isAmbientOcclusionUploaded(false),
+	m_isShadowMaskUploaded(false)
+//------------------------------------------------------------------------------
+{
+}
+
+//------------------------------------------------------------------------------
+HeightMapRenderer::~HeightMapRenderer()
+//------------------------------------------------------------------------------
+{
+	if(m_shadowMaskTexture)
+	{
+		glDeleteTextures(1, &m_shadowMaskTexture);
+		glDeleteTextures(1, &m_ambientOcclusionTexture);
+		glDeleteTextures(1, &m_viewshedTexture);
+		glDeleteTextures(1, &m_normalMapTexture);
+		glDeleteTextures(1, &m_colourRampTexture);
+	}
+}
+
+//------------------------------------------------------------------------------
+void HeightMapRenderer::initialize()
+//------------------------------------------------------------------------------
+{
+	initializeOpenGLFunctions();
+
+	//Compile the programs only if no other renderer uses them
+	try{
+		//Load the display shader for the ground
+		m_displayProgram = GLResourceCache::getProgram("displayShader");
+
+		//link the atribute in the shader program to their IDs
+		m_lightDirID = m_displayProgram->uniformLocation("lightDir");
+		m_mvpMatrixID = m_displayProgram->uniformLocation("mvpMatrix");
+		m_cameraPosID = m_displayProgram->uniformLocation("cameraPos");
+		m_shadowMapDisplayMatrixID = m_displayProgram->uniformLocation("shadowMapMatrix");
+		m_shadowMapTextureID = m_displayProgram->uniformLocation("shadowMap");
+		m_useShadowMaskID = m_displayProgram->uniformLocation("useShadowMask");
+		m_shadowMaskTextureID = m_displayProgram->uniformLocation("shadowMask");
+		m_useAmbientOcclusionID = m_displayProgram->uniformLocation("useAmbientOcclusion");
+		m_ambientOcclusionTextureID = m_displayProgram->uniformLocation("ambientOcclusion");
+		m_useViewshedID = m_displayProgram->uniformLocation("useViewshed");
+		m_viewshedTextureID = m_displayProgram->uniformLocation("viewshed");
+		m_useLvlPlanID = m_displayProgram->uniformLocation("useLvlPlan");
+		m_lvlPlanHeightID = m_displayProgram->uniformLocation("lvlPlanHeight");
+		m_useNormalMapID = m_displayProgram->uniformLocation("useNormalMap");
+		m_normalMapTextureID = m_displayProgram->uniformLocation("normalMap");
+		m_colourRampTextureID = m_displayProgram->uniformLocation("colourRamp");
+		m_heightFactorID = m_displayProgram->uniformLocation("heightFactor");
+		m_imageCoordTransformID = m_displayProgram->uniformLocation("imageCoordTransform");
+	}
+	catch(std::exception e)
+	{
+        std::cerr << e.what() << std::endl;
+	}
+
+	try{
+		//Load the display shader for the isolines
+		m_contourProgram = GLResourceCache::getProgram("contourShader");
+		m_mvpContourMatrixID = m_contourProgram->uniformLocation("mvpMatrix");
+	}
+	catch(std::exception e)
+	{
+        std::cerr << e.what() << std::endl;
+	}
+
+	try{
+		//Load the shadow shader
+		m_depthMapProgram = GLResourceCache::getProgram("mapShader");
+	}
+	catch(std::exception e)
+	{
+        std::cerr << e.what() << std::endl;
+	}
+
+	//initialize the buffers, the height map chunks are initialized when rendered
+	m_shadowMap.initialize();
+
+	m_shadowMaskTexture = createImageTexture();
+	m_ambientOcclusionTexture = createImageTexture();
+	m_viewshedTexture = createImageTexture();
+	m_normalMapTexture = createImageTexture();
+	m_colourRampTexture = createImageTexture();
+	uploadColourRamp();
+
+	//set the model matrix, place it in the center
+	m_mMatrix.setToIdentity();
+	m_mMatrix.translate(-m_length/2, -m_width/2, 0.f);
+
+	//set the direction of the light (from the vertex to the light)
+	//and render the shadow map to the buffers of m_shadowMap
+	setLightDir(QVector3D(3.f, -3.f, 5.f).normalized());
+}
+
+//------------------------------------------------------------------------------
+bool HeightMapRenderer::updateShadowMap()
+//------------------------------------------------------------------------------
+{
+	//Replace the previews by the full resolution chunks that are ready.
+	//The height map and the shadow texture are shared: another renderer may have
+	//uploaded chunks or rendered its own shadow map since the last frame
+	m_heightMap->uploadReadyChunks();
+
+	//The normal map is baked once for all the renderers, before the chunks
+	if(!m_normalMap)
+	{
+		m_normalMap = m_heightMap->getNormalMap();
+
+		//Uploaded once: after a failure, the normals of the meshes are kept
+		if(m_normalMap)
+			m_isNormalMapUploaded = uploadNormalMap(*m_normalMap);
+	}
+
+	//The ambient occlusion is baked once for all the renderers, after the chunks
+	if(!m_ambientOcclusion)
+	{
+		m_ambientOcclusion = m_heightMap->getAmbientOcclusion();
+
+		//Uploaded once: after a failure, the ambient light is not darkened
+		if(m_ambientOcclusion)
+		{
+			m_isAmbientOcclusionUploaded = uploadImageTexture(m_ambientOcclusionTexture, *m_ambientOcclusion);
+
+			if(!m_isAmbientOcclusionUploaded)
+				std::cerr << "Cannot upload the ambient occlusion, the ambient light is not darkened" << std::endl;
+		}
+	}
+
+	//The cells are sorted once for all the renderers, the lines wait for them
+	if(!m_contourLines.hasExtractor())
+	{
+		std::shared_ptr<const ContourExtractor> contourExtractor(m_heightMap->getContourExtractor());
+
+		if(contourExtractor)
+		{
+			m_contourLines.setExtractor(contourExtractor);
+
+			if(m_LvlPlanVisibility)
+				m_contourLines.setHeight(m_lvlPlan.getHeight());
+		}
+	}
+
+	//The shadow mask only depends on the image data, not on the meshes.
+	//The shared depth texture is rendered again only if the light direction
+	//or the uploaded chunks differ from its content
+	if(!isShadowMaskUsed() &&
+			!m_shadowMap.contains(m_heightMap->getMeshes(), m_shadowMapMatrix))
+	{
+		renderShadowMap();
+		return true;
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------
+void HeightMapRenderer::renderShadowMap()
+//------------------------------------------------------------------------------
+{
+	ScopedTimer timer("HeightMapRenderer::renderShadowMap");
+
+	if(m_depthMapProgram->isLinked())
+	{
+		m_shadowMap.render(m_heightMap->getMeshes(), m_shadowMapMatrix, m_depthMapProgram);
+	}
+}
+
+//------------------------------------------------------------------------------
+void HeightMapRenderer::renderScene(QMatrix4x4 const& pvMatrix, QMatrix4x4 const& tileMatrix)
+//------------------------------------------------------------------------------
+{
+	ScopedTimer timer("HeightMapRenderer::renderScene");
+
+	//set the matrix used in the displaying programs
+	QMatrix4x4 mvpMatrix(tileMatrix * pvMatrix * m_mMatrix);
+
+	//Calculate the position of the camera for m_displayProgram to calculate the specular component
+	QVector3D cameraPos(pvMatrix.inverted().column(3));
+
+	if(m_displayProgram->isLinked())
+	{
+		//given to the display shader program once, before the first chunk
+		m_drawList.setUniforms(m_displayProgram.get(), [this, mvpMatrix, cameraPos](QOpenGLShaderProgram &program)
+			{
+				//Bind the shadow map texture in texture unit 0
+				glActiveTexture(GL_TEXTURE0);
+				glBindTexture(GL_TEXTURE_2D, m_shadowMap.getMapTexture());
+				program.setUniformValue(m_shadowMapTextureID, 0);
+
+				//the shadow mask in texture unit 1, the ambient occlusion in texture unit 2
+				//and the viewshed in texture unit 3, one texel per vertex of the full resolution mesh
+				glActiveTexture(GL_TEXTURE1);
+				glBindTexture(GL_TEXTURE_2D, m_shadowMaskTexture);
+				program.setUniformValue(m_shadowMaskTextureID, 1);
+				program.setUniformValue(m_useShadowMaskID, isShadowMaskUsed());
+
+				glActiveTexture(GL_TEXTURE2);
+				glBindTexture(GL_TEXTURE_2D, m_ambientOcclusionTexture);
+				program.setUniformValue(m_ambientOcclusionTextureID, 2);
+				program.setUniformValue(m_useAmbientOcclusionID, m_isAmbientOcclusionUploaded);
+
+				glActiveTexture(GL_TEXTURE3);
+				glBindTexture(GL_TEXTURE_2D, m_viewshedTexture);
+				program.setUniformValue(m_viewshedTextureID, 3);
+				program.setUniformValue(m_useViewshedID, m_isViewshedVisible);
+
+				//the normal map in texture unit 5, after the texture of the heights
+				glActiveTexture(GL_TEXTURE5);
+				glBindTexture(GL_TEXTURE_2D, m_normalMapTexture);
+				program.setUniformValue(m_normalMapTextureID, 5);
+				program.setUniformValue(m_useNormalMapID, m_isNormalMapUsed && m_isNormalMapUploaded);
+
+				//the colours in texture unit 6, read from the heights
+				glActiveTexture(GL_TEXTURE6);
+				glBindTexture(GL_TEXTURE_2D, m_colourRampTexture);
+				program.setUniformValue(m_colourRampTextureID, 6);
+
+				//the threshold of the lvl plan, a uniform: moving the plan costs no upload
+				program.setUniformValue(m_useLvlPlanID, m_LvlPlanVisibility);
+				program.setUniformValue(m_lvlPlanHeightID, m_lvlPlan.getHeight());
+
+				float n(float(m_heightMap->getN())), m(float(m_heightMap->getM()));
+				float step(m_length / n); //distance between two vertices
+				program.setUniformValue(m_imageCoordTransformID,
+					QVector4D(1.f / (step * m), 1.f / (step * n), 0.5f / m, 0.5f / n));
+				program.setUniformValue(m_heightFactorID,
+					HeightMapMesh::getHeightScale(m_heightMap->getN(), m_heightMap->getM()) * step);
+				glActiveTexture(GL_TEXTURE0);
+
+				//send the matrixes to the display shader
+				program.setUniformValue(m_mvpMatrixID, mvpMatrix);
+				//position of the camera
+				program.setUniformValue(m_cameraPosID, cameraPos);
+				//matrix for the shadow
+				program.setUniformValue(m_shadowMapDisplayMatrixID, m_shadowMapMatrix);
+				//direction of the light, for the shadows, the difuse and the specular component
+				program.setUniformValue(m_lightDirID, m_lightDir);
+			});
+
+		//Render the height map
+		for(Mesh *mesh : m_heightMap->getMeshes())
+		{
+			m_drawList.add(m_displayProgram.get(), mesh);
+		}
+	}
+
+	//The terrain under the lvl plan is greyed by the display shader, only the isolines are drawn
+	if (m_LvlPlanVisibility && m_contourProgram->isLinked())
+	{
+		m_drawList.setUniforms(m_contourProgram.get(), [this, mvpMatrix](QOpenGLShaderProgram &program)
+			{
+				program.setUniformValue(m_mvpContourMatrixID, mvpMatrix);
+			});
+
+		m_drawList.add(m_contourProgram.get(), &m_contourLines);
+	}
+
+	//each program is bound once, each chunk is a single draw of its vertex array object
+	m_drawList.submit();
+}
+
+//------------------------------------------------------------------------------
+void HeightMapRenderer::setLightDir(QVector3D const& lightDir)
+//------------------------------------------------------------------------------
+{
+	m_lightDir = lightDir;
+
+	//Rebuild the shadow map matrix
+	m_shadowMapMatrix.setToIdentity();
+	m_shadowMapMatrix.ortho(-m_shadowMatrixSide, m_shadowMatrixSide, -m_shadowMatrixSide,
+		m_shadowMatrixSide, -m_shadowMatrixSide, m_shadowMatrixSide);
+	m_shadowMapMatrix.lookAt(
+		m_lightDir,
+		QVector3D(0.f, 0.f, 0.f),
+		QVector3D(0.f, 0.f, 1.f)
+	);
+	m_shadowMapMatrix.translate(-m_length/2, -m_width/2, 0.f);
+
+	//compute the shadows on the CPU, or render the shadow map to the buffers of m_shadowMap,
+	//also when the shadow mask cannot be uploaded
+	if(m_shadowMode == HORIZON_SHADOWS)
+		updateShadowMask();
+
+	if(!isShadowMaskUsed())
+		renderShadowMap();
+}
+
+//------------------------------------------------------------------------------
+void HeightMapRenderer::setShadowMode(ShadowMode shadowMode)
+//------------------------------------------------------------------------------
+{
+	m_shadowMode = shadowMode;
+
+	setLightDir(m_lightDir);
+}
+
+//------------------------------------------------------------------------------
+void HeightMapRenderer::updateShadowMask()
+//------------------------------------------------------------------------------
+{
+	ScopedTimer timer("HeightMapRenderer::updateShadowMask");
+
+	unsigned int n(m_heightMap->getN()), m(m_heightMap->getM());
+
+	Types::float_matrix mask(HorizonShadows::computeShadowMask(*m_heightMap->getImageData(),
+		n, m, m_lightDir, HeightMapMesh::getHeightScale(n, m)));
+
+	m_isShadowMaskUploaded = uploadImageTexture(m_shadowMaskTexture, mask);
+
+	if(!m_isShadowMaskUploaded)
+		std::cerr << "Cannot upload the shadow mask, the shadow map is used" << std::endl;
+}
+
+//------------------------------------------------------------------------------
+bool HeightMapRenderer::isShadowMaskUsed() const
+//------------------------------------------------------------------------------
+{
+	return m_shadowMode == HORIZON_SHADOWS && m_isShadowMaskUploaded;
+}
+
+//------------------------------------------------------------------------------
+GLuint HeightMapRenderer::createImageTexture()
+//------------------------------------------------------------------------------
+{
+	GLuint texture(0);
+
+	//one byte per pixel, interpolated to smooth the transitions between the pixels
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	return texture;
+}
+
+//------------------------------------------------------------------------------
+bool HeightMapRenderer::uploadImageTexture(GLuint texture, Types::float_matrix const& values)
+//------------------------------------------------------------------------------
+{
+	unsigned int n(m_heightMap->getN()), m(m_heightMap->getM());
+
+	GLint maxSize(0);
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+
+	if(n > (unsigned int)(maxSize) || m > (unsigned int)(maxSize))
+		return false;
+
+	//rows of the image are the rows of the texture
+	std::vector<unsigned char> texels(size_t(n) * m);
+
+	for(unsigned int i(0); i < n; i++)
+	{
+		for(unsigned int j(0); j < m; j++)
+			texels[size_t(i) * m + j] = (unsigned char)(values[i][j] * 255.f + 0.5f);
+	}
+
+	//forget the previous errors, only the ones of the upload matter
+	while(glGetError() != GL_NO_ERROR);
+
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, m, n, 0, GL_RED, GL_UNSIGNED_BYTE, texels.data());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	//out of video memory
+	return glGetError() == GL_NO_ERROR;
+}
+
+//------------------------------------------------------------------------------
+bool HeightMapRenderer::uploadNormalMap(std::vector<unsigned char> const& texels)
+//------------------------------------------------------------------------------
+{
+	unsigned int n(m_heightMap->getN()), m(m_heightMap->getM());
+
+	GLint maxSize(0);
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+
+	if(n > (unsigned int)(maxSize) || m > (unsigned int)(maxSize))
+	{
+		std::cerr << "The height map is too large for a normal map, the normals of the meshes are used"
+				  << std::endl;
+		return false;
+	}
+
+	//forget the previous errors, only the ones of the upload matter
+	while(glGetError() != GL_NO_ERROR);
+
+	//two bytes per texel, the rows are not aligned on 4 bytes if m is odd
+	glBindTexture(GL_TEXTURE_2D, m_normalMapTexture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RG8, m, n, 0, GL_RG, GL_UNSIGNED_BYTE, texels.data());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	//out of video memory
+	if(glGetError() != GL_NO_ERROR)
+	{
+		std::cerr << "Cannot upload the normal map, the normals of the meshes are used" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+//------------------------------------------------------------------------------
+void HeightMapRenderer::uploadColourRamp()
+//------------------------------------------------------------------------------
+{
+	//a single row, the texture is filtered between the colours of two texels
+	std::vector<unsigned char> texels(ColourRamp::createTexels(m_palette, COLOUR_RAMP_SIZE));
+
+	glBindTexture(GL_TEXTURE_2D, m_colourRampTexture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, COLOUR_RAMP_SIZE, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, texels.data());
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+//------------------------------------------------------------------------------
+void HeightMapRenderer::setPalette(ColourRamp::Palette palette)
+//------------------------------------------------------------------------------
+{
+	m_palette = palette;
+
+	uploadColourRamp();
+}
+
+//------------------------------------------------------------------------------
+void HeightMapRenderer::setNormalMapUse(bool isUsed)
+//------------------------------------------------------------------------------
+{
+	m_isNormalMapUsed = isUsed;
+}
+
+//------------------------------------------------------------------------------
+void HeightMapRenderer::setViewshed(Types::float_matrix const& visibility)
+//------------------------------------------------------------------------------
+{
+	m_isViewshedVisible = uploadImageTexture(m_viewshedTexture, visibility);
+
+	if(!m_isViewshedVisible)
+		std::cerr << "Cannot upload the viewshed, it is not displayed" << std::endl;
+}
+
+//------------------------------------------------------------------------------
+void HeightMapRenderer::clearViewshed()
+//------------------------------------------------------------------------------
+{
+	m_isViewshedVisible = false;
+}
+
+//------------------------------------------------------------------------------
+void HeightMapRenderer::changeLvlPlanHeight(float delta)
+//------------------------------------------------------------------------------
+{
+	m_lvlPlan.changeHeight(delta);
+
+	//only the cells spanning the new height are visited
+	if(m_LvlPlanVisibility)
+		m_contourLines.setHeight(m_lvlPlan.getHeight());
+}
+
+//------------------------------------------------------------------------------
+void HeightMapRenderer::setLvlPlanVisibility(bool isVisible)
+//------------------------------------------------------------------------------
+{
+	m_LvlPlanVisibility = isVisible;
+
+	//the lines are not followed while the plan is hidden
+	if(m_LvlPlanVisibility)
+		m_contourLines.setHeight(m_lvlPlan.getHeight());
+}
+
+//------------------------------------------------------------------------------
+float HeightMapRenderer::getLvlPlanLevel() const
+//------------------------------------------------------------------------------
+{
+	unsigned int n(m_heightMap->getN()), m(m_heightMap->getM());
+
+	return m_lvlPlan.getHeight() / (HeightMapMesh::getHeightScale(n, m) * HeightMapMesh::getStep(n, m));
+}
+
+//------------------------------------------------------------------------------
+HeightMapRenderer::ShadowMode HeightMapRenderer::getShadowMode() const
+//------------------------------------------------------------------------------
+{
+	return m_shadowMode;
+}
+
+//------------------------------------------------------------------------------
+bool HeightMapRenderer::isLvlPlanVisible() const
+//------------------------------------------------------------------------------
+{
+	return m_LvlPlanVisibility;
+}
+
+//------------------------------------------------------------------------------
+bool HeightMapRenderer::isViewshedVisible() const
+//------------------------------------------------------------------------------
+{
+	return m_isViewshedVisible;
+}
+
+//------------------------------------------------------------------------------
+bool HeightMapRenderer::isNormalMapUsed() const
+//------------------------------------------------------------------------------
+{
+	return m_isNormalMapUsed;
+}
+
+//------------------------------------------------------------------------------
+ColourRamp::Palette HeightMapRenderer::getPalette() const
+//------------------------------------------------------------------------------
+{
+	return m_palette;
+}
+
+//------------------------------------------------------------------------------
+QVector3D HeightMapRenderer::getLightDir() const
+//------------------------------------------------------------------------------
+{
+	return m_lightDir;
+}
+
+//------------------------------------------------------------------------------
+float HeightMapRenderer::getLength() const
+//------------------------------------------------------------------------------
+{
+	return m_length;
+}
+
+//------------------------------------------------------------------------------
+float HeightMapRenderer::getWidth() const
+//------------------------------------------------------------------------------
+{
+	return m_width;
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<ChunkedHeightMap> const& HeightMapRenderer::getHeightMap() const
+//------------------------------------------------------------------------------
+{
+	return m_heightMap;
+}
@@ -0,0 +1,288 @@
+#ifndef HEIGHTMAPRENDERER_H
+#define HEIGHTMAPRENDERER_H
+
+/**
+*******************************************************************************
+*
+*  @file       HeightMapRenderer.h
+*
+*  @brief      Class to render a height map with its shadows and its lvl plan
+*				in the current OpenGL context, independently of any window
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <QtGui/QOpenGLFunctions>
+#include <QtGui/QMatrix4x4>
+#include <QtGui/QOpenGLShaderProgram>
+#include <QVector3D>
+#include <memory>
+
+#include "ChunkedHeightMap.h"
+#include "DepthMap.h"
+#include "LvlPlan.h"
+#include "ContourLines.h"
+#include "DrawList.h"
+#include "ColourRamp.h"
+
+//==============================================================================
+/**
+*  @class  HeightMapRenderer
+*  @brief  HeightMapRenderer is a class to render a height map with its shadows
+*			and its lvl plan in the current OpenGL context.
+*			It does not know about the camera nor the target framebuffer,
+*			so that it can render to a window or offscreen.
+*/
+//==============================================================================
+class HeightMapRenderer: protected QOpenGLFunctions
+{
+public:
+	/**
+	 * @brief The ShadowMode enum how the shadows are computed
+	 */
+	enum ShadowMode
+	{
+		DEPTH_MAP_SHADOWS, //rendered to a depth map from the light's point of view
+		HORIZON_SHADOWS //computed on the CPU by HorizonShadows, exact per pixel
+	};
+
+	/**
+	 * @brief HeightMapRenderer constructor
+	 * @param heightMap the height map to render, may be shared with other renderers
+	 */
+	HeightMapRenderer(std::shared_ptr<ChunkedHeightMap> const& heightMap);
+
+	/**
+	 * @brief ~HeightMapRenderer delete the shadow mask texture.
+	 * The context used by initialize() has to be current
+	 */
+	~HeightMapRenderer();
+
+	/**
+	 * @brief initialize Initialize programs and buffers and render the shadow map.
+	 * Programs are shared with the other renderers through GLResourceCache.
+	 * An OpenGL context has to be current
+	 */
+	void initialize();
+
+	/**
+	 * @brief updateShadowMap upload the full resolution chunks, the normal map and the ambient occlusion
+	 * that are ready and, with depth map shadows, render the shadow map again if the meshes changed
+	 * or if another renderer rendered to the shared depth texture since.
+	 * Changes the bound framebuffer and the viewport if the shadow map is rendered
+	 * @return true if the shadow map has been rendered
+	 */
+	bool updateShadowMap();
+
+	/**
+	 * @brief renderShadowMap Render the height map to the shadow map.
+	 * Changes the bound framebuffer and the viewport
+	 */
+	void renderShadowMap();
+
+	/**
+	 * @brief renderScene Render the height map, greyed under the lvl plan if it is visible
+	 * to the bound framebuffer, which has to be cleared before
+	 * @param pvMatrix the projection matrix multiplied by the view matrix of the camera
+	 * @param tileMatrix applied after the projection, to render a part of the screen to the whole viewport.
+	 * The specular component does not depend on it
+	 */
+	void renderScene(QMatrix4x4 const& pvMatrix, QMatrix4x4 const& tileMatrix = QMatrix4x4());
+
+	/**
+	 * @brief setLightDir set the direction of the light and render the shadow map
+	 * or compute the shadow mask again
+	 * @param lightDir the direction from the vertices to the light
+	 */
+	void setLightDir(QVector3D const& lightDir);
+
+	/**
+	 * @brief setShadowMode chose how the shadows are computed and compute them
+	 * @param shadowMode the new mode
+	 */
+	void setShadowMode(ShadowMode shadowMode);
+
+	/**
+	 * @brief setViewshed colour the terrain seen by an observer,
+	 * nothing is coloured if the visibility cannot be uploaded
+	 * @param visibility a n*m matrix containing 1 for the visible pixels and 0 for the hidden ones,
+	 * as computed by Viewshed
+	 */
+	void setViewshed(Types::float_matrix const& visibility);
+
+	/**
+	 * @brief clearViewshed stop colouring the terrain seen by the observer
+	 */
+	void clearViewshed();
+
+	/**
+	 * @brief setNormalMapUse chose where the normal vectors of the terrain come from
+	 * @param isUsed true to light every mesh, previews included, with the normal map
+	 * of the full resolution once it is baked, false for the normals of the meshes
+	 */
+	void setNormalMapUse(bool isUsed);
+
+	/**
+	 * @brief setPalette change the colours of the heights, no mesh is rebuilt.
+	 * The context used by initialize() has to be current
+	 * @param palette the new palette
+	 */
+	void setPalette(ColourRamp::Palette palette);
+
+	/**
+	 * @brief changeLvlPlanHeight change the height of the lvl plan
+	 * and extract the isolines at its new height if it is visible
+	 * @param delta add this value to the height of the plan
+	 */
+	void changeLvlPlanHeight(float delta);
+
+	/**
+	 * @brief setLvlPlanVisibility
+	 * @param isVisible true to render the lvl plan and the isolines at its height
+	 */
+	void setLvlPlanVisibility(bool isVisible);
+
+	/**
+	 * @brief getLvlPlanLevel
+	 * @return the height of the lvl plan as a value of the pixels
+	 */
+	float getLvlPlanLevel() const;
+
+	//Getters
+	ShadowMode getShadowMode() const;
+	bool isLvlPlanVisible() const;
+	bool isViewshedVisible() const;
+	bool isNormalMapUsed() const;
+	ColourRamp::Palette getPalette() const;
+	QVector3D getLightDir() const;
+	float getLength() const;
+	float getWidth() const;
+	std::shared_ptr<ChunkedHeightMap> const& getHeightMap() const;
+
+//******************************************************************************
+private:
+	//No copy constructor
+	HeightMapRenderer(HeightMapRenderer const&);
+
+	//No default constructor
+	HeightMapRenderer();
+
+	/**
+	 * @brief updateShadowMask compute the shadows for the current light direction
+	 * with HorizonShadows and upload them to the shadow mask texture
+	 */
+	void updateShadowMask();
+
+	/**
+	 * @brief isShadowMaskUsed
+	 * @return true if the shadows are read in the shadow mask instead of the shadow map
+	 */
+	bool isShadowMaskUsed() const;
+
+	/**
+	 * @brief createImageTexture create a texture with one texel per pixel of the image
+	 * @return the name of the texture
+	 */
+	GLuint createImageTexture();
+
+	/**
+	 * @brief uploadImageTexture upload values in the [0,1] range as bytes
+	 * @param texture the texture created by createImageTexture
+	 * @param values one value per pixel of the image
+	 * @return false if the height map is larger than the textures or if the upload failed
+	 */
+	bool uploadImageTexture(GLuint texture, Types::float_matrix const& values);
+
+	/**
+	 * @brief uploadNormalMap upload the normal map as a RG8 texture
+	 * @param texels two bytes per pixel, as computed by NormalMap
+	 * @return false if the height map is larger than the textures or if the upload failed
+	 */
+	bool uploadNormalMap(std::vector<unsigned char> const& texels);
+
+	/**
+	 * @brief uploadColourRamp upload the current palette to the colour ramp texture
+	 */
+	void uploadColourRamp();
+
+	//Height map to display, refined progressively. Shared with the renderers displaying the same data
+	std::shared_ptr<ChunkedHeightMap> m_heightMap;
+
+	//threshold of the lvl plan, given to the display program
+	LvlPlan m_lvlPlan;
+
+	//where the lvl plan cuts the height map, displayed with it
+	ContourLines m_contourLines;
+
+	//IDs for inputs in the ground display program
+	GLuint m_lightDirID, //ID of the light direction vector (from the vertex to the light)
+		m_mvpMatrixID, //ID of the Model view position matrix
+		m_cameraPosID, //ID of the position of the camera
+		m_shadowMapDisplayMatrixID, //ID of the projection matrix of the shadow map
+		m_shadowMapTextureID, //ID of the texture of the shadow map
+		m_useShadowMaskID, //ID of the boolean to chose between the shadow map and the shadow mask
+		m_shadowMaskTextureID, //ID of the texture of the shadow mask
+		m_useAmbientOcclusionID, //ID of the boolean to know if the ambient occlusion is ready
+		m_ambientOcclusionTextureID, //ID of the texture of the ambient occlusion
+		m_useViewshedID, //ID of the boolean to know if the viewshed is displayed
+		m_viewshedTextureID, //ID of the texture of the viewshed
+		m_useLvlPlanID, //ID of the boolean to know if the terrain under the lvl plan is greyed
+		m_lvlPlanHeightID, //ID of the height of the lvl plan
+		m_useNormalMapID, //ID of the boolean to know if the normals are read in the normal map
+		m_normalMapTextureID, //ID of the texture of the normal map
+		m_colourRampTextureID, //ID of the texture of the colours of the heights
+		m_heightFactorID, //ID of the height of a pixel of value 1
+		m_imageCoordTransformID; //ID of the scale and offset from the positions to the coordinates in the image textures
+
+	//ID of the Model view position matrix in the isolines display program
+	GLuint m_mvpContourMatrixID;
+
+	//Programs shared with the other renderers
+	std::shared_ptr<QOpenGLShaderProgram> m_displayProgram, // The render program displaying on the screen
+		m_contourProgram, //Program to display the isolines
+		m_depthMapProgram;//the program to create the shadow map
+
+	DepthMap m_shadowMap; //object containing buffers and program to create the shadow map
+
+	//draws of the scene, sorted by program before being rendered
+	DrawList m_drawList;
+
+	ShadowMode m_shadowMode;
+
+	//colours of the heights, sampled in m_colourRampTexture
+	ColourRamp::Palette m_palette;
+
+	GLuint m_shadowMaskTexture, //lit (1) and shadowed (0) pixels, one texel per pixel of the image
+		m_ambientOcclusionTexture, //fraction of the sky seen by each pixel of the image
+		m_viewshedTexture, //visible (1) and hidden (0) pixels from the observer
+		m_normalMapTexture, //normal vector of each pixel of the image
+		m_colourRampTexture; //colour of each height, a single row
+
+	//the ambient occlusion of m_heightMap once uploaded, null before
+	Types::shared_matrix m_ambientOcclusion;
+
+	//the normal map of m_heightMap once baked, null before
+	std::shared_ptr<const std::vector<unsigned char>> m_normalMap;
+
+	QVector3D m_lightDir;//the direction of the light (from the vertex to the light)
+
+	QMatrix4x4 m_shadowMapMatrix,	//the  matrix from the light's point of view to create the shadow map
+		m_mMatrix; //the model matrix
+
+	float m_length, //length of the model
+		m_width, //width of the model
+		m_shadowMatrixSide; //size of the cube that the shadow map take into account
+
+	bool m_LvlPlanVisibility, //to chose if the lvl plan has to be displayed
+		m_isViewshedVisible, //to know if the viewshed texture has to be displayed
+		m_isNormalMapUsed, //to know if the normals are read in the normal map once it is uploaded
+		m_isNormalMapUploaded, //to know if the normal map texture contains m_normalMap
+		m_isAmbientOcclusionUploaded, //to know if the ambient occlusion texture contains m_ambientOcclusion
+		m_isShadowMaskUploaded; //to know if the shadow mask texture contains the shadows of m_lightDir
+};
+
+#endif //HEIGHTMAPRENDERER_H
@@ -0,0 +1,157 @@
+/**
+*******************************************************************************
+*
+*  @file       HeightTextureMesh.cpp
+*
+*  @brief      Class to render a height map whose vertices are generated
+*				by the vertex shader from a texture of the heights
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <iostream>
+#include <stdexcept>
+
+#include "HeightTextureMesh.h"
+#include "HeightMapMesh.h"
+#include "tools/Instrumentation.h"
+
+//******************************************************************************
+//  constant variables
+//******************************************************************************
+//after the textures of the display shader (shadow map, shadow mask, ambient occlusion, viewshed)
+const GLint HEIGHT_TEXTURE_UNIT = 4;
+
+//name of the byte counter of the height textures
+const char * const TEXTURE_BYTE_COUNTER_NAME = "Height texture";
+
+//------------------------------------------------------------------------------
+HeightTextureMesh::HeightTextureMesh(Types::shared_matrix const& heights, unsigned int n, unsigned int m):
+//------------------------------------------------------------------------------
+	m_heights(heights),
+	m_n(n),
+	m_m(m),
+	m_step(HeightMapMesh::getStep(n, m)),
+	m_heightFactor(HeightMapMesh::getHeightScale(n, m) * m_step),
+	m_heightTexture(0),
+	m_reportedTextureBytes(0)
+//------------------------------------------------------------------------------
+{
+	//two triangles per cell, as the mesh without index
+	m_verticesCount = (n - 1) * (m - 1) * 6;
+}
+
+//------------------------------------------------------------------------------
+HeightTextureMesh::~HeightTextureMesh()
+//------------------------------------------------------------------------------
+{
+	if(m_heightTexture)
+		glDeleteTextures(1, &m_heightTexture);
+
+	Instrumentation::addBytes(TEXTURE_BYTE_COUNTER_NAME, -m_reportedTextureBytes);
+}
+
+//------------------------------------------------------------------------------
+void HeightTextureMesh::render()
+//------------------------------------------------------------------------------
+{
+	try
+	{
+		//a single attempt: a height map too large for a texture is not drawn
+		if(!m_isInitialized)
+		{
+			m_isInitialized = true;
+			initializeOpenGLFunctions();
+			uploadTexture();
+		}
+
+		if(!m_heightTexture)
+			return;
+
+		//the uniforms of the program bound, -1 and ignored if it does not use them
+		GLint program(0);
+		glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+
+		UniformLocations const& locations(getUniformLocations(GLuint(program)));
+
+		glUniform1i(locations.useHeightTexture, 1);
+		glUniform1i(locations.heights, HEIGHT_TEXTURE_UNIT);
+		glUniform1f(locations.gridStep, m_step);
+		glUniform1f(locations.heightFactor, m_heightFactor);
+
+		glActiveTexture(GL_TEXTURE0 + HEIGHT_TEXTURE_UNIT);
+		glBindTexture(GL_TEXTURE_2D, m_heightTexture);
+		glActiveTexture(GL_TEXTURE0);
+
+		//no attribute, the vertex array object only has to be bound
+		QOpenGLVertexArrayObject &vertexArray(bindVertexArray());
+		glDrawArrays(GL_TRIANGLES, 0, m_verticesCount);
+		vertexArray.release();
+
+		//the other meshes rendered with this program read their attributes
+		glUniform1i(locations.useHeightTexture, 0);
+	}
+	catch(std::exception const& e)
+	{
+		std::cerr << "ERROR : " << e.what() << std::endl;
+	}
+}
+
+//------------------------------------------------------------------------------
+void HeightTextureMesh::uploadTexture()
+//------------------------------------------------------------------------------
+{
+	ScopedTimer timer("HeightTextureMesh::uploadTexture");
+
+	GLint maxSize(0);
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+
+	if(m_n > (unsigned int)(maxSize) || m_m > (unsigned int)(maxSize))
+		throw std::runtime_error("The height map is too large for a texture of the heights");
+
+	Types::float_matrix const& heights(*m_heights);
+
+	glGenTextures(1, &m_heightTexture);
+	glBindTexture(GL_TEXTURE_2D, m_heightTexture);
+
+	//the columns along x of the texture, the rows along y; 32 bits keep the heights of the mesh
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, GLsizei(m_m), GLsizei(m_n), 0, GL_RED, GL_FLOAT, nullptr);
+
+	//the rows of the matrix are not contiguous
+	for(unsigned int i(0); i < m_n; i++)
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, GLint(i), GLsizei(m_m), 1, GL_RED, GL_FLOAT, heights[i].data());
+
+	//texelFetch does not filter, but a texture waiting for mipmaps would be incomplete
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	m_reportedTextureBytes = (long long)(m_n) * m_m * sizeof(float);
+	Instrumentation::addBytes(TEXTURE_BYTE_COUNTER_NAME, m_reportedTextureBytes);
+}
+
+//------------------------------------------------------------------------------
+HeightTextureMesh::UniformLocations const& HeightTextureMesh::getUniformLocations(GLuint program)
+//------------------------------------------------------------------------------
+{
+	//GLResourceCache releases the programs with the last window, as the meshes:
+	//the ID of a program is not reused while the mesh lives
+	std::map<GLuint, UniformLocations>::iterator it(m_uniformLocations.find(program));
+
+	if(it == m_uniformLocations.end())
+	{
+		UniformLocations locations;
+		locations.useHeightTexture = glGetUniformLocation(program, "useHeightTexture");
+		locations.heights = glGetUniformLocation(program, "heights");
+		locations.gridStep = glGetUniformLocation(program, "gridStep");
+		locations.heightFactor = glGetUniformLocation(program, "heightFactor");
+
+		it = m_uniformLocations.insert(std::make_pair(program, locations)).first;
+	}
+
+	return it->second;
+}
@@ -0,0 +1,108 @@
+#ifndef HEIGHTTEXTUREMESH_H
+#define HEIGHTTEXTUREMESH_H
+
+/**
+*******************************************************************************
+*
+*  @file       HeightTextureMesh.h
+*
+*  @brief      Class to render a height map whose vertices are generated
+*				by the vertex shader from a texture of the heights
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <map>
+
+#include "Mesh.h"
+
+//==============================================================================
+/**
+*  @class  HeightTextureMesh
+*  @brief  HeightTextureMesh is a class to render a height map without vertex buffer.
+*			The heights are uploaded once in a single channel float texture,
+*			4 bytes per pixel instead of the 144 bytes of the six vertices of a cell.
+*			The shaders generate the two triangles of each cell from gl_VertexID,
+*			in the order of HeightMapMesh, with the normals of the neighbouring pixels.
+*			The size of the height map is limited by GL_MAX_TEXTURE_SIZE.
+*/
+//==============================================================================
+class HeightTextureMesh: public Mesh
+{
+public:
+	/**
+	 * @brief HeightTextureMesh constructor, the texture is uploaded by the first render()
+	 * @param heights the heights in the [0,1] range, shared without copy
+	 * @param n number of rows
+	 * @param m number of columns
+	 */
+	HeightTextureMesh(Types::shared_matrix const& heights, unsigned int n, unsigned int m);
+
+	/**
+	 * @brief ~HeightTextureMesh delete the texture.
+	 * An OpenGL context of the share group has to be current if it has been rendered
+	 */
+	~HeightTextureMesh();
+
+	/**
+	 * @brief render Render the height map in the current OpenGL context.
+	 * The shader program bound has to read the uniforms useHeightTexture, heights,
+	 * gridStep and heightFactor; useHeightTexture is set back to false after the draw
+	 */
+	void render();
+
+//******************************************************************************
+private:
+	//No default constructor
+	HeightTextureMesh();
+
+	/**
+	 * @brief uploadTexture create the texture of the heights, one texel per pixel
+	 * @throws std::runtime_error if the height map is larger than the textures
+	 */
+	void uploadTexture();
+
+	///@cond
+	/**
+	 * @brief The UniformLocations struct holds the locations of the uniforms read by the shaders of a program,
+	 * -1 if it does not use them
+	 */
+	struct UniformLocations
+	{
+		GLint useHeightTexture;
+		GLint heights;
+		GLint gridStep;
+		GLint heightFactor;
+	};
+	///@endcond
+
+	/**
+	 * @brief getUniformLocations look up the uniforms of a program the first time it renders the mesh
+	 * @param program ID of the program bound
+	 * @return the locations of the uniforms in the program
+	 */
+	UniformLocations const& getUniformLocations(GLuint program);
+
+	Types::shared_matrix m_heights;
+	unsigned int m_n;
+	unsigned int m_m;
+
+	float m_step, //distance between two vertices of the mesh
+		m_heightFactor; //height of a pixel of value 1 in the mesh
+
+	//ID of the texture of the heights, 0 if it could not be created
+	GLuint m_heightTexture;
+
+	//memory of the texture given to the instrumentation
+	long long m_reportedTextureBytes;
+
+	//the locations of the uniforms for each program that rendered the mesh,
+	//the display and the shadow map programs alternate at each frame
+	std::map<GLuint, UniformLocations> m_uniformLocations;
+};
+
+#endif // HEIGHTTEXTUREMESH_H
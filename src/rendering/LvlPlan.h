@@ -12,21 +12,18 @@
 *******************************************************************************
 */
 
-//******************************************************************************
-//  Include
-//******************************************************************************
-#include "Mesh.h"
-
 //==============================================================================
 /**
 *  @class  LvlPlan
-*  @brief  LvlPlan is a class to handle a lvl plan mesh  to highlight the edges
+*  @brief  LvlPlan is a class to handle a lvl plan to highlight the edges.
+*			The plan has no mesh: its height is a uniform of the display shader,
+*			which greys the fragments under it, so moving it uploads nothing
 */
 //==============================================================================
-class LvlPlan: public Mesh
+class LvlPlan
 {
 public:
-	LvlPlan(float height, float length, float width);
+	LvlPlan(float height);
 
 	/**
 	 * @brief changeHeight  Change the height of the lvl plan
@@ -34,14 +31,18 @@ public:
 	 */
 	void changeHeight(float delta);
 
+	/**
+	 * @brief getHeight
+	 * @return the height of the plan in the space of the mesh
+	 */
+	float getHeight() const;
+
 //******************************************************************************
 private:
 	//No default constructor
 	LvlPlan();
 
-	float m_height, //The height of the lvl plan. Can be seen as a threshold for the edge detection.
-		m_length, //Size of a side of the plan
-		m_width; //Size of the other side
+	float m_height; //The height of the lvl plan. Can be seen as a threshold for the edge detection.
 };
 
 #endif // LVLPLAN_H
@@ -14,19 +14,40 @@
 //******************************************************************************
 #include <QtGui/QOpenGLShaderProgram>
 #include <math.h>
+#include <algorithm>
 #include <iostream>
+#include <stdexcept>
 
 #include "tools/ParallelTool.h"
+#include "tools/Instrumentation.h"
 #include "Mesh.h"
 
+//******************************************************************************
+//  constant variables
+//******************************************************************************
+//names of the byte counters of all the meshes
+const char * const CPU_BYTE_COUNTER_NAME = "Mesh vertices";
+const char * const GPU_BYTE_COUNTER_NAME = "Mesh VBO";
+
 //------------------------------------------------------------------------------
 Mesh::Mesh():
 //------------------------------------------------------------------------------
 m_verticesCount(0),
+m_primitive(GL_TRIANGLES),
+m_usage(GL_STATIC_DRAW),
+m_dirtyRanges(),
+m_reportedBytes(0),
+m_reportedGpuBytes(0),
 m_positionBuffer(0),
 m_normalBuffer(0),
 m_colourBuffer(0),
 m_indexBuffer(0),
+m_positionBytes(0),
+m_normalBytes(0),
+m_colourBytes(0),
+m_indexBytes(0),
+m_buffersVersion(0),
+m_vertexArrays(),
 m_isInitialized(false),
 m_hasNormalData(false),
 m_hasColourData(false),
@@ -40,6 +61,8 @@ Mesh::~Mesh()
 //------------------------------------------------------------------------------
 {
 	cleanUpVBO();
+
+	Instrumentation::addBytes(CPU_BYTE_COUNTER_NAME, -m_reportedBytes);
 }
 
 //------------------------------------------------------------------------------
@@ -62,37 +85,82 @@ void Mesh::initialize()
 void Mesh::updateVBO()
 //------------------------------------------------------------------------------
 {
-	cleanUpVBO();
+	ScopedTimer timer("Mesh::updateVBO");
+
+	//New data stores if the number of vertices changed, the ranges would not match them
+	long long positionBytes((long long)(m_verticesPosition.size()) * 3 * sizeof(float));
+	bool isFullUpload(m_dirtyRanges.isEmpty() || !m_positionBuffer || positionBytes != m_positionBytes ||
+					  m_dirtyRanges.getEnd() > m_verticesPosition.size());
 
-	//Create VBO thanks to the data
-	glGenBuffers(1, &m_positionBuffer);
-	glBindBuffer(GL_ARRAY_BUFFER, m_positionBuffer);
-	glBufferData(GL_ARRAY_BUFFER, m_verticesPosition.size() * 3 * sizeof(float),
-				 &m_verticesPosition[0], GL_STATIC_DRAW);
+	uploadVertices(m_positionBuffer, m_positionBytes, m_verticesPosition, isFullUpload);
 
 	if(m_hasNormalData)
+		uploadVertices(m_normalBuffer, m_normalBytes, m_verticesNormal, isFullUpload);
+
+	if(m_hasColourData)
+		uploadVertices(m_colourBuffer, m_colourBytes, m_verticesColour, isFullUpload);
+
+	//the index only changes with the whole mesh
+	if(m_usesIndex && isFullUpload)
 	{
-		glGenBuffers(1, &m_normalBuffer);
-		glBindBuffer(GL_ARRAY_BUFFER, m_normalBuffer);
-		glBufferData(GL_ARRAY_BUFFER, m_verticesNormal.size() * 3 * sizeof(float),
-					 &m_verticesNormal[0], GL_STATIC_DRAW);
+		if(!m_indexBuffer)
+		{
+			glGenBuffers(1, &m_indexBuffer);
+			m_buffersVersion++;
+		}
+
+		m_indexBytes = (long long)(m_verticesIndex.size()) * sizeof(GLuint);
+
+		//The element array binding belongs to the bound vertex array object:
+		//the data goes through GL_ARRAY_BUFFER, bindVertexArray() binds it as the index
+		glBindBuffer(GL_ARRAY_BUFFER, m_indexBuffer);
+		glBufferData(GL_ARRAY_BUFFER, m_indexBytes, m_verticesIndex.data(), m_usage);
 	}
 
-	if(m_hasColourData)
+	m_dirtyRanges.clear();
+
+	//Same sizes as the data stores
+	long long gpuBytes(m_positionBytes + m_normalBytes + m_colourBytes + m_indexBytes);
+	Instrumentation::addBytes(GPU_BYTE_COUNTER_NAME, gpuBytes - m_reportedGpuBytes);
+	m_reportedGpuBytes = gpuBytes;
+}
+
+//------------------------------------------------------------------------------
+void Mesh::uploadVertices(GLuint &buffer, long long &allocatedBytes,
+						  Types::vertices_data const& vertices, bool isFullUpload)
+//------------------------------------------------------------------------------
+{
+	if(!buffer)
 	{
-		glGenBuffers(1, &m_colourBuffer);
-		glBindBuffer(GL_ARRAY_BUFFER, m_colourBuffer);
-		glBufferData(GL_ARRAY_BUFFER, m_verticesColour.size() * 3 * sizeof(float),
-					 &m_verticesColour[0], GL_STATIC_DRAW);
+		glGenBuffers(1, &buffer);
+		m_buffersVersion++;
 	}
 
-	if(m_usesIndex)
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+	if(isFullUpload)
 	{
-		glGenBuffers(1, &m_indexBuffer);
-		glBindBuffer(GL_ARRAY_BUFFER, m_indexBuffer);
-		glBufferData(GL_ARRAY_BUFFER, m_verticesCount * sizeof(float),
-					 &m_verticesIndex[0], GL_STATIC_DRAW);
+		//The buffer is kept, its previous data store is orphaned
+		//so that the driver does not wait for the frames still drawing it
+		allocatedBytes = (long long)(vertices.size()) * 3 * sizeof(float);
+		glBufferData(GL_ARRAY_BUFFER, allocatedBytes, vertices.data(), m_usage);
 	}
+	else
+	{
+		for(std::pair<unsigned int, unsigned int> const& range : m_dirtyRanges.getRanges())
+		{
+			glBufferSubData(GL_ARRAY_BUFFER, (long long)(range.first) * 3 * sizeof(float),
+							(long long)(range.second - range.first) * 3 * sizeof(float),
+							&vertices[range.first]);
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+void Mesh::markDirty(unsigned int first, unsigned int count)
+//------------------------------------------------------------------------------
+{
+	m_dirtyRanges.add(first, count);
 }
 
 //------------------------------------------------------------------------------
@@ -108,6 +176,60 @@ void Mesh::render()
 			initialize();
 		}
 
+		//The attributes and the index are in the vertex array object
+		QOpenGLVertexArrayObject &vertexArray(bindVertexArray());
+
+		if(m_usesIndex)
+		{
+			//draws the triangle on the window
+			glDrawElements(m_primitive, m_verticesCount, GL_UNSIGNED_INT, (void*)0);
+		}
+		else
+		{
+			//draws the triangle on the window
+			glDrawArrays(m_primitive, 0, m_verticesCount);
+		}
+
+		vertexArray.release();
+	}
+	catch(std::exception const& e)
+	{
+        std::cerr << "ERROR : " << e.what() << std::endl;
+	}
+}
+
+//------------------------------------------------------------------------------
+QOpenGLVertexArrayObject &Mesh::bindVertexArray()
+//------------------------------------------------------------------------------
+{
+	//A vertex array object is destroyed with its context, and a new context
+	//may be created at the same address: the destroyed ones are forgotten
+	for(auto ite(m_vertexArrays.begin()); ite != m_vertexArrays.end();)
+	{
+		if(ite->second.object && !ite->second.object->isCreated())
+			ite = m_vertexArrays.erase(ite);
+		else
+			++ite;
+	}
+
+	VertexArray &vertexArray(m_vertexArrays[QOpenGLContext::currentContext()]);
+
+	if(!vertexArray.object)
+	{
+		vertexArray.object.reset(new QOpenGLVertexArrayObject());
+
+		if(!vertexArray.object->create())
+			throw std::runtime_error("Cannot create a vertex array object");
+
+		//never set
+		vertexArray.buffersVersion = m_buffersVersion + 1;
+	}
+
+	vertexArray.object->bind();
+
+	//a mesh generated by the vertex shader has no buffer, its vertex array object stays empty
+	if(vertexArray.buffersVersion != m_buffersVersion && m_positionBuffer)
+	{
 		glEnableVertexAttribArray(0);
 		glBindBuffer(GL_ARRAY_BUFFER, m_positionBuffer);
 		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
@@ -127,31 +249,12 @@ void Mesh::render()
 		}
 
 		if(m_usesIndex)
-		{
 			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
 
-			//draws the triangle on the window
-			glDrawElements(GL_TRIANGLES, m_verticesCount, GL_UNSIGNED_INT, (void*)0);
-		}
-		else
-		{
-			//draws the triangle on the window
-			glDrawArrays(GL_TRIANGLES, 0, m_verticesCount);
-		}
-
-		//Disable
-		glDisableVertexAttribArray(0);
-
-		if(m_hasNormalData)
-			glDisableVertexAttribArray(1);
-
-		if(m_hasColourData)
-			glDisableVertexAttribArray(2);
-	}
-	catch(std::exception const& e)
-	{
-        std::cerr << "ERROR : " << e.what() << std::endl;
+		vertexArray.buffersVersion = m_buffersVersion;
 	}
+
+	return *vertexArray.object;
 }
 
 ///@cond
@@ -214,6 +317,8 @@ public:
 void Mesh::setIndex()
 //----------------------------------------------
 {
+	ScopedTimer timer("Mesh::setIndex");
+
 	if(!m_usesIndex)
 	{
 		if(!m_isInitialized)
@@ -303,29 +408,52 @@ void Mesh::setIndex()
 			m_verticesPosition[id] = ite->first;
 		}
 
+		//the index buffer is created by updateVBO()
+		m_usesIndex = true;
+
 		if(m_isInitialized)
 			updateVBO();
 
-		m_usesIndex = true;
+		reportMemory();
 	}
 }
 
+//------------------------------------------------------------------------------
 void Mesh::cleanUpVBO()
+//------------------------------------------------------------------------------
 {
 	if(m_isInitialized)
 	{
-		// Cleanup VBO if needed
+		// Cleanup VBO if needed, the buffers never created are 0 and ignored
 		glDeleteBuffers(1, &m_positionBuffer);
+		glDeleteBuffers(1, &m_normalBuffer);
+		glDeleteBuffers(1, &m_colourBuffer);
+		glDeleteBuffers(1, &m_indexBuffer);
+	}
 
-		if(m_hasNormalData)
-			glDeleteBuffers(1, &m_normalBuffer);
+	m_positionBuffer = m_normalBuffer = m_colourBuffer = m_indexBuffer = 0;
+	m_positionBytes = m_normalBytes = m_colourBytes = m_indexBytes = 0;
 
-		if(m_hasColourData)
-			glDeleteBuffers(1, &m_colourBuffer);
+	//QOpenGLVertexArrayObject makes its own context current to destroy itself
+	m_vertexArrays.clear();
 
-		if(m_verticesIndex.size())
-			glDeleteBuffers(1, &m_indexBuffer);
-	}
+	//render() creates the buffers again
+	m_isInitialized = false;
+
+	Instrumentation::addBytes(GPU_BYTE_COUNTER_NAME, -m_reportedGpuBytes);
+	m_reportedGpuBytes = 0;
+}
+
+//------------------------------------------------------------------------------
+void Mesh::reportMemory()
+//------------------------------------------------------------------------------
+{
+	long long bytes((long long)(m_verticesPosition.capacity() + m_verticesColour.capacity() +
+		m_verticesNormal.capacity()) * sizeof(QVector3D) +
+		(long long)(m_verticesIndex.capacity()) * sizeof(unsigned int));
+
+	Instrumentation::addBytes(CPU_BYTE_COUNTER_NAME, bytes - m_reportedBytes);
+	m_reportedBytes = bytes;
 }
 
 //------------------------------------------------------------------------------
@@ -18,14 +18,22 @@
 #include <QVector3D>
 #include <vector>
 #include <QOpenGLFunctions>
+#include <QOpenGLContext>
+#include <QOpenGLVertexArrayObject>
 #include <atomic>
+#include <map>
+#include <memory>
+#include <utility>
 
 #include "tools/Types.h"
+#include "tools/DirtyRanges.h"
 
 //==============================================================================
 /**
 *  @class  Mesh
-*  @brief  Mesh is a class to handel a mesh to display it thanks to OpenGL
+*  @brief  Mesh is a class to handel a mesh to display it thanks to OpenGL.
+*			The attributes are set once in a vertex array object per context,
+*			since the meshes are shared by the windows and the vertex array objects are not
 */
 //==============================================================================
 class Mesh: protected QOpenGLFunctions
@@ -44,15 +52,24 @@ public:
 	void initialize();
 
 	/**
-	 * @brief updateVBO VBO needs update when data change
+	 * @brief updateVBO VBO needs update when data change.
+	 * The buffers are kept: only the ranges given to markDirty() are uploaded,
+	 * everything is uploaded again if none was given or if the number of vertices changed
 	 */
 	void updateVBO();
 
+	/**
+	 * @brief markDirty note that some vertices changed, to upload only them with the next updateVBO()
+	 * @param first first vertex changed
+	 * @param count number of vertices changed
+	 */
+	void markDirty(unsigned int first, unsigned int count);
+
 	/**
 	 * @brief render Render the mesh in the current OpenGL context.
 	 * An OpenGL shader program need to be bound before calling this function.
 	 */
-	void render();
+	virtual void render();
 
 	/**
 	 * @brief setIndex change from one normal per face to one normal per vertex
@@ -62,7 +79,8 @@ public:
 	void setIndex();
 
 	/**
-	 * @brief cleanUpVBO Clean up VBO if needed, needed before deletion
+	 * @brief cleanUpVBO Clean up VBO if needed, needed before deletion.
+	 * The next render() creates them again
 	 */
 	void cleanUpVBO();
 
@@ -100,6 +118,31 @@ protected:
 	//no copy constructor
 	Mesh(const Mesh&);
 
+	/**
+	 * @brief uploadVertices upload the data of an attribute to its array buffer,
+	 * created if needed
+	 * @param buffer ID of the buffer, 0 if it has not been created
+	 * @param allocatedBytes size of the buffer, updated if it is allocated again
+	 * @param vertices the data of the attribute
+	 * @param isFullUpload true to upload all the vertices, false for the dirty ranges only
+	 */
+	void uploadVertices(GLuint &buffer, long long &allocatedBytes,
+						Types::vertices_data const& vertices, bool isFullUpload);
+
+	/**
+	 * @brief bindVertexArray bind the vertex array object of the current context,
+	 * create it or set its attributes again if the buffers changed since
+	 * @return the vertex array object bound
+	 * @throws std::runtime_error if the vertex array object cannot be created
+	 */
+	QOpenGLVertexArrayObject &bindVertexArray();
+
+	/**
+	 * @brief reportMemory update the instrumentation with the memory held by the vertices
+	 * to be called each time they change
+	 */
+	void reportMemory();
+
 	Types::vertices_data m_verticesPosition, //Position of the vertices
 		m_verticesColour,
 		m_verticesNormal; //normal vectors
@@ -110,12 +153,48 @@ protected:
 	//number of vertices
 	unsigned int m_verticesCount;
 
+	//how the vertices are assembled, GL_TRIANGLES by default
+	GLenum m_primitive;
+
+	//how often the buffers change, GL_STATIC_DRAW by default
+	GLenum m_usage;
+
+	//first vertex and one past the last vertex of the ranges changed since the last upload
+	DirtyRanges m_dirtyRanges;
+
+	long long m_reportedBytes, //memory of the vertices given to the instrumentation
+		m_reportedGpuBytes; //memory of the VBO given to the instrumentation
+
 	//IDs of array buffers
 	GLuint m_positionBuffer,
 		m_normalBuffer,
 		m_colourBuffer,
 		m_indexBuffer;
 
+	//size of the data store of each buffer
+	long long m_positionBytes,
+		m_normalBytes,
+		m_colourBytes,
+		m_indexBytes;
+
+	//changes each time a buffer is created, the vertex arrays of older versions are set again
+	unsigned int m_buffersVersion;
+
+	///@cond
+	/**
+	 * @brief The VertexArray struct the vertex array object of a context
+	 * and the version of the buffers it points to
+	 */
+	struct VertexArray
+	{
+		std::unique_ptr<QOpenGLVertexArrayObject> object;
+		unsigned int buffersVersion;
+	};
+	///@endcond
+
+	//one vertex array object per context rendering the mesh, until the context is destroyed
+	std::map<QOpenGLContext*, VertexArray> m_vertexArrays;
+
 	bool m_isInitialized,//to know if initialize() has been called
 		m_hasNormalData,
 		m_hasColourData,
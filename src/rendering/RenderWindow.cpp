@@ -14,57 +14,85 @@
 //******************************************************************************
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <stdexcept>
 #include <QOpenGLFunctions>
 #include <QString>
 #include <QFileDialog>
 
 #include "RenderWindow.h"
+#include "GLResourceCache.h"
+#include "terrainAnalysis/Viewshed.h"
 
+//******************************************************************************
+//  constant variables
+//******************************************************************************
+//height of the eyes of the observer of the viewshed, in units of the distance between two pixels
+const float VIEWSHED_OBSERVER_HEIGHT = 2.f;
 
 //------------------------------------------------------------------------------
 RenderWindow::RenderWindow(const std::string &fileName):
 //------------------------------------------------------------------------------
-	m_heightMapMesh(fileName),
-	m_lvlPlan(0, m_heightMapMesh.getLength(), m_heightMapMesh.getWidth()),
-	m_shadowMap(),
-	m_shadowMapMatrix(),
+	m_heightMap(std::make_shared<ChunkedHeightMap>(fileName, ChunkedHeightMap::INDEXED)),
+	m_renderer(m_heightMap),
+	m_cameraPath(),
+	m_exporter(),
+	m_title(),
+	m_pickedI(0),
+	m_pickedJ(0),
 	m_pMatrix(),
 	m_vMatrix(),
-	m_mMatrix(),
-	m_length(m_heightMapMesh.getLength()),
-	m_width(m_heightMapMesh.getWidth()),
-	m_shadowMatrixSide(std::max(m_width, m_length)*0.8),
+	m_length(m_heightMap->getLength()),
+	m_width(m_heightMap->getWidth()),
 	m_zoomAngle(70),
-	m_LvlPlanVisibility(false)
+	m_meshMode(ChunkedHeightMap::INDEXED),
+	m_isRecordingCameraPath(false),
+	m_hasPickedPixel(false)
 //------------------------------------------------------------------------------
 {
+	//Ask for a new frame each time a full resolution chunk is ready
+	m_heightMap->addChunkReadyListener(this, [this]()
+		{
+			QCoreApplication::postEvent(this, new QEvent(QEvent::UpdateRequest));
+		});
+	m_heightMap->buildInBackground();
 }
 
 //------------------------------------------------------------------------------
-RenderWindow::RenderWindow(Types::float_matrix const& imageData,
-						  unsigned int n, unsigned int m, bool useIndex):
+RenderWindow::RenderWindow(Types::shared_matrix const& imageData,
+						  unsigned int n, unsigned int m, ChunkedHeightMap::MeshMode meshMode):
 //------------------------------------------------------------------------------
-	m_heightMapMesh(imageData, n, m),
-	m_lvlPlan(0, m_heightMapMesh.getLength(), m_heightMapMesh.getWidth()),
-	m_shadowMap(),
-	m_shadowMapMatrix(),
+	m_heightMap(GLResourceCache::getHeightMap(imageData, n, m, meshMode)),
+	m_renderer(m_heightMap),
+	m_cameraPath(),
+	m_exporter(),
+	m_title(),
+	m_pickedI(0),
+	m_pickedJ(0),
 	m_pMatrix(),
 	m_vMatrix(),
-	m_mMatrix(),
-	m_length(m_heightMapMesh.getLength()),
-	m_width(m_heightMapMesh.getWidth()),
-	m_shadowMatrixSide(std::max(m_width, m_length)*0.8),
+	m_length(m_heightMap->getLength()),
+	m_width(m_heightMap->getWidth()),
 	m_zoomAngle(70),
-	m_LvlPlanVisibility(false),
-	m_useIndex(useIndex)
+	m_meshMode(meshMode),
+	m_isRecordingCameraPath(false),
+	m_hasPickedPixel(false)
 //------------------------------------------------------------------------------
 {
+	//Ask for a new frame each time a full resolution chunk is ready
+	m_heightMap->addChunkReadyListener(this, [this]()
+		{
+			QCoreApplication::postEvent(this, new QEvent(QEvent::UpdateRequest));
+		});
+	m_heightMap->buildInBackground();
 }
 
 //------------------------------------------------------------------------------
 RenderWindow::~RenderWindow()
 //------------------------------------------------------------------------------
 {
+	m_heightMap->removeChunkReadyListener(this);
+
 	//Make current to make sure children are destroyed with an active context.
 	makeCurrent();
 }
@@ -77,85 +105,8 @@ void RenderWindow::initializeGL()
 
 	initializeOpenGLFunctions();
 
-    //the folder where the s are stored
-    const std::string SHADER_FOLDER = ":/shader/";
-
-	try{
-		//Load the display shader for the ground
-		m_displayProgram.reset(new QOpenGLShaderProgram(this));
-        m_displayProgram->addShaderFromSourceFile(QOpenGLShader::Vertex, (SHADER_FOLDER + "displayShader.vert").c_str());
-        m_displayProgram->addShaderFromSourceFile(QOpenGLShader::Fragment, (SHADER_FOLDER + "displayShader.frag").c_str());
-		m_displayProgram->link();
-
-		//link the atribute in the shader program to their IDs
-		m_lightDirID = m_displayProgram->uniformLocation("lightDir");
-		m_mvpMatrixID = m_displayProgram->uniformLocation("mvpMatrix");
-		m_cameraPosID = m_displayProgram->uniformLocation("cameraPos");
-		m_shadowMapDisplayMatrixID = m_displayProgram->uniformLocation("shadowMapMatrix");
-		m_shadowMapTextureID = m_displayProgram->uniformLocation("shadowMap");
-	}
-	catch(std::exception e)
-	{
-        std::cerr << e.what() << std::endl;
-	}
-
-	try{
-		//Load the display shader for the lvl plan
-		m_lvlProgram.reset(new QOpenGLShaderProgram(this));
-        m_lvlProgram->addShaderFromSourceFile(QOpenGLShader::Vertex, (SHADER_FOLDER + "lvlShader.vert").c_str());
-        m_lvlProgram->addShaderFromSourceFile(QOpenGLShader::Fragment, (SHADER_FOLDER + "lvlShader.frag").c_str());
-		m_lvlProgram->link();
-
-		//Link the atribute to its ID
-		m_verticesLvlPlanPositionID = m_lvlProgram->attributeLocation("position");
-		m_mvpLvlPlanMatrixID = m_lvlProgram->uniformLocation("mvpMatrix");
-	}
-	catch(std::exception e)
-	{
-        std::cerr << e.what() << std::endl;
-	}
-
-	try{
-		//Load the shadow shader
-		m_depthMapProgram.reset(new QOpenGLShaderProgram(this));
-        m_depthMapProgram->addShaderFromSourceFile(QOpenGLShader::Vertex, (SHADER_FOLDER + "mapShader.vert").c_str());
-        m_depthMapProgram->addShaderFromSourceFile(QOpenGLShader::Fragment, (SHADER_FOLDER + "mapShader.frag").c_str());
-		m_depthMapProgram->link();
-	}
-	catch(std::exception e)
-	{
-        std::cerr << e.what() << std::endl;
-	}
-
-	//Set indexes if necessary
-	if(m_useIndex)
-	{
-		m_heightMapMesh.setIndex();
-	}
-	m_lvlPlan.setIndex();
-
-	//initialize the buffers
-	m_shadowMap.initialize();
-	m_heightMapMesh.initialize();
-	m_lvlPlan.initialize();
-
-	//set the direction of the light (from the vertex to the light)
-	m_lightDir=QVector3D(3.f, -3.f, 5.f);
-	m_lightDir.normalize();
-
-	//set the  matrix from the light's point of view to create the shadow map
-	m_shadowMapMatrix.ortho(-m_shadowMatrixSide, m_shadowMatrixSide, -m_shadowMatrixSide,
-		m_shadowMatrixSide, -m_shadowMatrixSide, m_shadowMatrixSide);
-	m_shadowMapMatrix.lookAt(
-		m_lightDir,
-		QVector3D(0.f, 0.f, 0.f),
-		QVector3D(0.f, 0.f, 1.f)
-		);
-	m_shadowMapMatrix.translate(-m_length/2, -m_width/2, 0.f);
-
-	//render the shadow map to the buffers of m_shadowMap
-	if(m_depthMapProgram->isLinked())
-		m_shadowMap.render(m_heightMapMesh, m_shadowMapMatrix, m_depthMapProgram);
+	//Programs, buffers, light and shadow map
+	m_renderer.initialize();
 
 	//set the projection matrix for the camera to display on the window
 	m_pMatrix.perspective(m_zoomAngle, 16.f / 9.f, 0.1f, m_width+m_length);
@@ -168,9 +119,6 @@ void RenderWindow::initializeGL()
 		QVector3D(0.f, 0.f, -40.f),
 		QVector3D(0.f, 0.f, 1.f)
 		);
-
-	//set the model matrix, place it in the center
-	m_mMatrix.translate(-m_length/2, -m_width/2, 0.f);
 }
 
 //------------------------------------------------------------------------------
@@ -180,82 +128,29 @@ void RenderWindow::paintGL()
 	//get the ratio of the size of one physical pixel to the size of one device independent pixels to set glViewport later
 	const qreal PIXEL_RATIO = devicePixelRatio();
 
-	//the model view matrix to calculate the projection matrix and the camera position
-	QMatrix4x4 mvMatrix(m_pMatrix * m_vMatrix);
-
-	//set the matrix used in the displaying programs
-	QMatrix4x4 mvpMatrix(mvMatrix * m_mMatrix);
-
-	//Calculate the position of the camera for m_displayProgram to calculate the specular component
-	QVector3D cameraPos(mvMatrix.inverted().column(3));
+	//Upload the chunks that are ready and render the shadow map again if needed
+	m_renderer.updateShadowMap();
 
 	//render to the sreen
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, defaultFramebufferObject());
 	glViewport(0, 0, width() * PIXEL_RATIO, height() * PIXEL_RATIO);
 
 	// Clear the screen
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	if(m_displayProgram->isLinked())
-	{
-		//use the display shader program
-		m_displayProgram->bind();
-
-		//Bind the shadow map texture in texture unit 0
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, m_shadowMap.getMapTexture());
-        m_displayProgram->setUniformValue(m_shadowMapTextureID, 0);
-
-		//send the matrixes to the display shader
-		m_displayProgram->setUniformValue(m_mvpMatrixID, mvpMatrix);
-		//position of the camera
-		m_displayProgram->setUniformValue(m_cameraPosID, cameraPos);
-		//matrix for the shadow
-		m_displayProgram->setUniformValue(m_shadowMapDisplayMatrixID, m_shadowMapMatrix);
-		//direction of the light, for the shadows, the difuse and the specular component
-		m_displayProgram->setUniformValue(m_lightDirID, m_lightDir);
-
-		//Render the height map
-		m_heightMapMesh.render();
-
-		m_displayProgram->release();
-	}
-
-	//Draw the lvl plan only if it has to be displayed
-	if (m_LvlPlanVisibility)
-	{
-
-		//Enable transparency
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		glEnable(GL_BLEND);
-
-		if(m_lvlProgram->isLinked())
-		{
-			//bind the program for the lvl Plan
-			m_lvlProgram->bind();
-
-			//send the matrix to the lvl plan display shader
-			m_lvlProgram->setUniformValue(m_mvpLvlPlanMatrixID, mvpMatrix);
-
-			//Render the lvl plan
-			m_lvlPlan.render();
+	m_renderer.renderScene(m_pMatrix * m_vMatrix);
 
-			m_lvlProgram->release();
-		}
-	}
+	//Keep the camera and the light of the displayed frame to replay them
+	if(m_isRecordingCameraPath)
+		m_cameraPath.addFrame({m_eyePos, m_renderer.getLightDir(), m_zoomAngle});
 }
 
 //------------------------------------------------------------------------------
 void RenderWindow::changeLvlPlanVisibility()
 //------------------------------------------------------------------------------
 {
-	//if m_LvlPlanVisibility is true, it becomes false
-	if(m_LvlPlanVisibility){
-		m_LvlPlanVisibility = false;
-	}
-	else {
-		m_LvlPlanVisibility = true;
-	}
+	//if the lvl plan is visible, it becomes hidden
+	m_renderer.setLvlPlanVisibility(!m_renderer.isLvlPlanVisible());
 }
 
 //------------------------------------------------------------------------------
@@ -270,14 +165,40 @@ void RenderWindow::saveCurrentRendering()
 	//Save the image
 	if(fileName.size())
 	{
-		//Make sure the scene is corectly rendered
-		paintGL();
+		const qreal PIXEL_RATIO = devicePixelRatio();
+
+		try
+		{
+			exportRendering(fileName, (unsigned int)(width() * PIXEL_RATIO),
+							(unsigned int)(height() * PIXEL_RATIO));
+		}
+		catch(std::exception const& e)
+		{
+			std::cerr << e.what() << std::endl;
+		}
+	}
+}
 
-		//get the rendering
-		QImage rendering(grabFramebuffer());
+//------------------------------------------------------------------------------
+void RenderWindow::exportRendering(QString const& fileName, unsigned int width, unsigned int height)
+//------------------------------------------------------------------------------
+{
+	makeCurrent();
 
-		rendering.save(fileName);
+	if(!m_exporter)
+	{
+		m_exporter.reset(new TiledExporter());
+		m_exporter->initialize();
 	}
+
+	//Same camera, with the aspect ratio of the image
+	QMatrix4x4 pMatrix;
+	pMatrix.perspective(m_zoomAngle, float(width) / float(height), 0.1f, m_width+m_length);
+
+	QImage rendering(m_exporter->render(m_renderer, pMatrix * m_vMatrix, width, height));
+
+	if(!rendering.save(fileName))
+		throw std::runtime_error("Cannot write the rendering " + fileName.toStdString());
 }
 
 //------------------------------------------------------------------------------
@@ -298,6 +219,94 @@ void RenderWindow::wheelEvent(QWheelEvent *wheelEvent)
 	}
 }
 
+//------------------------------------------------------------------------------
+void RenderWindow::mousePressEvent(QMouseEvent *event)
+//------------------------------------------------------------------------------
+{
+	m_hasPickedPixel = pickPixel(event->localPos(), m_pickedI, m_pickedJ);
+
+	//the viewshed shown follows the pixel clicked
+	if(m_renderer.isViewshedVisible())
+		updateViewshed();
+
+	updateTitle();
+}
+
+//------------------------------------------------------------------------------
+void RenderWindow::updateTitle()
+//------------------------------------------------------------------------------
+{
+	if(m_title.isEmpty())
+		m_title = title();
+
+	QString newTitle(m_title);
+
+	if(m_hasPickedPixel)
+	{
+		newTitle += QString(" - pixel (%1, %2): %3").arg(m_pickedI).arg(m_pickedJ)
+			.arg(double((*m_heightMap->getImageData())[m_pickedI][m_pickedJ]));
+	}
+
+	//The statistics are sorted in the background, the first steps of the plan may come before them
+	std::shared_ptr<const LevelStatistics> statistics(m_heightMap->getLevelStatistics());
+
+	if(m_renderer.isLvlPlanVisible() && statistics)
+	{
+		float level(m_renderer.getLvlPlanLevel());
+
+		newTitle += QString(" - level %1: %2% of the area above (%3 pixels), volume %4")
+			.arg(double(level), 0, 'f', 3)
+			.arg(100. * double(statistics->getAreaAbove(level)), 0, 'f', 1)
+			.arg(statistics->getPixelCountAbove(level))
+			.arg(statistics->getVolumeAbove(level), 0, 'f', 1);
+	}
+
+	setTitle(newTitle);
+}
+
+//------------------------------------------------------------------------------
+bool RenderWindow::pickPixel(QPointF const& position, unsigned int &i, unsigned int &j) const
+//------------------------------------------------------------------------------
+{
+	std::shared_ptr<const HeightFieldTracer> tracer(m_heightMap->getTracer());
+
+	if(!tracer || width() <= 0 || height() <= 0)
+		return false;
+
+	//the model matrix of HeightMapRenderer
+	QMatrix4x4 mMatrix;
+	mMatrix.translate(-m_length/2, -m_width/2, 0.f);
+
+	QMatrix4x4 inversePvmMatrix((m_pMatrix * m_vMatrix * mMatrix).inverted());
+
+	//the y axis of the window goes down
+	float ndcX(2.f * float(position.x()) / float(width()) - 1.f);
+	float ndcY(1.f - 2.f * float(position.y()) / float(height()));
+
+	QVector3D nearPoint((inversePvmMatrix * QVector4D(ndcX, ndcY, -1.f, 1.f)).toVector3DAffine());
+	QVector3D farPoint((inversePvmMatrix * QVector4D(ndcX, ndcY, 1.f, 1.f)).toVector3DAffine());
+
+	//the tracer works in the space of the grid, one unit between two pixels
+	float step(HeightMapMesh::getStep(m_heightMap->getN(), m_heightMap->getM()));
+	QVector3D origin(nearPoint / step);
+	QVector3D direction(farPoint - nearPoint);
+	float tMax(direction.length() / step);
+	direction.normalize();
+
+	float tHit;
+	QVector3D normal;
+
+	if(!tracer->intersect(origin, direction, 0.f, tMax, tHit, normal))
+		return false;
+
+	//the closest pixel to the point hit
+	QVector3D point(origin + direction * tHit);
+	i = (unsigned int)(std::min(std::max(point.x() + 0.5f, 0.f), float(tracer->getN() - 1)));
+	j = (unsigned int)(std::min(std::max(point.y() + 0.5f, 0.f), float(tracer->getM() - 1)));
+
+	return true;
+}
+
 //------------------------------------------------------------------------------
 void RenderWindow::keyPressEvent(QKeyEvent *event)
 //------------------------------------------------------------------------------
@@ -307,7 +316,8 @@ void RenderWindow::keyPressEvent(QKeyEvent *event)
 	case Qt::Key_F:
 	{
 		makeCurrent();
-		m_lvlPlan.changeHeight(-1.f);
+		m_renderer.changeLvlPlanHeight(-1.f);
+		updateTitle();
 		QCoreApplication::postEvent(this, new QEvent(QEvent::UpdateRequest));
 
 		break;
@@ -317,7 +327,8 @@ void RenderWindow::keyPressEvent(QKeyEvent *event)
 	case Qt::Key_R:
 	{
 		makeCurrent();
-		m_lvlPlan.changeHeight(1.f);
+		m_renderer.changeLvlPlanHeight(1.f);
+		updateTitle();
 		QCoreApplication::postEvent(this, new QEvent(QEvent::UpdateRequest));
 		break;
 	}
@@ -326,6 +337,7 @@ void RenderWindow::keyPressEvent(QKeyEvent *event)
 	case Qt::Key_Space:
 	{
 		changeLvlPlanVisibility();
+		updateTitle();
 		QCoreApplication::postEvent(this, new QEvent(QEvent::UpdateRequest));
 		break;
 	}
@@ -379,18 +391,20 @@ void RenderWindow::keyPressEvent(QKeyEvent *event)
 
 	case Qt::Key_Up:
 	{
+		QVector3D lightDir(m_renderer.getLightDir());
 		QVector3D vertical(QVector3D(0, 0, 1));
-		QVector3D axis(QVector3D::crossProduct(m_lightDir, vertical));
-		if((axis.length() > 0.1) || (QVector3D::dotProduct(m_lightDir, vertical) < 0))
+		QVector3D axis(QVector3D::crossProduct(lightDir, vertical));
+		if((axis.length() > 0.1) || (QVector3D::dotProduct(lightDir, vertical) < 0))
 			rotateLightSource(2, axis.x(), axis.y(), axis.z());
 		break;
 	}
 
 	case Qt::Key_Down:
 	{
+		QVector3D lightDir(m_renderer.getLightDir());
 		QVector3D vertical(QVector3D(0, 0, 1));
-		QVector3D axis(QVector3D::crossProduct(m_lightDir, vertical));
-		if((axis.length() > 0.1) || (QVector3D::dotProduct(m_lightDir, vertical) > 0))
+		QVector3D axis(QVector3D::crossProduct(lightDir, vertical));
+		if((axis.length() > 0.1) || (QVector3D::dotProduct(lightDir, vertical) > 0))
 			rotateLightSource(-2, axis.x(), axis.y(), axis.z());
 		break;
 	}
@@ -402,6 +416,47 @@ void RenderWindow::keyPressEvent(QKeyEvent *event)
 		break;
 	}
 
+	//H switches between the depth map shadows and the shadows computed on the CPU
+	case Qt::Key_H:
+	{
+		makeCurrent();
+		m_renderer.setShadowMode(m_renderer.getShadowMode() == HeightMapRenderer::HORIZON_SHADOWS ?
+			HeightMapRenderer::DEPTH_MAP_SHADOWS : HeightMapRenderer::HORIZON_SHADOWS);
+		QCoreApplication::postEvent(this, new QEvent(QEvent::UpdateRequest));
+		break;
+	}
+
+	//C changes the colours of the heights
+	case Qt::Key_C:
+	{
+		makeCurrent();
+		m_renderer.setPalette(ColourRamp::Palette((m_renderer.getPalette() + 1) % ColourRamp::PALETTE_COUNT));
+		QCoreApplication::postEvent(this, new QEvent(QEvent::UpdateRequest));
+		break;
+	}
+
+	//N switches between the normal map of the full resolution and the normals of the meshes
+	case Qt::Key_N:
+	{
+		m_renderer.setNormalMapUse(!m_renderer.isNormalMapUsed());
+		QCoreApplication::postEvent(this, new QEvent(QEvent::UpdateRequest));
+		break;
+	}
+
+	//V shows or hides the viewshed of the last pixel clicked
+	case Qt::Key_V:
+	{
+		toggleViewshed();
+		break;
+	}
+
+	//P starts or stops recording the camera path
+	case Qt::Key_P:
+	{
+		toggleCameraPathRecording();
+		break;
+	}
+
 	default:
 		return;
 	}
@@ -437,27 +492,92 @@ void RenderWindow::rotateLightSource(const float angle, const float x, const flo
 	QMatrix4x4 tempMat;
 	tempMat.setToIdentity();
 	tempMat.rotate(angle, x, y, z);
-	QVector4D lightDir(tempMat * (m_lightDir.toVector4D()));
-	m_lightDir = lightDir.toVector3D();
-
-	//Rebuild the shadow map matrix
-	m_shadowMapMatrix.setToIdentity();
-	m_shadowMapMatrix.ortho(-m_shadowMatrixSide, m_shadowMatrixSide, -m_shadowMatrixSide,
-		m_shadowMatrixSide, -m_shadowMatrixSide, m_shadowMatrixSide);
-	m_shadowMapMatrix.lookAt(
-		m_lightDir,
-		QVector3D(0.f, 0.f, 0.f),
-		QVector3D(0.f, 0.f, 1.f)
-	);
-	m_shadowMapMatrix.translate(-m_length/2, -m_width/2, 0.f);
+	QVector4D lightDir(tempMat * (m_renderer.getLightDir().toVector4D()));
+
+	//rebuild the shadow map matrix and render the shadow map
+	makeCurrent();
+
+	m_renderer.setLightDir(lightDir.toVector3D());
 
-	//render the shadow map to the buffers of m_shadowMap
+	QCoreApplication::postEvent(this, new QEvent(QEvent::UpdateRequest));
+}
+
+//------------------------------------------------------------------------------
+void RenderWindow::toggleViewshed()
+//------------------------------------------------------------------------------
+{
+	if(m_renderer.isViewshedVisible())
+	{
+		makeCurrent();
+		m_renderer.clearViewshed();
+
+		QCoreApplication::postEvent(this, new QEvent(QEvent::UpdateRequest));
+	}
+	else
+	{
+		updateViewshed();
+	}
+}
+
+//------------------------------------------------------------------------------
+void RenderWindow::updateViewshed()
+//------------------------------------------------------------------------------
+{
 	makeCurrent();
 
-	if(m_depthMapProgram->isLinked())
+	if(!m_hasPickedPixel)
+	{
+		m_renderer.clearViewshed();
+	}
+	else
 	{
-		m_shadowMap.render(m_heightMapMesh, m_shadowMapMatrix, m_depthMapProgram);
+		unsigned int n(m_heightMap->getN()), m(m_heightMap->getM());
+
+		try
+		{
+			m_renderer.setViewshed(Viewshed::compute(*m_heightMap->getImageData(), n, m,
+				m_pickedI, m_pickedJ, VIEWSHED_OBSERVER_HEIGHT, HeightMapMesh::getHeightScale(n, m)));
+		}
+		catch(std::exception const& e)
+		{
+			std::cerr << e.what() << std::endl;
+		}
 	}
 
 	QCoreApplication::postEvent(this, new QEvent(QEvent::UpdateRequest));
 }
+
+//------------------------------------------------------------------------------
+void RenderWindow::toggleCameraPathRecording()
+//------------------------------------------------------------------------------
+{
+	if(!m_isRecordingCameraPath)
+	{
+		m_cameraPath.clear();
+		m_isRecordingCameraPath = true;
+
+		//record the current frame as the first one
+		QCoreApplication::postEvent(this, new QEvent(QEvent::UpdateRequest));
+	}
+	else
+	{
+		m_isRecordingCameraPath = false;
+
+		//Chose the name and directory of the file
+		QString fileName = QFileDialog::getSaveFileName(nullptr, "Save camera path",
+								   "",
+								   "Camera paths (*.path)");
+
+		if(fileName.size())
+		{
+			try
+			{
+				m_cameraPath.save(fileName.toStdString());
+			}
+			catch(std::exception const& e)
+			{
+				std::cerr << e.what() << std::endl;
+			}
+		}
+	}
+}
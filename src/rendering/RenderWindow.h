@@ -28,10 +28,12 @@
 #include <memory>
 #include <vector>
 #include <QKeyEvent>
+#include <QMouseEvent>
 
-#include "HeightMapMesh.h"
-#include "DepthMap.h"
-#include "LvlPlan.h"
+#include "ChunkedHeightMap.h"
+#include "HeightMapRenderer.h"
+#include "CameraPath.h"
+#include "TiledExporter.h"
 
 //==============================================================================
 /**
@@ -50,14 +52,16 @@ public:
 	RenderWindow(std::string const& fileName);
 
 	/**
-	 * @brief RenderWindow Overloaded constructor with the image size and data
-	 * @param imageData the data of the image as floats in the [0,1] range
+	 * @brief RenderWindow Overloaded constructor with the image size and data.
+	 * Only a decimated preview is created here,
+	 * the full resolution mesh is created in the background and displayed chunk by chunk
+	 * @param imageData the data of the image as floats in the [0,1] range, shared without copy
 	 * @param n height of the image
 	 * @param m width of the image
-	 * @param useIndex to know if an index has to be set for the height map mesh
+	 * @param meshMode how the vertices of the height map are given to OpenGL
 	 */
-	RenderWindow(const Types::float_matrix &imageData,
-				 unsigned int n, unsigned int m, bool useIndex = true);
+	RenderWindow(Types::shared_matrix const& imageData, unsigned int n, unsigned int m,
+				 ChunkedHeightMap::MeshMode meshMode = ChunkedHeightMap::INDEXED);
 
 	/**
 	 * @brief ~RenderWindow call makeCurrent() to make sure children objects
@@ -66,12 +70,14 @@ public:
 	virtual ~RenderWindow();
 
 	/**
-	 * @brief initializeGL Initialize programs and buffers
+	 * @brief initializeGL Initialize the renderer and the camera.
+	 * Programs and height maps are shared with the other windows through GLResourceCache
 	 */
 	virtual void initializeGL();
 
 	/**
-	 * @brief paintGL display on the window
+	 * @brief paintGL display on the window.
+	 * Upload the full resolution chunks that are ready first
 	 */
 	virtual void paintGL();
 
@@ -83,9 +89,20 @@ public:
 
 	/**
 	 * @brief saveCurrentRendering  Open a dialog to select a directory and save the current rendering
+	 * at the size of the window
 	 */
 	void saveCurrentRendering();
 
+	/**
+	 * @brief exportRendering render the current view offscreen, tile by tile, and save it.
+	 * The window does not need to be visible, but initializeGL() has to have been called
+	 * @param fileName the name of the image file
+	 * @param width width of the image, may exceed the size of the screen
+	 * @param height height of the image
+	 * @throws std::runtime_error if the image cannot be rendered or saved
+	 */
+	void exportRendering(QString const& fileName, unsigned int width, unsigned int height);
+
 //******************************************************************************
 private:
 	//No copy constructor
@@ -100,13 +117,38 @@ private:
 	 */
 	void wheelEvent(QWheelEvent *wheelEvent);
 
+	/**
+	 * @brief updateTitle show in the title the last pixel clicked and, if the lvl plan is visible,
+	 * the area and the volume above it
+	 */
+	void updateTitle();
+
+	/**
+	 * @brief mousePressEvent show the pixel under the cursor and its value in the title
+	 * @param event
+	 */
+	void mousePressEvent(QMouseEvent *event);
+
+	/**
+	 * @brief pickPixel trace a ray from the camera through a point of the window
+	 * @param position the point, in device independent pixels
+	 * @param[out] i row of the pixel hit
+	 * @param[out] j column of the pixel hit
+	 * @return true if the height map is hit, false if the sky is picked
+	 * or if the tracer is not built yet
+	 */
+	bool pickPixel(QPointF const& position, unsigned int &i, unsigned int &j) const;
+
 	/**
 	 * @brief keyPressEvent event to control the display
 	 * rotation of the camera thanks to Z, Q, S, D,
 	 * Enable/disable lvl plan display: spacebarre
 	 * change the height of the lvl plan: R and F
 	 * Rotation of the light source: arrows
+	 * Switch between the depth map and the CPU shadows: H
 	 * Save the current rendering: W
+	 * Start or stop recording the camera path: P
+	 * Show or hide the viewshed of the last pixel clicked: V
 	 * @param event
 	 */
 	void keyPressEvent(QKeyEvent *event);
@@ -131,48 +173,57 @@ private:
 	void rotateLightSource(float const angle, float const x, float const y,
 						   float const z);
 
+	/**
+	 * @brief toggleViewshed colour the pixels seen from the last pixel clicked,
+	 * or stop colouring them
+	 */
+	void toggleViewshed();
+
+	/**
+	 * @brief updateViewshed colour the pixels seen from the last pixel clicked,
+	 * or stop colouring them if the sky has been clicked
+	 */
+	void updateViewshed();
 
-	//Height map to display
-	HeightMapMesh m_heightMapMesh;
+	/**
+	 * @brief toggleCameraPathRecording start recording the camera and the light of each frame,
+	 * or stop and open a dialog to save the recorded path
+	 */
+	void toggleCameraPathRecording();
 
-	//lvl plan to display if needed
-	LvlPlan m_lvlPlan;
 
-	//IDs for inputs in the ground display program
-	GLuint m_lightDirID, //ID of the light direction vector (from the vertex to the light)
-		m_mvpMatrixID, //ID of the Model view position matrix
-		m_cameraPosID, //ID of the position of the camera
-		m_shadowMapDisplayMatrixID, //ID of the projection matrix of the shadow map
-		m_shadowMapTextureID; //ID of the texture of the shadow map
+	//Height map to display, refined progressively. Shared with the windows displaying the same data
+	std::shared_ptr<ChunkedHeightMap> m_heightMap;
 
-	//IDs for inputs in the lvl plan display program
-	GLuint m_verticesLvlPlanPositionID,//ID of the position of the vertex
-		m_mvpLvlPlanMatrixID;//ID of the Model view position matrix
+	//Render the height map, its shadows and the lvl plan for the camera of the window
+	HeightMapRenderer m_renderer;
 
+	//frames recorded since the recording started
+	CameraPath m_cameraPath;
 
-	std::unique_ptr<QOpenGLShaderProgram> m_displayProgram, // The render program displaying on the screen
-		m_lvlProgram, //Program to display the lvl plan
-		m_depthMapProgram;//the program to create the shadow map
+	//render the exported images, created with the first export
+	std::unique_ptr<TiledExporter> m_exporter;
 
-	DepthMap m_shadowMap; //object containing buffers and program to create the shadow map
+	//title given to the window, before the picked pixel and the lvl plan are added to it
+	QString m_title;
 
-	unsigned int m_dataCount; //number of vertices
+	unsigned int m_pickedI, //row of the last pixel clicked
+		m_pickedJ; //column of the last pixel clicked
 
-	QVector3D m_lightDir;//the direction of the light (from the vertex to the light)
 	QVector3D m_eyePos;//the position of the camera
 
-	QMatrix4x4 m_shadowMapMatrix,	//the  matrix from the light's point of view to create the shadow map
-		m_pMatrix, //the projection matrix for the camera to display on the window
-		m_vMatrix, //the view matrix
-		m_mMatrix; //the model matrix
+	QMatrix4x4 m_pMatrix, //the projection matrix for the camera to display on the window
+		m_vMatrix; //the view matrix
 
 	float m_length, //length of the model
 		m_width, //width of the model
-		m_shadowMatrixSide, //size of the cube that the shadow map take into account
 		m_zoomAngle; //Angle for the view matrix
 
-	bool m_LvlPlanVisibility, //to chose if the lvl plan has to be displayed
-		m_useIndex; //to know if an index has to be set for the height map mash
+	//how the vertices of the height map are given to OpenGL
+	ChunkedHeightMap::MeshMode m_meshMode;
+
+	bool m_isRecordingCameraPath, //to know if the frames have to be added to m_cameraPath
+		m_hasPickedPixel; //to know if a pixel has been clicked
 };
 
 #endif //RENDERWINDOW_H
@@ -0,0 +1,305 @@
+/**
+*******************************************************************************
+*
+*  @file       SequenceExporter.cpp
+*
+*  @brief      Class to render the frames of a camera path offscreen and save them,
+*				with the readback and the encoding overlapping the rendering
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//	Include
+//******************************************************************************
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <QString>
+
+#include "SequenceExporter.h"
+#include "tools/Instrumentation.h"
+
+//******************************************************************************
+//  constant variables
+//******************************************************************************
+//bytes of a pixel read back, RGBA
+const unsigned int PIXEL_BYTES = 4;
+
+//Wait for a fence by steps of 1 s, without flushing again
+const GLuint64 FENCE_TIMEOUT_NS = 1000000000;
+
+//images waiting for the encoders, per encoder
+const size_t QUEUED_IMAGES_PER_ENCODER = 2;
+
+//------------------------------------------------------------------------------
+SequenceExporter::SequenceExporter(unsigned int ringSize, unsigned int encoderCount):
+//------------------------------------------------------------------------------
+	m_encoderCount(encoderCount ? encoderCount :
+		std::max(std::thread::hardware_concurrency(), 2u) - 1),
+	m_frameBuffer(),
+	m_pixelBuffers(std::max(ringSize, 1u), 0),
+	m_fences(std::max(ringSize, 1u), nullptr),
+	m_pixelBufferSize(0),
+	m_jobs(),
+	m_jobsMutex(),
+	m_jobsChanged(),
+	m_isQueueClosed(false),
+	m_failedFiles()
+//------------------------------------------------------------------------------
+{
+}
+
+//------------------------------------------------------------------------------
+SequenceExporter::~SequenceExporter()
+//------------------------------------------------------------------------------
+{
+	for(GLsync fence : m_fences)
+	{
+		if(fence)
+			glDeleteSync(fence);
+	}
+
+	if(m_pixelBuffers[0])
+		glDeleteBuffers(GLsizei(m_pixelBuffers.size()), m_pixelBuffers.data());
+}
+
+//------------------------------------------------------------------------------
+void SequenceExporter::initialize()
+//------------------------------------------------------------------------------
+{
+	initializeOpenGLFunctions();
+
+	glGenBuffers(GLsizei(m_pixelBuffers.size()), m_pixelBuffers.data());
+}
+
+//------------------------------------------------------------------------------
+void SequenceExporter::render(HeightMapRenderer &renderer, CameraPath const& path,
+							  unsigned int width, unsigned int height, std::string const& outputFile)
+//------------------------------------------------------------------------------
+{
+	ScopedTimer timer("SequenceExporter::render");
+
+	std::vector<CameraPath::Frame> const& frames(path.getFrames());
+	size_t ringSize(m_pixelBuffers.size());
+
+	if(frames.empty())
+		return;
+
+	if(!m_frameBuffer || (unsigned int)(m_frameBuffer->size().width()) != width ||
+			(unsigned int)(m_frameBuffer->size().height()) != height)
+	{
+		m_frameBuffer.reset(new QOpenGLFramebufferObject(width, height, QOpenGLFramebufferObject::Depth));
+	}
+
+	if(!m_frameBuffer->isValid())
+		throw std::runtime_error("Cannot create a framebuffer of this size, export the frames as tiles");
+
+	//The meshes have to be up to date before the first frame
+	renderer.updateShadowMap();
+
+	GLsizeiptr frameBytes(GLsizeiptr(width) * height * PIXEL_BYTES);
+
+	if(frameBytes > m_pixelBufferSize)
+	{
+		for(GLuint pixelBuffer : m_pixelBuffers)
+		{
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffer);
+			glBufferData(GL_PIXEL_PACK_BUFFER, frameBytes, nullptr, GL_STREAM_READ);
+		}
+
+		m_pixelBufferSize = frameBytes;
+	}
+
+	//The encoders wait for the images of the frames
+	m_isQueueClosed = false;
+	m_failedFiles.clear();
+
+	std::vector<std::thread> encoders;
+
+	for(unsigned int encoder(0); encoder < m_encoderCount; encoder++)
+		encoders.emplace_back(&SequenceExporter::encode, this);
+
+	auto stopEncoders = [this, &encoders]()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_jobsMutex);
+				m_isQueueClosed = true;
+			}
+
+			m_jobsChanged.notify_all();
+
+			for(std::thread &encoder : encoders)
+				encoder.join();
+		};
+
+	try
+	{
+		glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+		for(size_t frameIndex(0); frameIndex < frames.size(); frameIndex++)
+		{
+			unsigned int slot((unsigned int)(frameIndex % ringSize));
+
+			//The ring is full: the oldest frame is read before its pixel buffer is reused.
+			//It has been rendered ringSize frames ago, the GPU is usually done with it
+			if(frameIndex >= ringSize)
+				readFrame(slot, width, height, getFrameFileName(outputFile, frameIndex - ringSize));
+
+			CameraPath::Frame const& frame(frames[frameIndex]);
+
+			QMatrix4x4 pMatrix, vMatrix;
+			pMatrix.perspective(frame.zoomAngle, float(width) / float(height),
+								0.1f, renderer.getWidth() + renderer.getLength());
+			vMatrix.lookAt(frame.eyePos, QVector3D(0.f, 0.f, -40.f), QVector3D(0.f, 0.f, 1.f));
+
+			renderer.setLightDir(frame.lightDir.normalized());
+
+			m_frameBuffer->bind();
+			glViewport(0, 0, width, height);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+			renderer.renderScene(pMatrix * vMatrix);
+
+			//Start the transfer without waiting, the fence tells when it is done
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pixelBuffers[slot]);
+			glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			m_fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+
+		//the frames still in the ring
+		for(size_t frameIndex(frames.size() > ringSize ? frames.size() - ringSize : 0);
+			frameIndex < frames.size(); frameIndex++)
+		{
+			readFrame((unsigned int)(frameIndex % ringSize), width, height,
+					  getFrameFileName(outputFile, frameIndex));
+		}
+	}
+	catch(...)
+	{
+		stopEncoders();
+		throw;
+	}
+
+	stopEncoders();
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	m_frameBuffer->release();
+
+	if(!m_failedFiles.empty())
+		throw std::runtime_error("Cannot write the image " + m_failedFiles.front());
+}
+
+//------------------------------------------------------------------------------
+std::string SequenceExporter::getFrameFileName(std::string const& outputFile, size_t frame)
+//------------------------------------------------------------------------------
+{
+	std::ostringstream number;
+	number.width(4);
+	number.fill('0');
+	number << frame;
+
+	size_t extension(outputFile.rfind('.'));
+
+	if(extension == std::string::npos)
+		return outputFile + "_" + number.str();
+
+	return outputFile.substr(0, extension) + "_" + number.str() + outputFile.substr(extension);
+}
+
+//------------------------------------------------------------------------------
+void SequenceExporter::readFrame(unsigned int slot, unsigned int width, unsigned int height,
+								 std::string const& fileName)
+//------------------------------------------------------------------------------
+{
+	ScopedTimer timer("SequenceExporter::readFrame");
+
+	GLsync &fence(m_fences[slot]);
+	GLenum status(GL_TIMEOUT_EXPIRED);
+
+	//Only the first wait flushes the commands
+	for(GLbitfield flags(GL_SYNC_FLUSH_COMMANDS_BIT); status == GL_TIMEOUT_EXPIRED; flags = 0)
+		status = glClientWaitSync(fence, flags, FENCE_TIMEOUT_NS);
+
+	glDeleteSync(fence);
+	fence = nullptr;
+
+	if(status == GL_WAIT_FAILED)
+		throw std::runtime_error("Cannot wait for the frame " + fileName);
+
+	//The alpha of the framebuffer is not meaningful, the images are opaque
+	QImage image(int(width), int(height), QImage::Format_RGBX8888);
+	size_t rowBytes(size_t(width) * PIXEL_BYTES);
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pixelBuffers[slot]);
+	uchar const* pixels(static_cast<uchar const*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+		GLsizeiptr(rowBytes * height), GL_MAP_READ_BIT)));
+
+	if(!pixels)
+		throw std::runtime_error("Cannot map the pixel buffer of the frame " + fileName);
+
+	//The rows of OpenGL go from the bottom to the top
+	for(unsigned int row(0); row < height; row++)
+		std::memcpy(image.scanLine(int(height - 1 - row)), pixels + row * rowBytes, rowBytes);
+
+	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+
+	queueJob({std::move(image), fileName});
+}
+
+//------------------------------------------------------------------------------
+void SequenceExporter::queueJob(EncodingJob &&job)
+//------------------------------------------------------------------------------
+{
+	{
+		std::unique_lock<std::mutex> lock(m_jobsMutex);
+
+		//the rendering waits for the encoders rather than keeping every image
+		m_jobsChanged.wait(lock, [this]()
+			{
+				return m_jobs.size() < QUEUED_IMAGES_PER_ENCODER * m_encoderCount;
+			});
+
+		m_jobs.push_back(std::move(job));
+	}
+
+	m_jobsChanged.notify_all();
+}
+
+//------------------------------------------------------------------------------
+void SequenceExporter::encode()
+//------------------------------------------------------------------------------
+{
+	for(;;)
+	{
+		EncodingJob job;
+
+		{
+			std::unique_lock<std::mutex> lock(m_jobsMutex);
+
+			m_jobsChanged.wait(lock, [this]()
+				{
+					return !m_jobs.empty() || m_isQueueClosed;
+				});
+
+			//closed and empty
+			if(m_jobs.empty())
+				return;
+
+			job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+		}
+
+		m_jobsChanged.notify_all();
+
+		ScopedTimer timer("SequenceExporter::encode");
+
+		if(!job.image.save(QString::fromStdString(job.fileName)))
+		{
+			std::lock_guard<std::mutex> lock(m_jobsMutex);
+			m_failedFiles.push_back(job.fileName);
+		}
+	}
+}
@@ -0,0 +1,150 @@
+#ifndef SEQUENCEEXPORTER_H
+#define SEQUENCEEXPORTER_H
+
+/**
+*******************************************************************************
+*
+*  @file       SequenceExporter.h
+*
+*  @brief      Class to render the frames of a camera path offscreen and save them,
+*				with the readback and the encoding overlapping the rendering
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLFramebufferObject>
+#include <QImage>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "HeightMapRenderer.h"
+#include "CameraPath.h"
+
+//==============================================================================
+/**
+*  @class  SequenceExporter
+*  @brief  SequenceExporter is a class to save an animation, one image per frame
+*			of a camera path, without synchronizing the CPU with the GPU at each frame.
+*			Each frame is read into the next pixel buffer of a ring and a fence is inserted.
+*			A pixel buffer is only mapped when the ring comes back to it, once
+*			the GPU is done with it, and the image is handed to worker threads
+*			that encode and write the files.
+*/
+//==============================================================================
+class SequenceExporter: protected QOpenGLExtraFunctions
+{
+public:
+	/**
+	 * @brief SequenceExporter constructor
+	 * @param ringSize number of frames in flight between the rendering and the readback
+	 * @param encoderCount number of threads encoding the images, one per core but one if 0
+	 */
+	SequenceExporter(unsigned int ringSize = 3, unsigned int encoderCount = 0);
+
+	/**
+	 * @brief ~SequenceExporter delete the pixel buffers and the fences.
+	 * The context used by initialize() has to be current
+	 */
+	~SequenceExporter();
+
+	/**
+	 * @brief initialize Initialize the pixel buffers.
+	 * An OpenGL 3.2 context has to be current
+	 */
+	void initialize();
+
+	/**
+	 * @brief render Render each frame of the path and save it.
+	 * Returns once all the images are written.
+	 * Changes the light of the renderer, the bound framebuffer,
+	 * the pixel pack buffer and the viewport
+	 * @param renderer the renderer of the height map, initialized in the current context
+	 * @param path the camera and the light of each frame
+	 * @param width width of the images, at most GL_MAX_RENDERBUFFER_SIZE
+	 * @param height height of the images, at most GL_MAX_RENDERBUFFER_SIZE
+	 * @param outputFile the name of the images, numbered by getFrameFileName
+	 * @throws std::runtime_error if the framebuffer cannot be created or if a frame cannot be read or saved
+	 */
+	void render(HeightMapRenderer &renderer, CameraPath const& path,
+				unsigned int width, unsigned int height, std::string const& outputFile);
+
+	/**
+	 * @brief getFrameFileName number the image of a frame
+	 * @param outputFile the name of the output, the number is inserted before the extension
+	 * @param frame the index of the frame
+	 * @return the name of the image, outputFile_0042.png for example
+	 */
+	static std::string getFrameFileName(std::string const& outputFile, size_t frame);
+
+//******************************************************************************
+private:
+	//No copy constructor
+	SequenceExporter(SequenceExporter const&);
+
+	///@cond
+	/**
+	 * @brief The EncodingJob struct an image to write
+	 */
+	struct EncodingJob
+	{
+		QImage image;
+		std::string fileName;
+	};
+	///@endcond
+
+	/**
+	 * @brief readFrame wait for the fence of a pixel buffer, copy its frame
+	 * into an image and queue the image for the encoders
+	 * @param slot the index of the pixel buffer in the ring
+	 * @param width width of the frame
+	 * @param height height of the frame
+	 * @param fileName the name of the image
+	 * @throws std::runtime_error if the pixel buffer cannot be mapped
+	 */
+	void readFrame(unsigned int slot, unsigned int width, unsigned int height,
+				   std::string const& fileName);
+
+	/**
+	 * @brief encode write the queued images until the queue is closed and empty
+	 */
+	void encode();
+
+	/**
+	 * @brief queueJob wait for room in the queue and add an image to write
+	 * @param job the image and its name
+	 */
+	void queueJob(EncodingJob &&job);
+
+	unsigned int m_encoderCount;
+
+	//the frame rendered, with a depth buffer
+	std::unique_ptr<QOpenGLFramebufferObject> m_frameBuffer;
+
+	//ring of pixel buffers, with the fence of the last read into each one
+	std::vector<GLuint> m_pixelBuffers;
+	std::vector<GLsync> m_fences;
+
+	//capacity of each pixel buffer, in bytes
+	GLsizeiptr m_pixelBufferSize;
+
+	//images waiting for the encoders, bounded to limit the memory used
+	std::deque<EncodingJob> m_jobs;
+	std::mutex m_jobsMutex;
+	std::condition_variable m_jobsChanged;
+	bool m_isQueueClosed;
+
+	//names of the images that could not be written
+	std::vector<std::string> m_failedFiles;
+};
+
+#endif // SEQUENCEEXPORTER_H
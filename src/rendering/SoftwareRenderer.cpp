@@ -0,0 +1,214 @@
+/**
+*******************************************************************************
+*
+*  @file       SoftwareRenderer.cpp
+*
+*  @brief      Class to render a height map on the CPU, without OpenGL,
+*				with the shading of the display shader
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <math.h>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <QVector4D>
+
+#include "SoftwareRenderer.h"
+#include "HeightMapMesh.h"
+#include "ColourRamp.h"
+#include "tools/ParallelTool.h"
+#include "tools/Instrumentation.h"
+
+//******************************************************************************
+//  constant variables
+//******************************************************************************
+//Blocks of rows spread over the image, so that every thread gets some sky and some terrain
+const unsigned int ROW_BLOCK_COUNT = 64;
+
+//Distance between a point and the origin of its shadow ray, to avoid the shadow acne
+const float SHADOW_OFFSET = 1e-2f;
+
+//------------------------------------------------------------------------------
+SoftwareRenderer::SoftwareRenderer(Types::shared_matrix const& heights, unsigned int n, unsigned int m):
+//------------------------------------------------------------------------------
+	m_heights(heights),
+	m_ambientOcclusion(),
+	m_n(n),
+	m_m(m),
+	m_step(HeightMapMesh::getStep(n, m)),
+	m_heightScale(HeightMapMesh::getHeightScale(n, m)),
+	m_tracer(heights, n, m, m_heightScale),
+	m_mMatrix()
+//------------------------------------------------------------------------------
+{
+	m_mMatrix.translate(-getLength()/2, -getWidth()/2, 0.f);
+}
+
+//------------------------------------------------------------------------------
+void SoftwareRenderer::setAmbientOcclusion(Types::shared_matrix const& ambientOcclusion)
+//------------------------------------------------------------------------------
+{
+	if(ambientOcclusion && (ambientOcclusion->size() != m_n || (*ambientOcclusion)[0].size() != m_m))
+		throw std::runtime_error("Wrong data, the ambient occlusion does not match the height map");
+
+	m_ambientOcclusion = ambientOcclusion;
+}
+
+//------------------------------------------------------------------------------
+QImage SoftwareRenderer::render(unsigned int width, unsigned int height,
+								QMatrix4x4 const& pvMatrix, QVector3D const& lightDir) const
+//------------------------------------------------------------------------------
+{
+	ScopedTimer timer("SoftwareRenderer::render");
+
+	QImage image(int(width), int(height), QImage::Format_RGB32);
+
+	if(!width || !height)
+		return image;
+
+	//the rays are cast from the near plane to the far plane, in the space of the mesh
+	QMatrix4x4 inversePvmMatrix((pvMatrix * m_mMatrix).inverted());
+
+	//same position as the one given to the display shader
+	QVector3D cameraPos(pvMatrix.inverted().column(3));
+
+	//The threads write in different rows, the image must not be detached by them
+	uchar *bits(image.bits());
+	int bytesPerLine(image.bytesPerLine());
+	unsigned int blockCount(std::min(height, ROW_BLOCK_COUNT));
+
+	ParallelTool::performInParallel(
+		[&](unsigned int leftIndex, unsigned int rightIndex)
+		{
+			renderRows(bits, bytesPerLine, width, height, blockCount, inversePvmMatrix,
+					   cameraPos, lightDir.normalized(), leftIndex, rightIndex);
+		},
+		0, blockCount);
+
+	return image;
+}
+
+//------------------------------------------------------------------------------
+void SoftwareRenderer::renderRows(uchar *bits, int bytesPerLine, unsigned int width, unsigned int height,
+								  unsigned int blockCount, QMatrix4x4 const& inversePvmMatrix,
+								  QVector3D const& cameraPos, QVector3D const& lightDir,
+								  unsigned int leftIndex, unsigned int rightIndex) const
+//------------------------------------------------------------------------------
+{
+	for(unsigned int block(leftIndex); block < rightIndex; block++)
+	{
+		for(unsigned int row(block); row < height; row += blockCount)
+		{
+			QRgb *line(reinterpret_cast<QRgb*>(bits + (long long)(row) * bytesPerLine));
+
+			//the first row of the image is the top of the screen
+			float ndcY(1.f - 2.f * (float(row) + 0.5f) / float(height));
+
+			for(unsigned int column(0); column < width; column++)
+			{
+				float ndcX(2.f * (float(column) + 0.5f) / float(width) - 1.f);
+
+				QVector3D nearPoint((inversePvmMatrix * QVector4D(ndcX, ndcY, -1.f, 1.f)).toVector3DAffine());
+				QVector3D farPoint((inversePvmMatrix * QVector4D(ndcX, ndcY, 1.f, 1.f)).toVector3DAffine());
+
+				//the grid space is the space of the mesh scaled by the distance between two vertices
+				QVector3D origin(nearPoint / m_step);
+				QVector3D direction(farPoint - nearPoint);
+				float tMax(direction.length() / m_step);
+				direction.normalize();
+
+				float tHit;
+				QVector3D normal;
+
+				if(m_tracer.intersect(origin, direction, 0.f, tMax, tHit, normal))
+					line[column] = shade(origin + direction * tHit, normal, cameraPos, lightDir);
+				else
+					line[column] = qRgb(0, 0, 0);
+			}
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+QRgb SoftwareRenderer::shade(QVector3D const& point, QVector3D const& normal,
+							 QVector3D const& cameraPos, QVector3D const& lightDir) const
+//------------------------------------------------------------------------------
+{
+	//the colour of the height, as the default colour ramp of the display shader
+	float pixelHeight(point.z() / m_heightScale);
+	QVector3D colour(ColourRamp::getColour(ColourRamp::RED_BLUE, pixelHeight));
+
+	float cosLightNormal(std::max(0.f, QVector3D::dotProduct(lightDir, normal)));
+	float skyVisibility(getSkyVisibility(point.x(), point.y()));
+
+	//Under this cosinus the diffuse light is 0, the shadow does not matter
+	float shadow(0.f);
+
+	if(cosLightNormal > 0.1f)
+	{
+		shadow = m_tracer.isOccluded(point + normal * SHADOW_OFFSET, lightDir,
+									 std::numeric_limits<float>::infinity()) ? 0.f : 1.f;
+	}
+
+	float visibility(shadow * std::min(std::max(cosLightNormal - 0.1f, 0.f), 1.f) * 0.7f +
+					 0.3f * skyVisibility);
+
+	//reflect(lightDir, normal) in the shader
+	QVector3D eyeDir((point * m_step - cameraPos).normalized());
+	QVector3D reflected(lightDir - 2.f * QVector3D::dotProduct(normal, lightDir) * normal);
+	float specular(0.5f * powf(std::min(std::max(
+		QVector3D::dotProduct(eyeDir, reflected), 0.f), 1.f), 4.f));
+
+	if(visibility <= 0.3f)
+		specular *= 0.2f;
+
+	QVector3D pixel(visibility * (colour * (cosLightNormal + 0.2f * skyVisibility) +
+								  QVector3D(specular, specular, specular)));
+
+	auto toByte = [](float value)
+		{
+			return int(std::min(std::max(value, 0.f), 1.f) * 255.f + 0.5f);
+		};
+
+	return qRgb(toByte(pixel.x()), toByte(pixel.y()), toByte(pixel.z()));
+}
+
+//------------------------------------------------------------------------------
+float SoftwareRenderer::getSkyVisibility(float x, float y) const
+//------------------------------------------------------------------------------
+{
+	if(!m_ambientOcclusion)
+		return 1.f;
+
+	Types::float_matrix const& ambientOcclusion(*m_ambientOcclusion);
+
+	//bilinear interpolation between the four pixels around the point, as the texture sampling
+	unsigned int i((unsigned int)(std::min(std::max(floorf(x), 0.f), float(m_n - 2))));
+	unsigned int j((unsigned int)(std::min(std::max(floorf(y), 0.f), float(m_m - 2))));
+	float wx(std::min(std::max(x - float(i), 0.f), 1.f)), wy(std::min(std::max(y - float(j), 0.f), 1.f));
+
+	float left(ambientOcclusion[i][j] + wx * (ambientOcclusion[i + 1][j] - ambientOcclusion[i][j]));
+	float right(ambientOcclusion[i][j + 1] + wx * (ambientOcclusion[i + 1][j + 1] - ambientOcclusion[i][j + 1]));
+
+	return left + wy * (right - left);
+}
+
+//------------------------------------------------------------------------------
+float SoftwareRenderer::getLength() const
+//------------------------------------------------------------------------------
+{
+	return m_step * m_n;
+}
+
+//------------------------------------------------------------------------------
+float SoftwareRenderer::getWidth() const
+//------------------------------------------------------------------------------
+{
+	return m_step * m_m;
+}
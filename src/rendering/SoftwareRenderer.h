@@ -0,0 +1,132 @@
+#ifndef SOFTWARERENDERER_H
+#define SOFTWARERENDERER_H
+
+/**
+*******************************************************************************
+*
+*  @file       SoftwareRenderer.h
+*
+*  @brief      Class to render a height map on the CPU, without OpenGL,
+*				with the shading of the display shader
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <QImage>
+#include <QMatrix4x4>
+#include <QVector3D>
+
+#include "tools/Types.h"
+#include "terrainAnalysis/HeightFieldTracer.h"
+
+//==============================================================================
+/**
+*  @class  SoftwareRenderer
+*  @brief  SoftwareRenderer is a class to take snapshots of a height map
+*			where no GPU is available.
+*			A ray is traced from the camera through each pixel by HeightFieldTracer.
+*			It skips the blocks of the height pyramid that are under it and intersects
+*			the two triangles of the cells it reaches, so the cost follows the number
+*			of pixels rather than the size of the height map.
+*			The shading is the one of the display shader, the shadows are
+*			traced towards the light instead of read in a depth map.
+*			The rows of the image are rendered in parallel
+*/
+//==============================================================================
+class SoftwareRenderer
+{
+public:
+	/**
+	 * @brief SoftwareRenderer build the height pyramid of the height map
+	 * @param heights the heights in the [0,1] range
+	 * @param n number of rows
+	 * @param m number of columns
+	 * @throws std::runtime_error if the size of the heights is not n*m or if n or m is less than 2
+	 */
+	SoftwareRenderer(Types::shared_matrix const& heights, unsigned int n, unsigned int m);
+
+	/**
+	 * @brief setAmbientOcclusion darken the ambient light with a baked ambient occlusion
+	 * @param ambientOcclusion a n*m matrix, or nullptr to light the whole sky
+	 * @throws std::runtime_error if the size of the ambient occlusion is not n*m
+	 */
+	void setAmbientOcclusion(Types::shared_matrix const& ambientOcclusion);
+
+	/**
+	 * @brief render Render the height map as HeightMapRenderer would
+	 * @param width width of the image
+	 * @param height height of the image
+	 * @param pvMatrix the projection and view matrix of the camera
+	 * @param lightDir the direction from the height map to the light
+	 * @return the image, black where no terrain is seen
+	 */
+	QImage render(unsigned int width, unsigned int height,
+				  QMatrix4x4 const& pvMatrix, QVector3D const& lightDir) const;
+
+	//Getters
+	float getLength() const;
+	float getWidth() const;
+
+//******************************************************************************
+private:
+	//No default constructor
+	SoftwareRenderer();
+
+	//No copy constructor
+	SoftwareRenderer(SoftwareRenderer const&);
+
+	/**
+	 * @brief renderRows render some rows of the image
+	 * @param bits the pixels of the image
+	 * @param bytesPerLine the size of a row of the image, in bytes
+	 * @param blockCount the rows of a block are blockCount rows apart
+	 * @param inversePvmMatrix the inverse of the projection, view and model matrix
+	 * @param cameraPos the position of the camera for the specular component, as in HeightMapRenderer
+	 * @param leftIndex first block of rows, the block b has the rows b, b + blockCount...
+	 * @param rightIndex one past the last block of rows
+	 */
+	void renderRows(uchar *bits, int bytesPerLine, unsigned int width, unsigned int height,
+					unsigned int blockCount, QMatrix4x4 const& inversePvmMatrix,
+					QVector3D const& cameraPos, QVector3D const& lightDir,
+					unsigned int leftIndex, unsigned int rightIndex) const;
+
+	/**
+	 * @brief shade compute the colour of a point as the display shader would
+	 * @param point the point hit, in grid space
+	 * @param normal the normal of the triangle hit
+	 * @param cameraPos the position of the camera for the specular component
+	 * @param lightDir the direction from the height map to the light, normalized
+	 * @return the colour of the pixel
+	 */
+	QRgb shade(QVector3D const& point, QVector3D const& normal,
+			   QVector3D const& cameraPos, QVector3D const& lightDir) const;
+
+	/**
+	 * @brief getSkyVisibility interpolate the ambient occlusion between the pixels
+	 * @param x row, in grid space
+	 * @param y column, in grid space
+	 * @return the fraction of the sky seen, 1 without ambient occlusion
+	 */
+	float getSkyVisibility(float x, float y) const;
+
+	Types::shared_matrix m_heights;
+	Types::shared_matrix m_ambientOcclusion;
+	unsigned int m_n;
+	unsigned int m_m;
+
+	//distance between two adjacent vertices of the mesh
+	float m_step;
+	//height of a pixel of value 1 in grid space
+	float m_heightScale;
+
+	HeightFieldTracer m_tracer;
+
+	//the model matrix of HeightMapRenderer
+	QMatrix4x4 m_mMatrix;
+};
+
+#endif // SOFTWARERENDERER_H
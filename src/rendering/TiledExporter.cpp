@@ -0,0 +1,184 @@
+/**
+*******************************************************************************
+*
+*  @file       TiledExporter.cpp
+*
+*  @brief      Class to render images larger than the screen offscreen,
+*				tile by tile, and read them back through pixel buffers
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//	Include
+//******************************************************************************
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "TiledExporter.h"
+#include "tools/Instrumentation.h"
+
+//******************************************************************************
+//  constant variables
+//******************************************************************************
+//bytes of a pixel read back, RGBA
+const unsigned int PIXEL_BYTES = 4;
+
+//------------------------------------------------------------------------------
+TiledExporter::TiledExporter(unsigned int tileSize):
+//------------------------------------------------------------------------------
+	m_tileSize(std::max(tileSize, 1u)),
+	m_tileBuffer(),
+	m_pixelBuffers(),
+	m_pixelBufferSize(0)
+//------------------------------------------------------------------------------
+{
+}
+
+//------------------------------------------------------------------------------
+TiledExporter::~TiledExporter()
+//------------------------------------------------------------------------------
+{
+	if(m_pixelBuffers[0])
+		glDeleteBuffers(2, m_pixelBuffers);
+}
+
+//------------------------------------------------------------------------------
+void TiledExporter::initialize()
+//------------------------------------------------------------------------------
+{
+	initializeOpenGLFunctions();
+
+	glGenBuffers(2, m_pixelBuffers);
+
+	//The tiles cannot be bigger than the renderbuffers of the framebuffer object
+	GLint maxSize(0);
+	glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxSize);
+
+	if(maxSize > 0)
+		m_tileSize = std::min(m_tileSize, (unsigned int)(maxSize));
+}
+
+//------------------------------------------------------------------------------
+QImage TiledExporter::render(HeightMapRenderer &renderer, QMatrix4x4 const& pvMatrix,
+							 unsigned int width, unsigned int height)
+//------------------------------------------------------------------------------
+{
+	ScopedTimer timer("TiledExporter::render");
+
+	//The alpha of the framebuffer is not meaningful, the image is opaque
+	QImage image(int(width), int(height), QImage::Format_RGBX8888);
+
+	if(image.isNull())
+		throw std::runtime_error("Cannot allocate an image of this size");
+
+	//The meshes and the shadows have to be up to date before the first tile
+	renderer.updateShadowMap();
+
+	std::vector<Tile> tiles;
+
+	for(unsigned int y(0); y < height; y += m_tileSize)
+	{
+		for(unsigned int x(0); x < width; x += m_tileSize)
+			tiles.push_back({x, y, std::min(m_tileSize, width - x), std::min(m_tileSize, height - y)});
+	}
+
+	resize(std::min(m_tileSize, width), std::min(m_tileSize, height));
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+	for(size_t tileIndex(0); tileIndex < tiles.size(); tileIndex++)
+	{
+		Tile const& tile(tiles[tileIndex]);
+
+		m_tileBuffer->bind();
+		glViewport(0, 0, tile.width, tile.height);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		renderer.renderScene(pvMatrix, getTileMatrix(tile, width, height));
+
+		//Start the transfer, glReadPixels returns without waiting for the rendering
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, m_pixelBuffers[tileIndex % 2]);
+		glReadPixels(0, 0, tile.width, tile.height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+		//Copy the previous tile while this one is rendered and read
+		if(tileIndex > 0)
+			copyTile(image, tiles[tileIndex - 1], m_pixelBuffers[(tileIndex - 1) % 2]);
+	}
+
+	copyTile(image, tiles.back(), m_pixelBuffers[(tiles.size() - 1) % 2]);
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	m_tileBuffer->release();
+
+	return image;
+}
+
+//------------------------------------------------------------------------------
+void TiledExporter::resize(unsigned int tileWidth, unsigned int tileHeight)
+//------------------------------------------------------------------------------
+{
+	if(!m_tileBuffer || (unsigned int)(m_tileBuffer->size().width()) < tileWidth ||
+			(unsigned int)(m_tileBuffer->size().height()) < tileHeight)
+	{
+		m_tileBuffer.reset(new QOpenGLFramebufferObject(tileWidth, tileHeight,
+														QOpenGLFramebufferObject::Depth));
+	}
+
+	GLsizeiptr tileBytes(GLsizeiptr(tileWidth) * tileHeight * PIXEL_BYTES);
+
+	if(tileBytes > m_pixelBufferSize)
+	{
+		for(GLuint pixelBuffer : m_pixelBuffers)
+		{
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffer);
+			glBufferData(GL_PIXEL_PACK_BUFFER, tileBytes, nullptr, GL_STREAM_READ);
+		}
+
+		m_pixelBufferSize = tileBytes;
+	}
+}
+
+//------------------------------------------------------------------------------
+QMatrix4x4 TiledExporter::getTileMatrix(Tile const& tile, unsigned int width, unsigned int height)
+//------------------------------------------------------------------------------
+{
+	//Borders of the tile in normalized device coordinates, the y axis goes up
+	float left(2.f * float(tile.x) / float(width) - 1.f);
+	float right(2.f * float(tile.x + tile.width) / float(width) - 1.f);
+	float top(1.f - 2.f * float(tile.y) / float(height));
+	float bottom(1.f - 2.f * float(tile.y + tile.height) / float(height));
+
+	//scale and translate the borders to [-1,1], in clip space
+	return QMatrix4x4(2.f / (right - left), 0.f, 0.f, -(right + left) / (right - left),
+					  0.f, 2.f / (top - bottom), 0.f, -(top + bottom) / (top - bottom),
+					  0.f, 0.f, 1.f, 0.f,
+					  0.f, 0.f, 0.f, 1.f);
+}
+
+//------------------------------------------------------------------------------
+void TiledExporter::copyTile(QImage &image, Tile const& tile, GLuint pixelBuffer)
+//------------------------------------------------------------------------------
+{
+	ScopedTimer timer("TiledExporter::copyTile");
+
+	size_t rowBytes(size_t(tile.width) * PIXEL_BYTES);
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffer);
+	uchar const* pixels(static_cast<uchar const*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+		GLsizeiptr(rowBytes * tile.height), GL_MAP_READ_BIT)));
+
+	if(!pixels)
+		throw std::runtime_error("Cannot map the pixel buffer of a tile");
+
+	//The rows of OpenGL go from the bottom to the top
+	for(unsigned int row(0); row < tile.height; row++)
+	{
+		std::memcpy(image.scanLine(int(tile.y + tile.height - 1 - row)) + size_t(tile.x) * PIXEL_BYTES,
+					pixels + row * rowBytes, rowBytes);
+	}
+
+	glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+}
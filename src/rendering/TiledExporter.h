@@ -0,0 +1,127 @@
+#ifndef TILEDEXPORTER_H
+#define TILEDEXPORTER_H
+
+/**
+*******************************************************************************
+*
+*  @file       TiledExporter.h
+*
+*  @brief      Class to render images larger than the screen offscreen,
+*				tile by tile, and read them back through pixel buffers
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLFramebufferObject>
+#include <QImage>
+#include <QMatrix4x4>
+#include <memory>
+#include <vector>
+
+#include "HeightMapRenderer.h"
+
+//==============================================================================
+/**
+*  @class  TiledExporter
+*  @brief  TiledExporter is a class to render a height map to an image of any size
+*			without window.
+*			The image is cut into tiles rendered one after the other to a framebuffer
+*			object, with the projection narrowed to the part of the screen of each tile.
+*			Each tile is read into one of two pixel buffers without waiting,
+*			and the previous tile is copied into the image while the GPU renders
+*			and reads the current one.
+*/
+//==============================================================================
+class TiledExporter: protected QOpenGLExtraFunctions
+{
+public:
+	/**
+	 * @brief TiledExporter constructor
+	 * @param tileSize the maximum width and height of a tile, in pixels
+	 */
+	TiledExporter(unsigned int tileSize = 2048);
+
+	/**
+	 * @brief ~TiledExporter delete the pixel buffers.
+	 * The context used by initialize() has to be current
+	 */
+	~TiledExporter();
+
+	/**
+	 * @brief initialize Initialize the pixel buffers.
+	 * An OpenGL 3.0 context has to be current
+	 */
+	void initialize();
+
+	/**
+	 * @brief render Render the height map to an image.
+	 * Changes the bound framebuffer, the pixel pack buffer and the viewport
+	 * @param renderer the renderer of the height map, initialized in the current context
+	 * @param pvMatrix the projection matrix multiplied by the view matrix of the camera,
+	 * its aspect ratio should be the one of the image
+	 * @param width width of the image
+	 * @param height height of the image
+	 * @return the image, the rows go from the top to the bottom
+	 * @throws std::runtime_error if the image cannot be allocated or a tile cannot be read
+	 */
+	QImage render(HeightMapRenderer &renderer, QMatrix4x4 const& pvMatrix,
+				  unsigned int width, unsigned int height);
+
+//******************************************************************************
+private:
+	//No copy constructor
+	TiledExporter(TiledExporter const&);
+
+	///@cond
+	/**
+	 * @brief The Tile struct a rectangle of the image, from its top left corner
+	 */
+	struct Tile
+	{
+		unsigned int x, y, width, height;
+	};
+	///@endcond
+
+	/**
+	 * @brief resize Create the framebuffer and the pixel buffers again if the tiles do not fit
+	 * @param tileWidth width of the biggest tile
+	 * @param tileHeight height of the biggest tile
+	 */
+	void resize(unsigned int tileWidth, unsigned int tileHeight);
+
+	/**
+	 * @brief getTileMatrix
+	 * @param tile the tile
+	 * @param width width of the image
+	 * @param height height of the image
+	 * @return the matrix mapping the part of the screen covered by the tile to the whole viewport
+	 */
+	static QMatrix4x4 getTileMatrix(Tile const& tile, unsigned int width, unsigned int height);
+
+	/**
+	 * @brief copyTile map a pixel buffer and copy the tile it contains into the image
+	 * @param image the image
+	 * @param tile the tile read into the pixel buffer
+	 * @param pixelBuffer the pixel buffer
+	 * @throws std::runtime_error if the pixel buffer cannot be mapped
+	 */
+	void copyTile(QImage &image, Tile const& tile, GLuint pixelBuffer);
+
+	unsigned int m_tileSize;
+
+	//the tile rendered, with a depth buffer
+	std::unique_ptr<QOpenGLFramebufferObject> m_tileBuffer;
+
+	//alternately written by the GPU and read by the CPU
+	GLuint m_pixelBuffers[2];
+
+	//capacity of each pixel buffer, in bytes
+	GLsizeiptr m_pixelBufferSize;
+};
+
+#endif // TILEDEXPORTER_H
@@ -3,9 +3,9 @@
 /**
 *******************************************************************************
 *
-*  @file       lvlShader.frag
+*  @file       contourShader.frag
 *
-*  @brief      fragment shader to display the transparant lvl plan without shading
+*  @brief      fragment shader to display the isolines at the height of the lvl plan
 *
 *  @author     Andréas Meuleman
 *******************************************************************************
@@ -20,6 +20,6 @@ out vec4 colour;
 void main()
 //---------
 {
-	//Output: always the same color
-	colour = vec4(0.5, 0.5, 0.5, 0.8);
+	//Output: dark lines, readable over the red and the blue of the terrain
+	colour = vec4(0.1, 0.1, 0.1, 1.0);
 }
@@ -3,9 +3,9 @@
 /**
 *******************************************************************************
 *
-*  @file       lvlShader.vert
+*  @file       contourShader.vert
 *
-*  @brief      vertex shader to display the transparant lvl plan without shading
+*  @brief      vertex shader to display the isolines at the height of the lvl plan
 *
 *  @author     Andréas Meuleman
 *******************************************************************************
@@ -15,10 +15,11 @@
 //******************************************************************************
 //      Inputs
 //******************************************************************************
-in vec3 col;
 in vec3 nor;
 in vec3 eyeDir;
 in vec4 shadowCoord;
+in vec2 imageCoord;
+in float height;
 
 //******************************************************************************
 //      Outputs
@@ -30,6 +31,18 @@ out vec4 colour;
 //******************************************************************************
 uniform vec3 lightDir;
 uniform sampler2DShadow shadowMap;
+uniform sampler2D shadowMask;
+uniform bool useShadowMask;
+uniform sampler2D ambientOcclusion;
+uniform bool useAmbientOcclusion;
+uniform sampler2D viewshed;
+uniform bool useViewshed;
+uniform bool useLvlPlan;
+uniform float lvlPlanHeight;
+uniform sampler2D normalMap;
+uniform bool useNormalMap;
+uniform sampler2D colourRamp;
+uniform float heightFactor;
 
 //******************************************************************************
 //	constant variables
@@ -37,6 +50,16 @@ uniform sampler2DShadow shadowMap;
 //BIAS to reduce shadow acne
 const float BIAS = 0.0005;
 
+//colour of the terrain seen by the observer of the viewshed, the rest is greyed
+const vec3 VISIBLE_COLOUR = vec3(0.2, 0.9, 0.2);
+
+//colour and opacity of the lvl plan over the terrain under it
+const vec3 LVL_PLAN_COLOUR = vec3(0.5, 0.5, 0.5);
+const float LVL_PLAN_OPACITY = 0.8;
+
+//number of texels of the colour ramp, the first one for the value 0 and the last one for 1
+const float RAMP_SIZE = 256.;
+
 //---------
 void main()
 //---------
@@ -45,16 +68,44 @@ void main()
 	vec3 shadowChangedCoord = shadowCoord.xyz/shadowCoord.w;
 	shadowChangedCoord = shadowChangedCoord*0.5 + 0.5;
 
+	//the colour of the height, between the centers of the first and the last texels of the ramp
+	float value = clamp(height / heightFactor, 0., 1.);
+	vec3 col = texture(colourRamp, vec2((value * (RAMP_SIZE - 1.) + 0.5) / RAMP_SIZE, 0.5)).rgb;
+
+	//the pixels seen from the observer are tinted, the hidden ones are darkened
+	vec3 baseColour = col;
+
+	if (useViewshed)
+	{
+		float seen = texture(viewshed, imageCoord).r;
+		baseColour = mix(0.4 * col, 0.5 * (col + VISIBLE_COLOUR), seen);
+	}
+
+	//the normal of the full resolution, whatever the triangles of the mesh:
+	//x and y in [0,1], z found back since the normals of a height map point up
+	vec3 normal = nor;
+
+	if (useNormalMap)
+	{
+		vec2 packedNormal = texture(normalMap, imageCoord).rg * 2. - 1.;
+		normal = normalize(vec3(packedNormal, sqrt(max(0., 1. - dot(packedNormal, packedNormal)))));
+	}
+
 	//cosinus of the light direction and the normal vector
-	float cosLightNormal = max(0., dot(lightDir, nor));
+	float cosLightNormal = max(0., dot(lightDir, normal));
+
+	//fraction of the sky seen by the fragment, baked on the CPU. Darkens the ambient light
+	float skyVisibility = useAmbientOcclusion ? texture(ambientOcclusion, imageCoord).r : 1.;
 
 	//visibility equals 0.3 if the fragment is in the shadow and 1 if not
 	//(if it is on the back of the face, it is in the shadow).
-	float visibility = texture(shadowMap, vec3(shadowChangedCoord.xy, shadowChangedCoord.z-BIAS));
-	visibility = visibility * clamp(cosLightNormal - 0.1, 0., 1.) * 0.7 + 0.3;
+	//The shadow mask is computed on the CPU and does not need any bias
+	float visibility = useShadowMask ? texture(shadowMask, imageCoord).r :
+		texture(shadowMap, vec3(shadowChangedCoord.xy, shadowChangedCoord.z-BIAS));
+	visibility = visibility * clamp(cosLightNormal - 0.1, 0., 1.) * 0.7 + 0.3 * skyVisibility;
 
 	vec3 specular = 0.5 * vec3(1., 1., 1.) *
-		pow(clamp( dot( eyeDir, reflect(lightDir, nor)), 0., 1.), 4.);
+		pow(clamp( dot( eyeDir, reflect(lightDir, normal)), 0., 1.), 4.);
 
 	if (visibility <= 0.3)
 	{
@@ -62,8 +113,15 @@ void main()
 	}
 
 	//output colour
-	colour = vec4(visibility * ( //shadow
-	col * (cosLightNormal + 0.2) + //ambiant and difuse
-	specular),
-	1.); //no transparency
+	vec3 shaded = visibility * ( //shadow
+	baseColour * (cosLightNormal + 0.2 * skyVisibility) + //ambiant and difuse
+	specular);
+
+	//the terrain under the lvl plan is seen through it, the one above stands out
+	if (useLvlPlan && height < lvlPlanHeight)
+	{
+		shaded = mix(shaded, LVL_PLAN_COLOUR, LVL_PLAN_OPACITY);
+	}
+
+	colour = vec4(shaded, 1.); //no transparency
 }
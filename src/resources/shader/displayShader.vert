@@ -16,15 +16,15 @@
 //******************************************************************************
 in vec4 position;
 in vec3 normal;
-in vec3 colour;
 
 //******************************************************************************
 //      Outputs
 //******************************************************************************
-out  vec3 col;
 out  vec3 nor;
 out  vec3 eyeDir;
 out  vec4 shadowCoord;
+out  vec2 imageCoord;
+out  float height;
 
 //******************************************************************************
 //	Uniform variables
@@ -32,20 +32,70 @@ out  vec4 shadowCoord;
 uniform mat4 mvpMatrix;
 uniform vec3 cameraPos;
 uniform mat4 shadowMapMatrix;
+uniform vec4 imageCoordTransform;
+
+//the vertices are generated from the texture of the heights instead of the attributes
+uniform bool useHeightTexture;
+uniform sampler2D heights; //the columns of the image along x, the rows along y
+uniform float gridStep; //distance between two vertices
+uniform float heightFactor; //height of a pixel of value 1, also used for the colour ramp
+
+//******************************************************************************
+//	Constant variables
+//******************************************************************************
+//row and column of the six vertices of a cell, in the order of HeightMapMesh
+const ivec2 CELL_CORNERS[6] = ivec2[6](ivec2(0, 0), ivec2(1, 0), ivec2(1, 1),
+									   ivec2(0, 0), ivec2(1, 1), ivec2(0, 1));
+
+//----------------------------
+float getHeight(ivec2 pixel)
+//----------------------------
+{
+	return texelFetch(heights, pixel.yx, 0).r;
+}
 
 //---------
 void main()
 //---------
 {
-	col = colour;
+	vec4 vertexPosition = position;
 	nor = normal;
 
+	if(useHeightTexture)
+	{
+		//the last row and column of the image
+		ivec2 last = textureSize(heights, 0).yx - 1;
+
+		int cell = gl_VertexID / 6;
+		ivec2 pixel = ivec2(cell / last.y, cell % last.y) + CELL_CORNERS[gl_VertexID % 6];
+		float value = getHeight(pixel);
+
+		vertexPosition = vec4(vec2(pixel) * gridStep, value * heightFactor, 1.);
+
+		//slopes between the neighbouring pixels, one sided on the borders
+		ivec2 previous = max(pixel - 1, ivec2(0));
+		ivec2 next = min(pixel + 1, last);
+		float slopeX = (getHeight(ivec2(next.x, pixel.y)) - getHeight(ivec2(previous.x, pixel.y))) /
+			float(next.x - previous.x);
+		float slopeY = (getHeight(ivec2(pixel.x, next.y)) - getHeight(ivec2(pixel.x, previous.y))) /
+			float(next.y - previous.y);
+
+		nor = normalize(vec3(-slopeX * heightFactor, -slopeY * heightFactor, gridStep));
+	}
+
 	//direction of the eye (from the camera to the vertex, because reflexion of lightDir is from the light to the fragment)
-	eyeDir = normalize(position.xyz - cameraPos);
+	eyeDir = normalize(vertexPosition.xyz - cameraPos);
 
 	//coordinates of the vertex for the shadow map
-	shadowCoord = shadowMapMatrix * position;
+	shadowCoord = shadowMapMatrix * vertexPosition;
+
+	//coordinates of the pixel in the textures of the image (shadow mask, ambient occlusion),
+	//the rows of the image are along x
+	imageCoord = vertexPosition.yx * imageCoordTransform.xy + imageCoordTransform.zw;
+
+	//height of the vertex, for the colour ramp and the lvl plan
+	height = vertexPosition.z;
 
 	//Output position of the vertex
-	gl_Position = mvpMatrix * position;
+	gl_Position = mvpMatrix * vertexPosition;
 }
@@ -21,10 +21,34 @@ in vec4 position;
 //******************************************************************************
 uniform mat4 matrix;
 
+//the vertices are generated from the texture of the heights instead of the attributes
+uniform bool useHeightTexture;
+uniform sampler2D heights; //the columns of the image along x, the rows along y
+uniform float gridStep; //distance between two vertices
+uniform float heightFactor; //height of a pixel of value 1
+
+//******************************************************************************
+//	Constant variables
+//******************************************************************************
+//row and column of the six vertices of a cell, in the order of HeightMapMesh
+const ivec2 CELL_CORNERS[6] = ivec2[6](ivec2(0, 0), ivec2(1, 0), ivec2(1, 1),
+									   ivec2(0, 0), ivec2(1, 1), ivec2(0, 1));
+
 //-------------
 void main(void)
 //-------------
 {
+	vec4 vertexPosition = position;
+
+	if(useHeightTexture)
+	{
+		int cellColumns = textureSize(heights, 0).x - 1;
+		int cell = gl_VertexID / 6;
+		ivec2 pixel = ivec2(cell / cellColumns, cell % cellColumns) + CELL_CORNERS[gl_VertexID % 6];
+
+		vertexPosition = vec4(vec2(pixel) * gridStep, texelFetch(heights, pixel.yx, 0).r * heightFactor, 1.);
+	}
+
 	//output: the position of the vertex for the map
-	gl_Position =  matrix * position;
+	gl_Position =  matrix * vertexPosition;
 }
@@ -16,19 +16,67 @@ SOURCES += $$PWD/main.cpp \
     $$PWD/controlPanel/MainWindow.cpp \
     $$PWD/rendering/DepthMap.cpp \
     $$PWD/rendering/HeightMapMesh.cpp \
+    $$PWD/rendering/ChunkedHeightMap.cpp \
+    $$PWD/rendering/HeightTextureMesh.cpp \
+    $$PWD/rendering/GLResourceCache.cpp \
     $$PWD/rendering/RenderWindow.cpp \
+    $$PWD/rendering/HeightMapRenderer.cpp \
+    $$PWD/rendering/CameraPath.cpp \
+    $$PWD/rendering/SoftwareRenderer.cpp \
+    $$PWD/rendering/ColourRamp.cpp \
+    $$PWD/rendering/TiledExporter.cpp \
+    $$PWD/rendering/SequenceExporter.cpp \
     $$PWD/rendering/Mesh.cpp \
+    $$PWD/rendering/DrawList.cpp \
     $$PWD/rendering/LvlPlan.cpp \
-    $$PWD/imageProcessing/ImageProcessor.cpp
+    $$PWD/rendering/ContourLines.cpp \
+    $$PWD/imageProcessing/ImageProcessor.cpp \
+    $$PWD/terrainAnalysis/HorizonShadows.cpp \
+    $$PWD/terrainAnalysis/AmbientOcclusion.cpp \
+    $$PWD/terrainAnalysis/NormalMap.cpp \
+    $$PWD/terrainAnalysis/HeightPyramid.cpp \
+    $$PWD/terrainAnalysis/HeightFieldTracer.cpp \
+    $$PWD/terrainAnalysis/ContourExtractor.cpp \
+    $$PWD/terrainAnalysis/LevelStatistics.cpp \
+    $$PWD/terrainAnalysis/Viewshed.cpp \
+    $$PWD/tools/MatrixPool.cpp \
+    $$PWD/tools/DirtyRanges.cpp \
+    $$PWD/tools/Instrumentation.cpp \
+    $$PWD/tools/Tracer.cpp \
+    $$PWD/tools/PerfCounters.cpp
 
 HEADERS  += $$PWD/controlPanel/MainWindow.h \
     $$PWD/rendering/RenderWindow.h \
+    $$PWD/rendering/HeightMapRenderer.h \
+    $$PWD/rendering/CameraPath.h \
+    $$PWD/rendering/SoftwareRenderer.h \
+    $$PWD/rendering/ColourRamp.h \
+    $$PWD/rendering/TiledExporter.h \
+    $$PWD/rendering/SequenceExporter.h \
     $$PWD/rendering/DepthMap.h \
     $$PWD/rendering/HeightMapMesh.h \
+    $$PWD/rendering/ChunkedHeightMap.h \
+    $$PWD/rendering/HeightTextureMesh.h \
+    $$PWD/rendering/GLResourceCache.h \
     $$PWD/rendering/Mesh.h \
+    $$PWD/rendering/DrawList.h \
     $$PWD/rendering/LvlPlan.h \
+    $$PWD/rendering/ContourLines.h \
     $$PWD/imageProcessing/ImageProcessor.h \
+    $$PWD/terrainAnalysis/HorizonShadows.h \
+    $$PWD/terrainAnalysis/AmbientOcclusion.h \
+    $$PWD/terrainAnalysis/NormalMap.h \
+    $$PWD/terrainAnalysis/HeightPyramid.h \
+    $$PWD/terrainAnalysis/HeightFieldTracer.h \
+    $$PWD/terrainAnalysis/ContourExtractor.h \
+    $$PWD/terrainAnalysis/LevelStatistics.h \
+    $$PWD/terrainAnalysis/Viewshed.h \
     $$PWD/tools/ParallelTool.h \
+    $$PWD/tools/MatrixPool.h \
+    $$PWD/tools/DirtyRanges.h \
+    $$PWD/tools/Instrumentation.h \
+    $$PWD/tools/Tracer.h \
+    $$PWD/tools/PerfCounters.h \
     $$PWD/tools/Types.h
 
 FORMS += $$PWD/controlPanel/mainwindow.ui
@@ -0,0 +1,112 @@
+/**
+*******************************************************************************
+*
+*  @file       AmbientOcclusion.cpp
+*
+*  @brief      Class to bake the ambient occlusion of a height map on the CPU
+*				from the horizon angles in several directions
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <algorithm>
+#include <stdexcept>
+
+#include "AmbientOcclusion.h"
+#include "tools/ParallelTool.h"
+#include "tools/Instrumentation.h"
+
+//******************************************************************************
+//  constant variables
+//******************************************************************************
+//ratio between the distances of two successive samples, the far samples are sparser
+const float SAMPLE_DISTANCE_RATIO = 1.3f;
+
+//------------------------------------------------------------------------------
+Types::float_matrix AmbientOcclusion::bake(Types::float_matrix const& heights, unsigned int n, unsigned int m,
+	float heightScale, unsigned int directionCount, float radius)
+//------------------------------------------------------------------------------
+{
+	ScopedTimer timer("AmbientOcclusion::bake");
+
+	if(!n || !m || heights.size() != n || heights[0].size() != m || !directionCount)
+		throw std::runtime_error("Wrong data, cannot compute the ambient occlusion");
+
+	std::vector<float> sampleDistances;
+
+	for(float distance(1.f); distance <= radius;
+		distance = std::max(distance + 1.f, distance * SAMPLE_DISTANCE_RATIO))
+	{
+		sampleDistances.push_back(distance);
+	}
+
+	Types::float_matrix accessibility(n, Types::float_line(m));
+
+	ParallelTool::performInParallel(
+		[&](unsigned int leftIndex, unsigned int rightIndex)
+		{
+			bakeRows(heights, accessibility, n, m, heightScale, directionCount,
+					 sampleDistances, leftIndex, rightIndex);
+		},
+		0, n);
+
+	return accessibility;
+}
+
+//------------------------------------------------------------------------------
+void AmbientOcclusion::bakeRows(Types::float_matrix const& heights, Types::float_matrix &accessibility,
+	unsigned int n, unsigned int m, float heightScale, unsigned int directionCount,
+	std::vector<float> const& sampleDistances, unsigned int leftIndex, unsigned int rightIndex)
+//------------------------------------------------------------------------------
+{
+	//highest slope towards the horizon in the current direction, and sum of the occlusions
+	Types::float_line maxSlopes(m), occlusions(m);
+
+	for(unsigned int i(leftIndex); i < rightIndex; i++)
+	{
+		float const* rowHeights(heights[i].data());
+		std::fill(occlusions.begin(), occlusions.end(), 0.f);
+
+		for(unsigned int direction(0); direction < directionCount; direction++)
+		{
+			float angle(2.f * float(M_PI) * float(direction) / float(directionCount));
+			float cosAngle(cosf(angle)), sinAngle(sinf(angle));
+
+			//the terrain under the tangent plane does not occlude
+			std::fill(maxSlopes.begin(), maxSlopes.end(), 0.f);
+			float *slopes(maxSlopes.data());
+
+			for(float distance : sampleDistances)
+			{
+				int di(int(lroundf(distance * cosAngle))), dj(int(lroundf(distance * sinAngle)));
+				int sampleRow(int(i) + di);
+
+				//the samples out of the height map do not occlude
+				if(sampleRow < 0 || sampleRow >= int(n))
+					continue;
+
+				float scale(heightScale / sqrtf(float(di * di + dj * dj)));
+				float const* sampleHeights(heights[sampleRow].data());
+
+				int firstColumn(std::max(0, -dj)), lastColumn(std::min(int(m), int(m) - dj));
+
+				//same offset for all the pixels of the row: contiguous and vectorizable
+				for(int j(firstColumn); j < lastColumn; j++)
+					slopes[j] = std::max(slopes[j], (sampleHeights[j + dj] - rowHeights[j]) * scale);
+			}
+
+			//sine of the horizon angle
+			for(unsigned int j(0); j < m; j++)
+				occlusions[j] += slopes[j] / sqrtf(1.f + slopes[j] * slopes[j]);
+		}
+
+		for(unsigned int j(0); j < m; j++)
+			accessibility[i][j] = 1.f - occlusions[j] / float(directionCount);
+	}
+}
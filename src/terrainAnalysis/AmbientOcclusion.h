@@ -0,0 +1,67 @@
+#ifndef AMBIENTOCCLUSION_H
+#define AMBIENTOCCLUSION_H
+
+/**
+*******************************************************************************
+*
+*  @file       AmbientOcclusion.h
+*
+*  @brief      Class to bake the ambient occlusion of a height map on the CPU
+*				from the horizon angles in several directions
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include "tools/Types.h"
+
+//==============================================================================
+/**
+*  @class  AmbientOcclusion
+*  @brief  AmbientOcclusion is a class to compute how much of the sky each pixel
+*			of a height map sees.
+*			In each direction, the horizon angle is the highest slope towards
+*			the samples at increasing distances. The occlusion is the mean
+*			of the sines of the horizon angles.
+*			A sample distance gives the same offset to every pixel of a row,
+*			so the inner loop reads and writes contiguous floats and vectorizes.
+*			The rows are processed in parallel
+*/
+//==============================================================================
+class AmbientOcclusion
+{
+public:
+	/**
+	 * @brief bake compute the ambient occlusion of the height map
+	 * @param heights the heights in the [0,1] range
+	 * @param n number of rows
+	 * @param m number of columns
+	 * @param heightScale height of a pixel of value 1, in units of the distance between two pixels
+	 * @param directionCount number of directions in which the horizon is searched
+	 * @param radius distance of the farthest sample, in pixels
+	 * @return a n*m matrix with the fraction of the sky seen by each pixel, in the [0,1] range
+	 * @throws std::runtime_error if the size of the heights is not n*m
+	 */
+	static Types::float_matrix bake(Types::float_matrix const& heights, unsigned int n, unsigned int m,
+		float heightScale, unsigned int directionCount = 8, float radius = 32.f);
+
+//******************************************************************************
+private:
+	//No instance
+	AmbientOcclusion();
+
+	/**
+	 * @brief bakeRows compute the ambient occlusion of some rows
+	 * @param sampleDistances distances of the samples along each direction, in pixels
+	 * @param leftIndex first row
+	 * @param rightIndex one past the last row
+	 */
+	static void bakeRows(Types::float_matrix const& heights, Types::float_matrix &accessibility,
+		unsigned int n, unsigned int m, float heightScale, unsigned int directionCount,
+		std::vector<float> const& sampleDistances, unsigned int leftIndex, unsigned int rightIndex);
+};
+
+#endif // AMBIENTOCCLUSION_H
@@ -0,0 +1,238 @@
+/**
+*******************************************************************************
+*
+*  @file       ContourExtractor.cpp
+*
+*  @brief      Class to extract the isolines of a height map at any level,
+*				visiting only the cells that may cross it
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+
+#include "ContourExtractor.h"
+#include "tools/ParallelTool.h"
+#include "tools/Instrumentation.h"
+
+//******************************************************************************
+//  constant variables
+//******************************************************************************
+//Number of buckets over the [0,1] range, a cell spans few of them on a smooth terrain
+const unsigned int BUCKET_COUNT = 256;
+
+//------------------------------------------------------------------------------
+ContourExtractor::ContourExtractor(Types::shared_matrix const& heights, unsigned int n, unsigned int m):
+//------------------------------------------------------------------------------
+	m_heights(heights),
+	m_n(n),
+	m_m(m),
+	m_cells(),
+	m_spanStarts(BUCKET_COUNT * BUCKET_COUNT + 1, 0)
+//------------------------------------------------------------------------------
+{
+	ScopedTimer timer("ContourExtractor::ContourExtractor");
+
+	if(!m_heights || m_n < 2 || m_m < 2 || m_heights->size() != m_n || (*m_heights)[0].size() != m_m)
+		throw std::runtime_error("Wrong data, cannot extract the contours");
+
+	Types::float_matrix const& values(*m_heights);
+	unsigned int cellColumns(m_m - 1);
+
+	//lowest and highest buckets of each cell
+	std::vector<unsigned short> spans((m_n - 1) * cellColumns);
+
+	ParallelTool::performInParallel(
+		[&](unsigned int leftIndex, unsigned int rightIndex)
+		{
+			for(unsigned int i(leftIndex); i < rightIndex; i++)
+			{
+				for(unsigned int j(0); j < cellColumns; j++)
+				{
+					float minimum(std::min(std::min(values[i][j], values[i + 1][j]),
+										   std::min(values[i][j + 1], values[i + 1][j + 1])));
+					float maximum(std::max(std::max(values[i][j], values[i + 1][j]),
+										   std::max(values[i][j + 1], values[i + 1][j + 1])));
+
+					spans[i * cellColumns + j] = (unsigned short)(getSpan(getBucket(minimum), getBucket(maximum)));
+				}
+			}
+		},
+		0, m_n - 1);
+
+	//counting sort of the cells by span
+	for(unsigned short span : spans)
+		m_spanStarts[span + 1]++;
+
+	for(unsigned int span(0); span < BUCKET_COUNT * BUCKET_COUNT; span++)
+		m_spanStarts[span + 1] += m_spanStarts[span];
+
+	Types::uint_line nextCells(m_spanStarts.begin(), m_spanStarts.end() - 1);
+	m_cells.resize(spans.size());
+
+	for(unsigned int cell(0); cell < spans.size(); cell++)
+		m_cells[nextCells[spans[cell]]++] = cell;
+}
+
+//------------------------------------------------------------------------------
+Types::vertices_data ContourExtractor::extract(float level) const
+//------------------------------------------------------------------------------
+{
+	ScopedTimer timer("ContourExtractor::extract");
+
+	Types::vertices_data segments;
+
+	//no cell crosses a level out of the heights
+	if(level < 0.f || level > 1.f)
+		return segments;
+
+	//the few ranges of candidates are gathered so that the threads share them evenly
+	Types::uint_line cells;
+	cells.reserve(getCandidateCount(level));
+
+	for(std::pair<unsigned int, unsigned int> const& range : getCandidates(level))
+		cells.insert(cells.end(), m_cells.begin() + range.first, m_cells.begin() + range.second);
+
+	std::mutex segmentsMutex;
+
+	ParallelTool::performInParallel(
+		[&](unsigned int leftIndex, unsigned int rightIndex)
+		{
+			Types::vertices_data partSegments;
+			extractCells(level, cells, leftIndex, rightIndex, partSegments);
+
+			std::lock_guard<std::mutex> lock(segmentsMutex);
+			segments.insert(segments.end(), partSegments.begin(), partSegments.end());
+		},
+		0, (unsigned int)(cells.size()));
+
+	return segments;
+}
+
+//------------------------------------------------------------------------------
+void ContourExtractor::extractCells(float level, Types::uint_line const& cells, unsigned int leftIndex,
+									unsigned int rightIndex, Types::vertices_data &segments) const
+//------------------------------------------------------------------------------
+{
+	Types::float_matrix const& heights(*m_heights);
+
+	//where the level crosses the edge between a vertex above it and a vertex under it
+	auto crossing = [level](QVector3D const& a, QVector3D const& b)
+		{
+			float t((level - a.z()) / (b.z() - a.z()));
+			return QVector3D(a.x() + t * (b.x() - a.x()), a.y() + t * (b.y() - a.y()), level);
+		};
+
+	//One vertex of a triangle crossed is alone on its side of the level:
+	//the segment joins its two edges
+	auto marchTriangle = [level, &crossing, &segments](QVector3D const& a, QVector3D const& b,
+													   QVector3D const& c)
+		{
+			bool isAboveA(a.z() > level), isAboveB(b.z() > level), isAboveC(c.z() > level);
+
+			if(isAboveA == isAboveB && isAboveB == isAboveC)
+				return;
+
+			if(isAboveB == isAboveC)
+			{
+				segments.push_back(crossing(a, b));
+				segments.push_back(crossing(a, c));
+			}
+			else if(isAboveA == isAboveC)
+			{
+				segments.push_back(crossing(b, a));
+				segments.push_back(crossing(b, c));
+			}
+			else
+			{
+				segments.push_back(crossing(c, a));
+				segments.push_back(crossing(c, b));
+			}
+		};
+
+	for(unsigned int index(leftIndex); index < rightIndex; index++)
+	{
+		unsigned int i(cells[index] / (m_m - 1)), j(cells[index] % (m_m - 1));
+
+		//the corners of the cell, as in HeightMapMesh
+		QVector3D v1(float(i), float(j), heights[i][j]);
+		QVector3D v2(float(i + 1), float(j), heights[i + 1][j]);
+		QVector3D v3(float(i + 1), float(j + 1), heights[i + 1][j + 1]);
+		QVector3D v4(float(i), float(j + 1), heights[i][j + 1]);
+
+		marchTriangle(v1, v2, v3);
+		marchTriangle(v1, v3, v4);
+	}
+}
+
+//------------------------------------------------------------------------------
+unsigned int ContourExtractor::getCandidateCount(float level) const
+//------------------------------------------------------------------------------
+{
+	unsigned int count(0);
+
+	for(std::pair<unsigned int, unsigned int> const& range : getCandidates(level))
+		count += range.second - range.first;
+
+	return count;
+}
+
+//------------------------------------------------------------------------------
+std::vector<std::pair<unsigned int, unsigned int>> ContourExtractor::getCandidates(float level) const
+//------------------------------------------------------------------------------
+{
+	std::vector<std::pair<unsigned int, unsigned int>> ranges;
+
+	if(level < 0.f || level > 1.f)
+		return ranges;
+
+	unsigned int bucket(getBucket(level));
+
+	//the cells whose lowest bucket is under the level begin with the ones whose highest is above it
+	for(unsigned int lowest(0); lowest <= bucket; lowest++)
+	{
+		unsigned int first(m_spanStarts[getSpan(lowest, BUCKET_COUNT - 1)]);
+		unsigned int last(m_spanStarts[getSpan(lowest, bucket) + 1]);
+
+		if(first < last)
+			ranges.push_back(std::make_pair(first, last));
+	}
+
+	return ranges;
+}
+
+//------------------------------------------------------------------------------
+unsigned int ContourExtractor::getBucket(float value)
+//------------------------------------------------------------------------------
+{
+	float clamped(std::min(std::max(value, 0.f), 1.f));
+
+	return std::min((unsigned int)(clamped * BUCKET_COUNT), BUCKET_COUNT - 1);
+}
+
+//------------------------------------------------------------------------------
+unsigned int ContourExtractor::getSpan(unsigned int lowest, unsigned int highest)
+//------------------------------------------------------------------------------
+{
+	return lowest * BUCKET_COUNT + BUCKET_COUNT - 1 - highest;
+}
+
+//------------------------------------------------------------------------------
+unsigned int ContourExtractor::getN() const
+//------------------------------------------------------------------------------
+{
+	return m_n;
+}
+
+//------------------------------------------------------------------------------
+unsigned int ContourExtractor::getM() const
+//------------------------------------------------------------------------------
+{
+	return m_m;
+}
@@ -0,0 +1,115 @@
+#ifndef CONTOUREXTRACTOR_H
+#define CONTOUREXTRACTOR_H
+
+/**
+*******************************************************************************
+*
+*  @file       ContourExtractor.h
+*
+*  @brief      Class to extract the isolines of a height map at any level,
+*				visiting only the cells that may cross it
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include "tools/Types.h"
+
+//==============================================================================
+/**
+*  @class  ContourExtractor
+*  @brief  ContourExtractor is a class to find where a horizontal plane cuts
+*			the triangles of a height map.
+*			Each cell is split into the two triangles of HeightMapMesh, so the
+*			isolines are the exact intersection of the plane with the rendered
+*			terrain and marching the triangles has no ambiguous case.
+*			Each cell is stored once, sorted by the buckets of its lowest and
+*			its highest heights: a level only visits the cells spanning its
+*			bucket, a few ranges of the sorted cells, in parallel.
+*			The space is the one of the grid: x is the row, y is the column,
+*			z is the value of the pixels.
+*/
+//==============================================================================
+class ContourExtractor
+{
+public:
+	/**
+	 * @brief ContourExtractor sort the cells of the height map by their minimum and maximum
+	 * @param heights the heights in the [0,1] range
+	 * @param n number of rows
+	 * @param m number of columns
+	 * @throws std::runtime_error if the size of the heights is not n*m or if n or m is less than 2
+	 */
+	ContourExtractor(Types::shared_matrix const& heights, unsigned int n, unsigned int m);
+
+	/**
+	 * @brief extract find the isolines at a level
+	 * @param level the value of the pixels on the lines
+	 * @return the ends of the segments, two by two, in grid space.
+	 * The order of the segments depends on the threads
+	 */
+	Types::vertices_data extract(float level) const;
+
+	/**
+	 * @brief getCandidateCount
+	 * @param level the value of the pixels on the lines
+	 * @return number of cells visited to extract the isolines at this level
+	 */
+	unsigned int getCandidateCount(float level) const;
+
+	//Getters
+	unsigned int getN() const;
+	unsigned int getM() const;
+
+//******************************************************************************
+private:
+	//No default constructor
+	ContourExtractor();
+
+	/**
+	 * @brief getBucket
+	 * @param value a height, clamped to the [0,1] range
+	 * @return the bucket containing this height
+	 */
+	static unsigned int getBucket(float value);
+
+	/**
+	 * @brief getSpan
+	 * @param lowest the bucket of the lowest height of a cell
+	 * @param highest the bucket of its highest height
+	 * @return the rank of the cell in m_cells: by lowest bucket, then by highest bucket from the top
+	 */
+	static unsigned int getSpan(unsigned int lowest, unsigned int highest);
+
+	/**
+	 * @brief getCandidates list the cells spanning the bucket of a level
+	 * @param level the value of the pixels on the lines, in the [0,1] range
+	 * @return the first and one past the last cell of each range of m_cells to visit
+	 */
+	std::vector<std::pair<unsigned int, unsigned int>> getCandidates(float level) const;
+
+	/**
+	 * @brief extractCells march the two triangles of some cells
+	 * @param cells the cells to march, as i * (m - 1) + j
+	 * @param leftIndex first cell of the list
+	 * @param rightIndex one past the last cell
+	 * @param[out] segments the ends of the segments found are added to it
+	 */
+	void extractCells(float level, Types::uint_line const& cells, unsigned int leftIndex,
+					  unsigned int rightIndex, Types::vertices_data &segments) const;
+
+	Types::shared_matrix m_heights;
+	unsigned int m_n;
+	unsigned int m_m;
+
+	//all the cells once, as i * (m - 1) + j, sorted by getSpan()
+	Types::uint_line m_cells;
+
+	//first cell of each span in m_cells, and the number of cells at the end
+	Types::uint_line m_spanStarts;
+};
+
+#endif // CONTOUREXTRACTOR_H
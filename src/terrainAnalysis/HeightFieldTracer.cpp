@@ -0,0 +1,257 @@
+/**
+*******************************************************************************
+*
+*  @file       HeightFieldTracer.cpp
+*
+*  @brief      Class to trace rays against the triangles of a height map,
+*				for the picking, the line of sight and the software rendering
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <math.h>
+#include <cfloat>
+#include <algorithm>
+
+#include "HeightFieldTracer.h"
+
+//******************************************************************************
+//  constant variables
+//******************************************************************************
+//Advance of a ray past a block border to find the next block, in pixels
+const float RAY_NUDGE = 1e-3f;
+
+//Advance relative to the distance travelled: far from the origin, t + RAY_NUDGE rounds back to t
+const float RELATIVE_RAY_NUDGE = 4.f * FLT_EPSILON;
+
+//Tolerance on the barycentric coordinates, so that no ray passes between two triangles
+const float TRIANGLE_TOLERANCE = 1e-4f;
+
+//------------------------------------------------------------------------------
+HeightFieldTracer::HeightFieldTracer(Types::shared_matrix const& heights, unsigned int n, unsigned int m,
+									 float heightScale):
+//------------------------------------------------------------------------------
+	m_heights(heights),
+	m_n(n),
+	m_m(m),
+	m_heightScale(heightScale),
+	m_pyramid(heights ? *heights : Types::float_matrix(), n, m)
+//------------------------------------------------------------------------------
+{
+}
+
+//------------------------------------------------------------------------------
+bool HeightFieldTracer::intersect(QVector3D const& origin, QVector3D const& direction,
+								  float tMin, float tMax, float &tHit, QVector3D &normal) const
+//------------------------------------------------------------------------------
+{
+	return traverse(origin, direction, tMin, tMax, false, tHit, normal);
+}
+
+//------------------------------------------------------------------------------
+bool HeightFieldTracer::isOccluded(QVector3D const& origin, QVector3D const& direction, float tMax) const
+//------------------------------------------------------------------------------
+{
+	float tHit;
+	QVector3D normal;
+
+	return traverse(origin, direction, 0.f, tMax, true, tHit, normal);
+}
+
+//------------------------------------------------------------------------------
+bool HeightFieldTracer::isVisible(QVector3D const& from, QVector3D const& to) const
+//------------------------------------------------------------------------------
+{
+	QVector3D direction(to - from);
+	float distance(direction.length());
+
+	if(distance == 0.f)
+		return true;
+
+	return !isOccluded(from, direction / distance, distance);
+}
+
+//------------------------------------------------------------------------------
+bool HeightFieldTracer::traverse(QVector3D const& origin, QVector3D const& direction,
+								 float tMin, float tMax, bool isOcclusionQuery,
+								 float &tHit, QVector3D &normal) const
+//------------------------------------------------------------------------------
+{
+	unsigned int topLevel(m_pyramid.getLevelCount() - 1);
+
+	//clip the ray to the bounding box of the height map
+	float boxMin[3] = {0.f, 0.f, 0.f};
+	float boxMax[3] = {float(m_n - 1), float(m_m - 1), m_pyramid.getMax(topLevel, 0, 0) * m_heightScale};
+	float tStart(tMin), tEnd(tMax);
+
+	for(int axis(0); axis < 3; axis++)
+	{
+		if(direction[axis] == 0.f)
+		{
+			if(origin[axis] < boxMin[axis] || origin[axis] > boxMax[axis])
+				return false;
+		}
+		else
+		{
+			float t0((boxMin[axis] - origin[axis]) / direction[axis]);
+			float t1((boxMax[axis] - origin[axis]) / direction[axis]);
+
+			tStart = std::max(tStart, std::min(t0, t1));
+			tEnd = std::min(tEnd, std::max(t0, t1));
+		}
+	}
+
+	//Go up in the pyramid while the ray passes over the blocks and down when it may hit them
+	unsigned int level(topLevel);
+	float t(tStart);
+
+	auto nudge = [](float distance)
+		{
+			return distance + std::max(RAY_NUDGE, fabsf(distance) * RELATIVE_RAY_NUDGE);
+		};
+
+	while(t <= tEnd)
+	{
+		//the cell of the point just after t, the points on the far borders belong to the last cells
+		float x(origin.x() + direction.x() * nudge(t)), y(origin.y() + direction.y() * nudge(t));
+		unsigned int i((unsigned int)(std::min(std::max(floorf(x), 0.f), float(m_n - 2))));
+		unsigned int j((unsigned int)(std::min(std::max(floorf(y), 0.f), float(m_m - 2))));
+
+		unsigned int blockI(i >> level), blockJ(j >> level);
+		float blockMin[2] = {float(blockI << level), float(blockJ << level)};
+		float blockMax[2] = {float(std::min((blockI + 1) << level, m_n - 1)),
+							 float(std::min((blockJ + 1) << level, m_m - 1))};
+
+		//distance at which the ray leaves the block
+		float tExit(tEnd);
+
+		for(int axis(0); axis < 2; axis++)
+		{
+			if(direction[axis] > 0.f)
+				tExit = std::min(tExit, (blockMax[axis] - origin[axis]) / direction[axis]);
+			else if(direction[axis] < 0.f)
+				tExit = std::min(tExit, (blockMin[axis] - origin[axis]) / direction[axis]);
+		}
+
+		float lowestZ(origin.z() + direction.z() * (direction.z() < 0.f ? tExit : t));
+		float highestZ(origin.z() + direction.z() * (direction.z() < 0.f ? t : tExit));
+
+		if(lowestZ > m_pyramid.getMax(level, blockI, blockJ) * m_heightScale)
+		{
+			t = std::max(tExit, nudge(t));
+
+			if(level < topLevel)
+				level++;
+		}
+		//Under the lowest triangle of the block, the ray has hit one of them before
+		else if(isOcclusionQuery && highestZ < m_pyramid.getMin(level, blockI, blockJ) * m_heightScale)
+		{
+			return true;
+		}
+		else if(level > 0)
+		{
+			level--;
+		}
+		else
+		{
+			//the triangles of a cell cannot be hit outside of it, the search range can stay wide
+			if(intersectCell(i, j, origin, direction, tMin, tMax, tHit, normal))
+				return true;
+
+			t = std::max(tExit, nudge(t));
+
+			if(level < topLevel)
+				level++;
+		}
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------
+bool HeightFieldTracer::intersectCell(unsigned int i, unsigned int j, QVector3D const& origin,
+									  QVector3D const& direction, float tMin, float tMax,
+									  float &tHit, QVector3D &normal) const
+//------------------------------------------------------------------------------
+{
+	Types::float_matrix const& heights(*m_heights);
+
+	//the corners of the cell, as in HeightMapMesh
+	QVector3D v1(float(i), float(j), heights[i][j] * m_heightScale);
+	QVector3D v2(float(i + 1), float(j), heights[i + 1][j] * m_heightScale);
+	QVector3D v3(float(i + 1), float(j + 1), heights[i + 1][j + 1] * m_heightScale);
+	QVector3D v4(float(i), float(j + 1), heights[i][j + 1] * m_heightScale);
+
+	//Möller-Trumbore intersection
+	auto intersectTriangle = [&origin, &direction](QVector3D const& a, QVector3D const& b,
+												   QVector3D const& c, float &t)
+		{
+			QVector3D edge1(b - a), edge2(c - a);
+			QVector3D p(QVector3D::crossProduct(direction, edge2));
+			float determinant(QVector3D::dotProduct(edge1, p));
+
+			//the ray is parallel to the triangle
+			if(determinant == 0.f)
+				return false;
+
+			QVector3D s(origin - a);
+			float u(QVector3D::dotProduct(s, p) / determinant);
+
+			if(u < -TRIANGLE_TOLERANCE || u > 1.f + TRIANGLE_TOLERANCE)
+				return false;
+
+			QVector3D q(QVector3D::crossProduct(s, edge1));
+			float v(QVector3D::dotProduct(direction, q) / determinant);
+
+			if(v < -TRIANGLE_TOLERANCE || u + v > 1.f + TRIANGLE_TOLERANCE)
+				return false;
+
+			t = QVector3D::dotProduct(edge2, q) / determinant;
+
+			return true;
+		};
+
+	bool isHit(false);
+	float t;
+
+	if(intersectTriangle(v1, v2, v3, t) && t >= tMin && t <= tMax)
+	{
+		isHit = true;
+		tHit = t;
+		normal = QVector3D::crossProduct(v2 - v1, v3 - v1).normalized();
+	}
+
+	if(intersectTriangle(v1, v3, v4, t) && t >= tMin && t <= tMax && (!isHit || t < tHit))
+	{
+		isHit = true;
+		tHit = t;
+		normal = QVector3D::crossProduct(v3 - v1, v4 - v1).normalized();
+	}
+
+	return isHit;
+}
+
+//------------------------------------------------------------------------------
+unsigned int HeightFieldTracer::getN() const
+//------------------------------------------------------------------------------
+{
+	return m_n;
+}
+
+//------------------------------------------------------------------------------
+unsigned int HeightFieldTracer::getM() const
+//------------------------------------------------------------------------------
+{
+	return m_m;
+}
+
+//------------------------------------------------------------------------------
+float HeightFieldTracer::getHeightScale() const
+//------------------------------------------------------------------------------
+{
+	return m_heightScale;
+}
@@ -0,0 +1,126 @@
+#ifndef HEIGHTFIELDTRACER_H
+#define HEIGHTFIELDTRACER_H
+
+/**
+*******************************************************************************
+*
+*  @file       HeightFieldTracer.h
+*
+*  @brief      Class to trace rays against the triangles of a height map,
+*				for the picking, the line of sight and the software rendering
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <QVector3D>
+
+#include "tools/Types.h"
+#include "HeightPyramid.h"
+
+//==============================================================================
+/**
+*  @class  HeightFieldTracer
+*  @brief  HeightFieldTracer is a class to find where a ray hits a height map.
+*			The ray goes up in the height pyramid while it passes over the blocks
+*			and down when it may hit them, so only the cells it may hit are tested
+*			and a query costs O(log n) steps rather than one per cell crossed.
+*			The space is the one of the grid: x is the row, y is the column,
+*			z is in units of the distance between two pixels.
+*			The triangles are the ones of HeightMapMesh
+*/
+//==============================================================================
+class HeightFieldTracer
+{
+public:
+	/**
+	 * @brief HeightFieldTracer build the height pyramid of the height map
+	 * @param heights the heights in the [0,1] range
+	 * @param n number of rows
+	 * @param m number of columns
+	 * @param heightScale height of a pixel of value 1 in grid space
+	 * @throws std::runtime_error if the size of the heights is not n*m or if n or m is less than 2
+	 */
+	HeightFieldTracer(Types::shared_matrix const& heights, unsigned int n, unsigned int m,
+					  float heightScale);
+
+	/**
+	 * @brief intersect find the first triangle hit by a ray
+	 * @param origin the origin of the ray
+	 * @param direction the direction of the ray, normalized
+	 * @param tMin the distance at which the search begins
+	 * @param tMax the distance at which the search ends
+	 * @param[out] tHit the distance of the hit
+	 * @param[out] normal the normal of the triangle hit, as in HeightMapMesh
+	 * @return true if the ray hits the height map
+	 */
+	bool intersect(QVector3D const& origin, QVector3D const& direction, float tMin, float tMax,
+				   float &tHit, QVector3D &normal) const;
+
+	/**
+	 * @brief isOccluded know if a ray hits the height map, without looking for the first hit.
+	 * The ray stops as soon as it passes under a block
+	 * @param origin the origin of the ray, above the height map
+	 * @param direction the direction of the ray, normalized
+	 * @param tMax the distance at which the search ends
+	 * @return true if the ray hits the height map
+	 */
+	bool isOccluded(QVector3D const& origin, QVector3D const& direction, float tMax) const;
+
+	/**
+	 * @brief isVisible line of sight between two points above the height map
+	 * @param from the first point
+	 * @param to the second point
+	 * @return true if no triangle lies between the two points
+	 */
+	bool isVisible(QVector3D const& from, QVector3D const& to) const;
+
+	//Getters
+	unsigned int getN() const;
+	unsigned int getM() const;
+	float getHeightScale() const;
+
+//******************************************************************************
+private:
+	//No default constructor
+	HeightFieldTracer();
+
+	/**
+	 * @brief traverse walk the blocks of the pyramid crossed by a ray
+	 * and intersect the cells it may hit
+	 * @param isOcclusionQuery true to stop under the first block, without computing the hit
+	 * @param[out] tHit the distance of the hit, not set for an occlusion query
+	 * @param[out] normal the normal of the triangle hit, not set for an occlusion query
+	 * @return true if the ray hits the height map
+	 */
+	bool traverse(QVector3D const& origin, QVector3D const& direction, float tMin, float tMax,
+				  bool isOcclusionQuery, float &tHit, QVector3D &normal) const;
+
+	/**
+	 * @brief intersectCell intersect a ray with the two triangles of a cell
+	 * @param i row of the cell
+	 * @param j column of the cell
+	 * @param tMin closest distance accepted
+	 * @param tMax farthest distance accepted
+	 * @param[out] tHit the distance of the closest triangle hit
+	 * @param[out] normal the normal of the closest triangle hit
+	 * @return true if one of the triangles is hit
+	 */
+	bool intersectCell(unsigned int i, unsigned int j, QVector3D const& origin,
+					   QVector3D const& direction, float tMin, float tMax,
+					   float &tHit, QVector3D &normal) const;
+
+	Types::shared_matrix m_heights;
+	unsigned int m_n;
+	unsigned int m_m;
+
+	//height of a pixel of value 1 in grid space
+	float m_heightScale;
+
+	HeightPyramid m_pyramid;
+};
+
+#endif // HEIGHTFIELDTRACER_H
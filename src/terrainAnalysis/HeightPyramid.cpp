@@ -0,0 +1,120 @@
+/**
+*******************************************************************************
+*
+*  @file       HeightPyramid.cpp
+*
+*  @brief      Class to store the minimum and maximum heights of the cells of a height map
+*				at several resolutions, to skip empty space when tracing rays
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <algorithm>
+#include <stdexcept>
+
+#include "HeightPyramid.h"
+#include "tools/ParallelTool.h"
+#include "tools/Instrumentation.h"
+
+//------------------------------------------------------------------------------
+HeightPyramid::HeightPyramid(Types::float_matrix const& heights, unsigned int n, unsigned int m):
+//------------------------------------------------------------------------------
+	m_maxLevels(),
+	m_minLevels()
+//------------------------------------------------------------------------------
+{
+	ScopedTimer timer("HeightPyramid::HeightPyramid");
+
+	if(n < 2 || m < 2 || heights.size() != n || heights[0].size() != m)
+		throw std::runtime_error("Wrong data, cannot create the height pyramid");
+
+	//the cells, between four pixels
+	m_maxLevels.push_back(Types::float_matrix(n - 1, Types::float_line(m - 1)));
+	m_minLevels.push_back(Types::float_matrix(n - 1, Types::float_line(m - 1)));
+	Types::float_matrix &maxCells(m_maxLevels.back()), &minCells(m_minLevels.back());
+
+	ParallelTool::performInParallel(
+		[&heights, &maxCells, &minCells, m](unsigned int leftIndex, unsigned int rightIndex)
+		{
+			for(unsigned int i(leftIndex); i < rightIndex; i++)
+			{
+				for(unsigned int j(0); j < m - 1; j++)
+				{
+					maxCells[i][j] = std::max(std::max(heights[i][j], heights[i][j + 1]),
+						std::max(heights[i + 1][j], heights[i + 1][j + 1]));
+					minCells[i][j] = std::min(std::min(heights[i][j], heights[i][j + 1]),
+						std::min(heights[i + 1][j], heights[i + 1][j + 1]));
+				}
+			}
+		},
+		0, n - 1);
+
+	//blocks of 2x2 blocks of the previous level, until one block is left
+	while(m_maxLevels.back().size() > 1 || m_maxLevels.back()[0].size() > 1)
+	{
+		Types::float_matrix const& previousMax(m_maxLevels.back());
+		Types::float_matrix const& previousMin(m_minLevels.back());
+		unsigned int previousRows((unsigned int)(previousMax.size())),
+			previousColumns((unsigned int)(previousMax[0].size()));
+
+		Types::float_matrix maxLevel((previousRows + 1) / 2, Types::float_line((previousColumns + 1) / 2));
+		Types::float_matrix minLevel(maxLevel);
+
+		for(unsigned int i(0); i < maxLevel.size(); i++)
+		{
+			for(unsigned int j(0); j < maxLevel[i].size(); j++)
+			{
+				//the last row and column may be alone
+				unsigned int lastRow(std::min(2 * i + 1, previousRows - 1)),
+					lastColumn(std::min(2 * j + 1, previousColumns - 1));
+
+				maxLevel[i][j] = std::max(std::max(previousMax[2 * i][2 * j], previousMax[2 * i][lastColumn]),
+					std::max(previousMax[lastRow][2 * j], previousMax[lastRow][lastColumn]));
+				minLevel[i][j] = std::min(std::min(previousMin[2 * i][2 * j], previousMin[2 * i][lastColumn]),
+					std::min(previousMin[lastRow][2 * j], previousMin[lastRow][lastColumn]));
+			}
+		}
+
+		m_maxLevels.push_back(std::move(maxLevel));
+		m_minLevels.push_back(std::move(minLevel));
+	}
+}
+
+//------------------------------------------------------------------------------
+float HeightPyramid::getMax(unsigned int level, unsigned int i, unsigned int j) const
+//------------------------------------------------------------------------------
+{
+	return m_maxLevels[level][i][j];
+}
+
+//------------------------------------------------------------------------------
+float HeightPyramid::getMin(unsigned int level, unsigned int i, unsigned int j) const
+//------------------------------------------------------------------------------
+{
+	return m_minLevels[level][i][j];
+}
+
+//------------------------------------------------------------------------------
+unsigned int HeightPyramid::getLevelCount() const
+//------------------------------------------------------------------------------
+{
+	return (unsigned int)(m_maxLevels.size());
+}
+
+//------------------------------------------------------------------------------
+unsigned int HeightPyramid::getRowCount(unsigned int level) const
+//------------------------------------------------------------------------------
+{
+	return (unsigned int)(m_maxLevels[level].size());
+}
+
+//------------------------------------------------------------------------------
+unsigned int HeightPyramid::getColumnCount(unsigned int level) const
+//------------------------------------------------------------------------------
+{
+	return (unsigned int)(m_maxLevels[level][0].size());
+}
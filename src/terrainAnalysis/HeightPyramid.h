@@ -0,0 +1,79 @@
+#ifndef HEIGHTPYRAMID_H
+#define HEIGHTPYRAMID_H
+
+/**
+*******************************************************************************
+*
+*  @file       HeightPyramid.h
+*
+*  @brief      Class to store the minimum and maximum heights of the cells of a height map
+*				at several resolutions, to skip empty space when tracing rays
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <vector>
+
+#include "tools/Types.h"
+
+//==============================================================================
+/**
+*  @class  HeightPyramid
+*  @brief  HeightPyramid is a class to store the minimum and maximum heights of the cells
+*			of a height map, then of the blocks of 2x2 cells, and so on
+*			until a single block covers the whole height map.
+*			A ray over the maximum of a block cannot hit it, a segment under
+*			the minimum of a block is hidden by it.
+*			A cell lies between four adjacent pixels, so the level 0 has (n-1)*(m-1) cells
+*/
+//==============================================================================
+class HeightPyramid
+{
+public:
+	/**
+	 * @brief HeightPyramid build all the levels
+	 * @param heights the heights of the pixels
+	 * @param n number of rows, at least 2
+	 * @param m number of columns, at least 2
+	 * @throws std::runtime_error if the size of the heights is not n*m
+	 */
+	HeightPyramid(Types::float_matrix const& heights, unsigned int n, unsigned int m);
+
+	/**
+	 * @brief getMax
+	 * @param level the level, 0 for the cells
+	 * @param i row of the block in the level
+	 * @param j column of the block in the level
+	 * @return the maximum height of the pixels at the corners of the cells of the block
+	 */
+	float getMax(unsigned int level, unsigned int i, unsigned int j) const;
+
+	/**
+	 * @brief getMin
+	 * @param level the level, 0 for the cells
+	 * @param i row of the block in the level
+	 * @param j column of the block in the level
+	 * @return the minimum height of the pixels at the corners of the cells of the block
+	 */
+	float getMin(unsigned int level, unsigned int i, unsigned int j) const;
+
+	//Getters
+	unsigned int getLevelCount() const;
+	unsigned int getRowCount(unsigned int level) const;
+	unsigned int getColumnCount(unsigned int level) const;
+
+//******************************************************************************
+private:
+	//No default constructor
+	HeightPyramid();
+
+	//maximum and minimum heights, from the cells to the whole height map
+	std::vector<Types::float_matrix> m_maxLevels,
+		m_minLevels;
+};
+
+#endif // HEIGHTPYRAMID_H
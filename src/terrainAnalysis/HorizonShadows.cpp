@@ -0,0 +1,330 @@
+/**
+*******************************************************************************
+*
+*  @file       HorizonShadows.cpp
+*
+*  @brief      Class to compute the hard shadows of a height map for a light
+*				direction on the CPU, by sweeping the grid along the light's azimuth
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <math.h>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "HorizonShadows.h"
+#include "tools/ParallelTool.h"
+#include "tools/Instrumentation.h"
+
+//******************************************************************************
+//  constant variables
+//******************************************************************************
+//Below this horizontal component, the light is considered vertical: nothing is shadowed
+const float VERTICAL_LIGHT_THRESHOLD = 1e-6f;
+
+//Part of a step under which a crossing is the one of the row: at a pixel,
+//the rounding errors would make its own triangles shadow it
+const float CROSSING_TOLERANCE = 1e-4f;
+
+//------------------------------------------------------------------------------
+Types::float_matrix HorizonShadows::computeShadowMask(Types::float_matrix const& heights,
+	unsigned int n, unsigned int m, QVector3D const& lightDir, float heightScale)
+//------------------------------------------------------------------------------
+{
+	ScopedTimer timer("HorizonShadows::computeShadowMask");
+
+	if(!n || !m || heights.size() != n || heights[0].size() != m)
+		throw std::runtime_error("Wrong data, cannot compute the shadows");
+
+	float horizontalLength(sqrtf(lightDir.x() * lightDir.x() + lightDir.y() * lightDir.y()));
+
+	//light under the horizon
+	if(lightDir.z() <= 0.f)
+		return Types::float_matrix(n, Types::float_line(m, 0.f));
+
+	if(horizontalLength <= VERTICAL_LIGHT_THRESHOLD * lightDir.length())
+		return Types::float_matrix(n, Types::float_line(m, 1.f));
+
+	Types::float_matrix mask(n, Types::float_line(m, 0.f));
+
+	//The rays advance one row along the major axis per step and
+	//less than one pixel along the minor axis
+	Sweep sweep;
+	sweep.isTransposed = fabsf(lightDir.y()) > fabsf(lightDir.x());
+	sweep.majorCount = sweep.isTransposed ? m : n;
+	sweep.minorCount = sweep.isTransposed ? n : m;
+
+	float majorLight(sweep.isTransposed ? lightDir.y() : lightDir.x()),
+		minorLight(sweep.isTransposed ? lightDir.x() : lightDir.y());
+
+	//The rays start from the side of the light and move away from it
+	sweep.isReversed = majorLight > 0.f;
+	sweep.slope = -minorLight / fabsf(majorLight);
+
+	//A light along an axis or a diagonal up to rounding errors follows it:
+	//otherwise the pixels on the borders would see it from just outside the grid
+	float roundedSlope(roundf(sweep.slope));
+
+	if(fabsf(roundedSlope) <= 1.f &&
+	   fabsf(sweep.slope - roundedSlope) * float(sweep.majorCount) < CROSSING_TOLERANCE)
+		sweep.slope = roundedSlope;
+
+	//the horizon goes down by the height of the light's ray over a step
+	sweep.horizonDrop = sqrtf(1.f + sweep.slope * sweep.slope) * lightDir.z() / horizontalLength;
+	sweep.heightScale = heightScale;
+
+	//Enough rays to cross every pixel, whatever the shift along the minor axis
+	float lastShift(sweep.slope * float(sweep.majorCount - 1));
+	int lastRay(int(ceilf(std::max(float(sweep.minorCount - 1), float(sweep.minorCount - 1) - lastShift))) + 1);
+	sweep.firstRay = int(floorf(std::min(0.f, -lastShift))) - 1;
+	sweep.rayCount = (unsigned int)(lastRay - sweep.firstRay + 1);
+
+	//the last ray is only used by the pixels before it
+	ParallelTool::performInParallel(
+		[&](unsigned int leftIndex, unsigned int rightIndex)
+		{
+			sweepRays(heights, mask, sweep, leftIndex, rightIndex);
+		},
+		0, sweep.rayCount - 1);
+
+	return mask;
+}
+
+//------------------------------------------------------------------------------
+void HorizonShadows::sweepRays(Types::float_matrix const& heights, Types::float_matrix &mask,
+	Sweep const& sweep, unsigned int leftIndex, unsigned int rightIndex)
+//------------------------------------------------------------------------------
+{
+	const float NONE(-std::numeric_limits<float>::infinity());
+
+	unsigned int rayCount(rightIndex + 1 - leftIndex), gapCount(rightIndex - leftIndex);
+	float lastMinor(float(sweep.minorCount - 1));
+	int majorStep(sweep.isReversed ? -1 : 1);
+
+	//highest line of sight towards the light above each ray, nothing blocks it before the grid
+	std::vector<float> horizons(rayCount, NONE);
+
+	//terrain of each ray on the current row, and highest terrain it crossed
+	//since the previous row, raised as the horizon
+	std::vector<float> rowHeights(rayCount, NONE), stripHeights(rayCount, NONE);
+
+	//Between two rays, the lines of the pixels only cross the triangles between
+	//the rays: their horizon is lower than the highest of these triangles.
+	//They also cross each row between the rays, where the terrain is linear but at a pixel:
+	//their horizon is higher than the lowest of the terrain there. On each row
+	Types::float_matrix upperHorizons(sweep.majorCount, Types::float_line(gapCount, NONE)),
+		lowerHorizons(sweep.majorCount, Types::float_line(gapCount, NONE));
+	std::vector<float> lowestOnRows(gapCount, NONE), previousPixelHeights(gapCount, NONE);
+
+	//the heights of the current row, height scale included
+	std::vector<float> pixelHeights(sweep.minorCount);
+
+	for(unsigned int step(0); step < sweep.majorCount; step++)
+	{
+		unsigned int major(sweep.isReversed ? sweep.majorCount - 1 - step : step);
+
+		//All the rays are shifted by the same amount on a row: each pixel
+		//lies between two rays, at the same distance from the first one
+		float shift(sweep.slope * float(step));
+		float floorShift(floorf(shift)), ceilShift(ceilf(shift));
+		float weight(shift - floorShift);
+
+		for(unsigned int minor(0); minor < sweep.minorCount; minor++)
+		{
+			pixelHeights[minor] = sweep.heightScale *
+				(sweep.isTransposed ? heights[minor][major] : heights[major][minor]);
+		}
+
+		//the terrain is linear along the row
+		for(unsigned int ray(0); ray < rayCount; ray++)
+		{
+			int left(sweep.firstRay + int(leftIndex + ray) + int(floorShift));
+
+			if(left < 0 || left >= int(sweep.minorCount) || (left + 1 == int(sweep.minorCount) && weight > 0.f))
+				rowHeights[ray] = NONE;
+			else if(weight > 0.f)
+				rowHeights[ray] = pixelHeights[left] + weight * (pixelHeights[left + 1] - pixelHeights[left]);
+			else
+				rowHeights[ray] = pixelHeights[left];
+		}
+
+		for(unsigned int gap(0); gap < gapCount; gap++)
+		{
+			int pixel(sweep.firstRay + int(leftIndex + gap) + int(ceilShift));
+			bool isInside(pixel >= 0 && pixel < int(sweep.minorCount));
+			float pixelHeight(isInside ? pixelHeights[pixel] : NONE);
+
+			//the highest terrain between the rays is on them, or on the rows at the pixels
+			if(step > 0)
+			{
+				float stripHeight(std::max(std::max(stripHeights[gap], stripHeights[gap + 1]),
+					previousPixelHeights[gap]));
+				float rowHeight(std::max(std::max(rowHeights[gap], rowHeights[gap + 1]), pixelHeight));
+
+				upperHorizons[step][gap] = std::max(std::max(upperHorizons[step - 1][gap], stripHeight)
+					- sweep.horizonDrop, rowHeight);
+				lowerHorizons[step][gap] = std::max(lowerHorizons[step - 1][gap], lowestOnRows[gap])
+					- sweep.horizonDrop;
+			}
+
+			if(isInside)
+			{
+				bool isPixelLit;
+
+				//on the ray, its horizon is exact
+				if(ceilShift == shift)
+					isPixelLit = pixelHeight >= horizons[gap];
+				else
+					isPixelLit = isLit(heights, sweep, upperHorizons, lowerHorizons, step, gap, pixel);
+
+				if(sweep.isTransposed)
+					mask[pixel][major] = isPixelLit ? 1.f : 0.f;
+				else
+					mask[major][pixel] = isPixelLit ? 1.f : 0.f;
+			}
+
+			lowestOnRows[gap] = rowHeights[gap] != NONE && rowHeights[gap + 1] != NONE ?
+				std::min(std::min(rowHeights[gap], rowHeights[gap + 1]), pixelHeight) : NONE;
+			previousPixelHeights[gap] = pixelHeight;
+		}
+
+		//the terrain under the rays blocks the light for the next rows
+		for(unsigned int ray(0); ray < rayCount; ray++)
+		{
+			float &horizon(horizons[ray]);
+			float &stripHeight(stripHeights[ray]);
+			float position(float(sweep.firstRay + int(leftIndex + ray)) + shift);
+
+			stripHeight = rowHeights[ray];
+
+			//where the ray crosses a column or a diagonal, the triangle changes
+			auto addCrossing = [&](float part)
+				{
+					float crossingMinor(position + part * sweep.slope);
+
+					if(crossingMinor >= 0.f && crossingMinor <= lastMinor)
+					{
+						stripHeight = std::max(stripHeight, getHeight(heights, sweep,
+							float(major) + part * float(majorStep), crossingMinor) + part * sweep.horizonDrop);
+					}
+				};
+
+			if(step + 1 < sweep.majorCount)
+			{
+				//the diagonals of the cells go from (i,j) to (i+1,j+1), as in HeightMapMesh
+				forEachCrossing(position, position + sweep.slope, addCrossing);
+				forEachCrossing(float(major) - position,
+					float(int(major) + majorStep) - position - sweep.slope, addCrossing);
+			}
+
+			horizon = std::max(horizon, stripHeight) - sweep.horizonDrop;
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+template<class F> void HorizonShadows::forEachCrossing(float value, float nextValue, F const& functor)
+//------------------------------------------------------------------------------
+{
+	float lowest(std::min(value, nextValue)), highest(std::max(value, nextValue));
+
+	for(float crossed(floorf(lowest) + 1.f); crossed < highest; crossed++)
+	{
+		float part((crossed - value) / (nextValue - value));
+
+		if(part > CROSSING_TOLERANCE && part < 1.f - CROSSING_TOLERANCE)
+			functor(part);
+	}
+}
+
+//------------------------------------------------------------------------------
+bool HorizonShadows::isLit(Types::float_matrix const& heights, Sweep const& sweep,
+	Types::float_matrix const& upperHorizons, Types::float_matrix const& lowerHorizons,
+	unsigned int step, unsigned int gap, int pixel)
+//------------------------------------------------------------------------------
+{
+	float lastMinor(float(sweep.minorCount - 1));
+	int majorStep(sweep.isReversed ? 1 : -1);
+	int row(sweep.isReversed ? int(sweep.majorCount - 1 - step) : int(step));
+	float pixelHeight(getHeight(heights, sweep, float(row), float(pixel)));
+	bool isBlocked(false);
+
+	//The triangles are planar and the line straight between two crossings:
+	//the line only has to be above the triangles at the crossings, from one row
+	//to the next towards the light, until the bounds of the horizon of a row decide
+	for(unsigned int back(0); !isBlocked; back++, row += majorStep)
+	{
+		float lineHeight(pixelHeight + float(back) * sweep.horizonDrop);
+
+		//nothing is behind the first row, its upper bound decides
+		if(lineHeight >= upperHorizons[step - back][gap])
+			return true;
+
+		if(lineHeight < lowerHorizons[step - back][gap])
+			return false;
+
+		int nextRow(row + majorStep);
+		float position(float(pixel) - float(back) * sweep.slope), nextPosition(position - sweep.slope);
+
+		auto checkPoint = [&](float part, float pointMinor)
+			{
+				if(getHeight(heights, sweep, float(row) + part * float(majorStep), pointMinor) >
+					lineHeight + part * sweep.horizonDrop)
+					isBlocked = true;
+			};
+
+		auto checkCrossing = [&](float part)
+			{
+				float crossingMinor(position - part * sweep.slope);
+
+				if(crossingMinor >= 0.f && crossingMinor <= lastMinor)
+					checkPoint(part, crossingMinor);
+			};
+
+		forEachCrossing(position, nextPosition, checkCrossing);
+		forEachCrossing(float(row) - position, float(nextRow) - nextPosition, checkCrossing);
+
+		//the line leaves the grid by a side, the crossing may be too close to the row to be checked
+		if(nextPosition < 0.f || nextPosition > lastMinor)
+		{
+			float border(nextPosition < 0.f ? 0.f : lastMinor);
+
+			checkPoint((border - position) / (nextPosition - position), border);
+
+			return !isBlocked;
+		}
+
+		checkPoint(1.f, nextPosition);
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------
+float HorizonShadows::getHeight(Types::float_matrix const& heights, Sweep const& sweep,
+	float major, float minor)
+//------------------------------------------------------------------------------
+{
+	float x(sweep.isTransposed ? minor : major), y(sweep.isTransposed ? major : minor);
+	unsigned int n((unsigned int)(heights.size())), m((unsigned int)(heights[0].size()));
+
+	//the cell containing the point, the last row and column belong to the previous cells
+	unsigned int i(std::min((unsigned int)(std::max(x, 0.f)), n > 1 ? n - 2 : 0)),
+		j(std::min((unsigned int)(std::max(y, 0.f)), m > 1 ? m - 2 : 0));
+	unsigned int nextI(std::min(i + 1, n - 1)), nextJ(std::min(j + 1, m - 1));
+	float u(x - float(i)), v(y - float(j));
+
+	float h1(heights[i][j]), h2(heights[nextI][j]), h3(heights[nextI][nextJ]), h4(heights[i][nextJ]);
+
+	//the two triangles of the cell, on each side of its diagonal
+	if(u >= v)
+		return sweep.heightScale * (h1 + u * (h2 - h1) + v * (h3 - h2));
+	else
+		return sweep.heightScale * (h1 + v * (h4 - h1) + u * (h3 - h4));
+}
@@ -0,0 +1,133 @@
+#ifndef HORIZONSHADOWS_H
+#define HORIZONSHADOWS_H
+
+/**
+*******************************************************************************
+*
+*  @file       HorizonShadows.h
+*
+*  @brief      Class to compute the hard shadows of a height map for a light
+*				direction on the CPU, by sweeping the grid along the light's azimuth
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <QVector3D>
+
+#include "tools/Types.h"
+
+//==============================================================================
+/**
+*  @class  HorizonShadows
+*  @brief  HorizonShadows is a class to compute which pixels of a height map
+*			are lit by a directional light, exactly for the triangles of HeightMapMesh.
+*			Rays parallel to the light's azimuth cross the grid one row (or column)
+*			at a time and keep the height of their horizon, so that each direction
+*			costs O(n*m), without depth buffer nor bias.
+*			A pixel between two rays gets bounds of its horizon from the terrain
+*			between them, and only follows its own line towards the light
+*			when the bounds do not decide.
+*			The rays are independent and processed in parallel
+*/
+//==============================================================================
+class HorizonShadows
+{
+public:
+	/**
+	 * @brief computeShadowMask compute the shadows cast by the height map on itself
+	 * @param heights the heights in the [0,1] range, the first index is x and the second is y
+	 * @param n number of rows
+	 * @param m number of columns
+	 * @param lightDir the direction from the pixels to the light
+	 * @param heightScale height of a pixel of value 1, in units of the distance between two pixels
+	 * @return a n*m matrix containing 1 for the lit pixels and 0 for the shadowed ones
+	 * @throws std::runtime_error if the size of the heights is not n*m
+	 */
+	static Types::float_matrix computeShadowMask(Types::float_matrix const& heights,
+		unsigned int n, unsigned int m, QVector3D const& lightDir, float heightScale);
+
+//******************************************************************************
+private:
+	//No instance
+	HorizonShadows();
+
+	///@cond
+	/**
+	 * @brief The Sweep struct describes the rays of a light direction, in the coordinates
+	 * of the major axis, the one closest to the light's azimuth
+	 */
+	struct Sweep
+	{
+		//the major axis is y instead of x
+		bool isTransposed;
+
+		unsigned int majorCount, minorCount;
+
+		//the rays start from the last row
+		bool isReversed;
+
+		//move of the rays along the minor axis per row
+		float slope;
+
+		//height lost by the horizon over a row
+		float horizonDrop;
+
+		float heightScale;
+
+		//minor coordinate of the first ray at the first row
+		int firstRay;
+
+		unsigned int rayCount;
+	};
+	///@endcond
+
+	/**
+	 * @brief sweepRays march a block of rays along the major axis, in lockstep
+	 * so that each row is read contiguously
+	 * @param leftIndex first ray of the block
+	 * @param rightIndex one past the last ray of the block,
+	 * the pixels between the last ray and the next one are written too
+	 */
+	static void sweepRays(Types::float_matrix const& heights, Types::float_matrix &mask,
+		Sweep const& sweep, unsigned int leftIndex, unsigned int rightIndex);
+
+	/**
+	 * @brief forEachCrossing call a functor where a value varying linearly over a step
+	 * crosses an integer, a column or a diagonal of the grid
+	 * @param value the value at the beginning of the step
+	 * @param nextValue the value at the end of the step
+	 * @param functor called with the part of the step done at each crossing, in ]0,1[,
+	 * but not too close to the rows
+	 */
+	template<class F> static void forEachCrossing(float value, float nextValue, F const& functor);
+
+	/**
+	 * @brief isLit follow the line from a pixel between two rays towards the light,
+	 * until the bounds of the horizon of the row reached decide
+	 * @param upperHorizons for each step and each gap between two rays of the block,
+	 * the horizon of the pixels between the rays is lower
+	 * @param lowerHorizons the horizon of the pixels between the rays is higher
+	 * @param step the step of the row of the pixel
+	 * @param gap the first ray before the pixel, in the block
+	 * @param pixel the minor coordinate of the pixel
+	 * @return true if no triangle lies above the line
+	 */
+	static bool isLit(Types::float_matrix const& heights, Sweep const& sweep,
+		Types::float_matrix const& upperHorizons, Types::float_matrix const& lowerHorizons,
+		unsigned int step, unsigned int gap, int pixel);
+
+	/**
+	 * @brief getHeight height of the triangles of HeightMapMesh at a point of the grid
+	 * @param major major coordinate of the point, in [0,majorCount-1]
+	 * @param minor minor coordinate of the point, in [0,minorCount-1]
+	 * @return the height of the surface, height scale included
+	 */
+	static float getHeight(Types::float_matrix const& heights, Sweep const& sweep,
+		float major, float minor);
+};
+
+#endif // HORIZONSHADOWS_H
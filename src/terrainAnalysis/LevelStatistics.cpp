@@ -0,0 +1,158 @@
+/**
+*******************************************************************************
+*
+*  @file       LevelStatistics.cpp
+*
+*  @brief      Class to know the area and the volume of a height map
+*				above any level
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+#include "LevelStatistics.h"
+#include "tools/ParallelTool.h"
+#include "tools/Instrumentation.h"
+
+//******************************************************************************
+//  constant variables
+//******************************************************************************
+//Number of sorted heights per partial sum: a query sums at most this many heights
+const unsigned int BLOCK_SIZE = 64;
+
+//------------------------------------------------------------------------------
+LevelStatistics::LevelStatistics(Types::float_matrix const& heights, unsigned int n, unsigned int m):
+//------------------------------------------------------------------------------
+	m_sortedHeights(),
+	m_blockSums()
+//------------------------------------------------------------------------------
+{
+	ScopedTimer timer("LevelStatistics::LevelStatistics");
+
+	if(!n || !m || heights.size() != n || heights[0].size() != m)
+		throw std::runtime_error("Wrong data, cannot sort the heights");
+
+	m_sortedHeights.resize((unsigned long long)(n) * m);
+
+	//Each thread sorts its rows, the sorted ranges are then merged two by two
+	std::vector<std::pair<unsigned int, unsigned int>> ranges;
+	std::mutex rangesMutex;
+
+	ParallelTool::performInParallel(
+		[&](unsigned int leftIndex, unsigned int rightIndex)
+		{
+			auto first(m_sortedHeights.begin() + (long long)(leftIndex) * m);
+
+			for(unsigned int i(leftIndex); i < rightIndex; i++)
+				std::copy(heights[i].begin(), heights[i].end(), m_sortedHeights.begin() + (long long)(i) * m);
+
+			std::sort(first, m_sortedHeights.begin() + (long long)(rightIndex) * m);
+
+			std::lock_guard<std::mutex> lock(rangesMutex);
+			ranges.push_back(std::make_pair(leftIndex, rightIndex));
+		},
+		0, n);
+
+	std::sort(ranges.begin(), ranges.end());
+
+	while(ranges.size() > 1)
+	{
+		std::vector<std::pair<unsigned int, unsigned int>> merged((ranges.size() + 1) / 2);
+
+		ParallelTool::performInParallel(
+			[&](unsigned int leftIndex, unsigned int rightIndex)
+			{
+				for(unsigned int pair(leftIndex); pair < rightIndex; pair++)
+				{
+					std::pair<unsigned int, unsigned int> const& left(ranges[2 * pair]);
+
+					if(2 * pair + 1 < ranges.size())
+					{
+						std::pair<unsigned int, unsigned int> const& right(ranges[2 * pair + 1]);
+
+						std::inplace_merge(m_sortedHeights.begin() + (long long)(left.first) * m,
+										   m_sortedHeights.begin() + (long long)(right.first) * m,
+										   m_sortedHeights.begin() + (long long)(right.second) * m);
+
+						merged[pair] = std::make_pair(left.first, right.second);
+					}
+					else
+					{
+						merged[pair] = left;
+					}
+				}
+			},
+			0, (unsigned int)(merged.size()));
+
+		ranges.swap(merged);
+	}
+
+	//the sums in double, the float would lose the small heights of a large image
+	unsigned long long blockCount((m_sortedHeights.size() + BLOCK_SIZE - 1) / BLOCK_SIZE);
+	m_blockSums.resize(blockCount + 1);
+	m_blockSums[0] = 0.;
+
+	for(unsigned long long block(0); block < blockCount; block++)
+	{
+		double sum(0.);
+		unsigned long long last(std::min((block + 1) * BLOCK_SIZE, (unsigned long long)(m_sortedHeights.size())));
+
+		for(unsigned long long index(block * BLOCK_SIZE); index < last; index++)
+			sum += m_sortedHeights[index];
+
+		m_blockSums[block + 1] = m_blockSums[block] + sum;
+	}
+}
+
+//------------------------------------------------------------------------------
+unsigned long long LevelStatistics::getPixelCountAbove(float level) const
+//------------------------------------------------------------------------------
+{
+	return (unsigned long long)(m_sortedHeights.end() -
+		std::upper_bound(m_sortedHeights.begin(), m_sortedHeights.end(), level));
+}
+
+//------------------------------------------------------------------------------
+float LevelStatistics::getAreaAbove(float level) const
+//------------------------------------------------------------------------------
+{
+	return float(double(getPixelCountAbove(level)) / double(m_sortedHeights.size()));
+}
+
+//------------------------------------------------------------------------------
+double LevelStatistics::getVolumeAbove(float level) const
+//------------------------------------------------------------------------------
+{
+	unsigned long long countAbove(getPixelCountAbove(level));
+	unsigned long long index(m_sortedHeights.size() - countAbove);
+
+	return (m_blockSums.back() - getSumBelow(index)) - double(level) * double(countAbove);
+}
+
+//------------------------------------------------------------------------------
+unsigned long long LevelStatistics::getPixelCount() const
+//------------------------------------------------------------------------------
+{
+	return m_sortedHeights.size();
+}
+
+//------------------------------------------------------------------------------
+double LevelStatistics::getSumBelow(unsigned long long index) const
+//------------------------------------------------------------------------------
+{
+	unsigned long long block(index / BLOCK_SIZE);
+	double sum(m_blockSums[block]);
+
+	for(unsigned long long i(block * BLOCK_SIZE); i < index; i++)
+		sum += m_sortedHeights[i];
+
+	return sum;
+}
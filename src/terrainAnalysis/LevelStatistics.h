@@ -0,0 +1,92 @@
+#ifndef LEVELSTATISTICS_H
+#define LEVELSTATISTICS_H
+
+/**
+*******************************************************************************
+*
+*  @file       LevelStatistics.h
+*
+*  @brief      Class to know the area and the volume of a height map
+*				above any level
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <vector>
+
+#include "tools/Types.h"
+
+//==============================================================================
+/**
+*  @class  LevelStatistics
+*  @brief  LevelStatistics is a class to answer how many pixels and how much
+*			volume lie above a level, for the lvl plan.
+*			The heights are sorted once, in parallel, and the sums of the sorted
+*			heights are kept at the start of each block of them:
+*			a query is a binary search and the sum of the end of a block.
+*/
+//==============================================================================
+class LevelStatistics
+{
+public:
+	/**
+	 * @brief LevelStatistics sort the heights
+	 * @param heights the heights of the pixels
+	 * @param n number of rows
+	 * @param m number of columns
+	 * @throws std::runtime_error if the size of the heights is not n*m or if it is empty
+	 */
+	LevelStatistics(Types::float_matrix const& heights, unsigned int n, unsigned int m);
+
+	/**
+	 * @brief getPixelCountAbove
+	 * @param level a value of the pixels
+	 * @return the number of pixels higher than the level
+	 */
+	unsigned long long getPixelCountAbove(float level) const;
+
+	/**
+	 * @brief getAreaAbove
+	 * @param level a value of the pixels
+	 * @return the fraction of the pixels higher than the level, in the [0,1] range
+	 */
+	float getAreaAbove(float level) const;
+
+	/**
+	 * @brief getVolumeAbove
+	 * @param level a value of the pixels
+	 * @return the sum over the pixels higher than the level of their height above it,
+	 * in units of the values of the pixels times the area of a pixel
+	 */
+	double getVolumeAbove(float level) const;
+
+	/**
+	 * @brief getPixelCount
+	 * @return the number of pixels of the height map
+	 */
+	unsigned long long getPixelCount() const;
+
+//******************************************************************************
+private:
+	//No default constructor
+	LevelStatistics();
+
+	/**
+	 * @brief getSumBelow
+	 * @param index number of sorted heights to sum
+	 * @return the sum of the lowest heights
+	 */
+	double getSumBelow(unsigned long long index) const;
+
+	//heights of all the pixels, in ascending order
+	std::vector<float> m_sortedHeights;
+
+	//sum of the sorted heights before each block, and of all of them at the end
+	std::vector<double> m_blockSums;
+};
+
+#endif // LEVELSTATISTICS_H
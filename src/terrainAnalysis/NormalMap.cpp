@@ -0,0 +1,94 @@
+/**
+*******************************************************************************
+*
+*  @file       NormalMap.cpp
+*
+*  @brief      Class to bake the normal vectors of a height map on the CPU,
+*				packed in two bytes per pixel
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <math.h>
+#include <algorithm>
+#include <stdexcept>
+
+#include "NormalMap.h"
+#include "tools/ParallelTool.h"
+#include "tools/Instrumentation.h"
+
+//------------------------------------------------------------------------------
+std::vector<unsigned char> NormalMap::bake(Types::float_matrix const& heights, unsigned int n, unsigned int m,
+	float heightScale)
+//------------------------------------------------------------------------------
+{
+	ScopedTimer timer("NormalMap::bake");
+
+	if(n < 2 || m < 2 || heights.size() != n || heights[0].size() != m)
+		throw std::runtime_error("Wrong data, cannot compute the normal map");
+
+	std::vector<unsigned char> texels(size_t(n) * m * 2);
+
+	ParallelTool::performInParallel(
+		[&](unsigned int leftIndex, unsigned int rightIndex)
+		{
+			bakeRows(heights, texels, n, m, heightScale, leftIndex, rightIndex);
+		},
+		0, n);
+
+	return texels;
+}
+
+//------------------------------------------------------------------------------
+QVector3D NormalMap::unpack(unsigned char x, unsigned char y)
+//------------------------------------------------------------------------------
+{
+	float normalX(float(x) / 127.5f - 1.f), normalY(float(y) / 127.5f - 1.f);
+
+	//the rounding of the bytes may give a length slightly above 1
+	float normalZ(sqrtf(std::max(0.f, 1.f - normalX * normalX - normalY * normalY)));
+
+	return QVector3D(normalX, normalY, normalZ).normalized();
+}
+
+//------------------------------------------------------------------------------
+void NormalMap::bakeRows(Types::float_matrix const& heights, std::vector<unsigned char> &texels,
+	unsigned int n, unsigned int m, float heightScale, unsigned int leftIndex, unsigned int rightIndex)
+//------------------------------------------------------------------------------
+{
+	auto toByte = [](float value)
+		{
+			return (unsigned char)(std::min(std::max(value * 127.5f + 127.5f, 0.f), 255.f) + 0.5f);
+		};
+
+	for(unsigned int i(leftIndex); i < rightIndex; i++)
+	{
+		//the previous and the next rows, the row itself on the borders
+		unsigned int previousI(i ? i - 1 : i), nextI(std::min(i + 1, n - 1));
+		float rowScale(heightScale / float(nextI - previousI));
+
+		float const* previousRow(heights[previousI].data());
+		float const* row(heights[i].data());
+		float const* nextRow(heights[nextI].data());
+		unsigned char *rowTexels(texels.data() + size_t(i) * m * 2);
+
+		for(unsigned int j(0); j < m; j++)
+		{
+			unsigned int previousJ(j ? j - 1 : j), nextJ(std::min(j + 1, m - 1));
+
+			//slopes along the rows and the columns, in units of the distance between two pixels
+			float slopeX((nextRow[j] - previousRow[j]) * rowScale);
+			float slopeY((row[nextJ] - row[previousJ]) * heightScale / float(nextJ - previousJ));
+
+			//normalized (-slopeX, -slopeY, 1)
+			float inverseLength(1.f / sqrtf(slopeX * slopeX + slopeY * slopeY + 1.f));
+
+			rowTexels[2 * j] = toByte(-slopeX * inverseLength);
+			rowTexels[2 * j + 1] = toByte(-slopeY * inverseLength);
+		}
+	}
+}
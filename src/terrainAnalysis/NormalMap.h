@@ -0,0 +1,72 @@
+#ifndef NORMALMAP_H
+#define NORMALMAP_H
+
+/**
+*******************************************************************************
+*
+*  @file       NormalMap.h
+*
+*  @brief      Class to bake the normal vectors of a height map on the CPU,
+*				packed in two bytes per pixel
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include "tools/Types.h"
+
+//==============================================================================
+/**
+*  @class  NormalMap
+*  @brief  NormalMap is a class to compute the normal vector of each pixel
+*			of a height map from the slopes towards its neighbours, one sided
+*			on the borders.
+*			The normals of a height map always point up: only x and y are kept,
+*			in one byte each, and z is found back from their length.
+*			The texels follow the rows of the image, ready for a RG8 texture,
+*			so that a decimated mesh keeps the lighting of the full resolution.
+*			The rows are processed in parallel
+*/
+//==============================================================================
+class NormalMap
+{
+public:
+	/**
+	 * @brief bake compute the packed normal vectors of the height map
+	 * @param heights the heights in the [0,1] range
+	 * @param n number of rows
+	 * @param m number of columns
+	 * @param heightScale height of a pixel of value 1, in units of the distance between two pixels
+	 * @return 2*n*m bytes, x then y of the normal of each pixel mapped from [-1,1] to [0,255],
+	 * the pixel (i,j) at 2*(i*m+j)
+	 * @throws std::runtime_error if the size of the heights is not n*m or if n or m is less than 2
+	 */
+	static std::vector<unsigned char> bake(Types::float_matrix const& heights, unsigned int n, unsigned int m,
+		float heightScale);
+
+	/**
+	 * @brief unpack find the normal vector back from its two bytes, as the display shader
+	 * @param x first byte of the pixel
+	 * @param y second byte of the pixel
+	 * @return the normal vector, of length 1
+	 */
+	static QVector3D unpack(unsigned char x, unsigned char y);
+
+//******************************************************************************
+private:
+	//No instance
+	NormalMap();
+
+	/**
+	 * @brief bakeRows compute the packed normal vectors of some rows
+	 * @param leftIndex first row
+	 * @param rightIndex one past the last row
+	 */
+	static void bakeRows(Types::float_matrix const& heights, std::vector<unsigned char> &texels,
+		unsigned int n, unsigned int m, float heightScale, unsigned int leftIndex, unsigned int rightIndex);
+};
+
+#endif // NORMALMAP_H
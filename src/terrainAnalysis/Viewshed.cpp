@@ -0,0 +1,270 @@
+/**
+*******************************************************************************
+*
+*  @file       Viewshed.cpp
+*
+*  @brief      Class to compute which pixels of a height map an observer sees,
+*				by radial sweeps from the observer
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <math.h>
+#include <cstdlib>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "Viewshed.h"
+#include "tools/ParallelTool.h"
+#include "tools/Instrumentation.h"
+
+//------------------------------------------------------------------------------
+Types::float_matrix Viewshed::compute(Types::float_matrix const& heights, unsigned int n, unsigned int m,
+	unsigned int observerI, unsigned int observerJ, float observerHeight, float heightScale,
+	Algorithm algorithm)
+//------------------------------------------------------------------------------
+{
+	ScopedTimer timer("Viewshed::compute");
+
+	if(!n || !m || heights.size() != n || heights[0].size() != m)
+		throw std::runtime_error("Wrong data, cannot compute the viewshed");
+
+	if(observerI >= n || observerJ >= m)
+		throw std::runtime_error("The observer is outside of the height map");
+
+	float observerZ(heights[observerI][observerJ] * heightScale + observerHeight);
+
+	Types::float_matrix visibility(n, Types::float_line(m, 0.f));
+	visibility[observerI][observerJ] = 1.f;
+
+	if(algorithm == R3)
+	{
+		ParallelTool::performInParallel(
+			[&](unsigned int leftIndex, unsigned int rightIndex)
+			{
+				traceRows(heights, visibility, m, observerI, observerJ, observerZ, heightScale,
+						  leftIndex, rightIndex);
+			},
+			0, n);
+	}
+	else if(algorithm == R2)
+	{
+		//the rays of an octant are independent
+		for(Octant const& octant : getOctants(n, m, observerI, observerJ))
+		{
+			ParallelTool::performInParallel(
+				[&](unsigned int leftIndex, unsigned int rightIndex)
+				{
+					sweepRays(heights, visibility, octant, observerI, observerJ, observerZ, heightScale,
+							  leftIndex, rightIndex);
+				},
+				0, octant.ringCount + 1);
+		}
+	}
+	else
+	{
+		//the rings depend on each other, the octants do not: the octants are split between the threads
+		std::vector<Octant> octants(getOctants(n, m, observerI, observerJ));
+
+		ParallelTool::performInParallel(
+			[&](unsigned int leftIndex, unsigned int rightIndex)
+			{
+				for(unsigned int octant(leftIndex); octant < rightIndex; octant++)
+				{
+					sweepRings(heights, visibility, octants[octant], observerI, observerJ, observerZ,
+							   heightScale);
+				}
+			},
+			0, (unsigned int)(octants.size()));
+	}
+
+	return visibility;
+}
+
+//------------------------------------------------------------------------------
+std::vector<Viewshed::Octant> Viewshed::getOctants(unsigned int n, unsigned int m,
+												   unsigned int observerI, unsigned int observerJ)
+//------------------------------------------------------------------------------
+{
+	std::vector<Octant> octants;
+
+	for(bool isTransposed : {false, true})
+	{
+		unsigned int majorCount(isTransposed ? m : n), minorCount(isTransposed ? n : m);
+		unsigned int majorObserver(isTransposed ? observerJ : observerI),
+			minorObserver(isTransposed ? observerI : observerJ);
+
+		for(int majorSign : {1, -1})
+		{
+			for(int minorSign : {1, -1})
+			{
+				unsigned int ringCount(majorSign > 0 ? majorCount - 1 - majorObserver : majorObserver);
+				unsigned int minorLimit(minorSign > 0 ? minorCount - 1 - minorObserver : minorObserver);
+
+				//the observer is on the border
+				if(ringCount)
+					octants.push_back({isTransposed, majorSign, minorSign, ringCount, minorLimit});
+			}
+		}
+	}
+
+	return octants;
+}
+
+//------------------------------------------------------------------------------
+bool Viewshed::isOwned(Octant const& octant, unsigned int k, unsigned int q)
+//------------------------------------------------------------------------------
+{
+	//the axis belongs to the octant on its positive side, the diagonal to the octant along the rows
+	return (q > 0 || octant.minorSign > 0) && (q < k || !octant.isTransposed);
+}
+
+//------------------------------------------------------------------------------
+void Viewshed::sweepRays(Types::float_matrix const& heights, Types::float_matrix &visibility,
+	Octant const& octant, unsigned int observerI, unsigned int observerJ,
+	float observerZ, float heightScale, unsigned int leftIndex, unsigned int rightIndex)
+//------------------------------------------------------------------------------
+{
+	unsigned long long ringCount(octant.ringCount);
+
+	for(unsigned int ray(leftIndex); ray < rightIndex; ray++)
+	{
+		//length of the ray for each ring crossed
+		float ringDistance(sqrtf(1.f + float(ray) * float(ray) / float(ringCount * ringCount)));
+
+		float horizon(-std::numeric_limits<float>::infinity());
+
+		for(unsigned int k(1); k <= ringCount; k++)
+		{
+			//the ray crosses the ring k at k * ray / ringCount, in the pixel q
+			float position(float(k) * float(ray) / float(ringCount));
+			unsigned int q((unsigned int)((2 * k * ray + ringCount) / (2 * ringCount)));
+
+			if(q > octant.minorLimit)
+				break;
+
+			int major(octant.majorSign * int(k)), minor(octant.minorSign * int(q));
+			unsigned int i(octant.isTransposed ? observerI + minor : observerI + major);
+			unsigned int j(octant.isTransposed ? observerJ + major : observerJ + minor);
+
+			//Each pixel is set by the ray that passes closest to its center, so by a single thread
+			unsigned int closestRay((unsigned int)((2 * q * ringCount + k) / (2 * k)));
+
+			if(closestRay == ray && isOwned(octant, k, q))
+			{
+				float slope((heights[i][j] * heightScale - observerZ) / sqrtf(float(k) * k + float(q) * q));
+				visibility[i][j] = slope >= horizon ? 1.f : 0.f;
+			}
+
+			//The horizon is the terrain where the ray crosses the ring, between two pixels
+			unsigned int lower((unsigned int)(position));
+			unsigned int upper(std::min(lower + 1, octant.minorLimit));
+			float weight(position - float(lower));
+
+			int lowerMinor(octant.minorSign * int(lower)), upperMinor(octant.minorSign * int(upper));
+			float lowerHeight(octant.isTransposed ? heights[observerI + lowerMinor][observerJ + major] :
+												   heights[observerI + major][observerJ + lowerMinor]);
+			float upperHeight(octant.isTransposed ? heights[observerI + upperMinor][observerJ + major] :
+												   heights[observerI + major][observerJ + upperMinor]);
+
+			float height(lowerHeight + weight * (upperHeight - lowerHeight));
+			horizon = std::max(horizon, (height * heightScale - observerZ) / (float(k) * ringDistance));
+		}
+	}
+}
+
+//------------------------------------------------------------------------------
+void Viewshed::sweepRings(Types::float_matrix const& heights, Types::float_matrix &visibility,
+	Octant const& octant, unsigned int observerI, unsigned int observerJ,
+	float observerZ, float heightScale)
+//------------------------------------------------------------------------------
+{
+	//highest slope between the observer and each pixel of the previous and of the current ring
+	Types::float_line previousHorizons(octant.minorLimit + 1), horizons(octant.minorLimit + 1);
+
+	for(unsigned int k(1); k <= octant.ringCount; k++)
+	{
+		unsigned int lastQ(std::min(k, octant.minorLimit));
+		unsigned int previousLastQ(std::min(k - 1, octant.minorLimit));
+		int major(octant.majorSign * int(k));
+
+		for(unsigned int q(0); q <= lastQ; q++)
+		{
+			int minor(octant.minorSign * int(q));
+			unsigned int i(octant.isTransposed ? observerI + minor : observerI + major);
+			unsigned int j(octant.isTransposed ? observerJ + major : observerJ + minor);
+
+			float slope((heights[i][j] * heightScale - observerZ) / sqrtf(float(k) * k + float(q) * q));
+
+			//the line of sight crosses the previous ring between two of its pixels
+			float horizon(-std::numeric_limits<float>::infinity());
+
+			if(k > 1)
+			{
+				float position(float(q) * float(k - 1) / float(k));
+				unsigned int lower((unsigned int)(position));
+				unsigned int upper(std::min(lower + 1, previousLastQ));
+				float weight(position - float(lower));
+
+				horizon = previousHorizons[lower] + weight * (previousHorizons[upper] - previousHorizons[lower]);
+			}
+
+			if(isOwned(octant, k, q))
+				visibility[i][j] = slope >= horizon ? 1.f : 0.f;
+
+			horizons[q] = std::max(slope, horizon);
+		}
+
+		std::swap(previousHorizons, horizons);
+	}
+}
+
+//------------------------------------------------------------------------------
+void Viewshed::traceRows(Types::float_matrix const& heights, Types::float_matrix &visibility,
+	unsigned int m, unsigned int observerI, unsigned int observerJ,
+	float observerZ, float heightScale, unsigned int leftIndex, unsigned int rightIndex)
+//------------------------------------------------------------------------------
+{
+	for(unsigned int i(leftIndex); i < rightIndex; i++)
+	{
+		for(unsigned int j(0); j < m; j++)
+		{
+			int di(int(i) - int(observerI)), dj(int(j) - int(observerJ));
+			unsigned int k((unsigned int)(std::max(std::abs(di), std::abs(dj))));
+
+			if(!k)
+				continue;
+
+			//the line of sight crosses the rows (or the columns) between the observer and the pixel
+			bool isTransposed(std::abs(dj) > std::abs(di));
+			int majorSign(isTransposed ? (dj > 0 ? 1 : -1) : (di > 0 ? 1 : -1));
+			float minorStep(float(isTransposed ? di : dj) / float(k));
+			float stepDistance(sqrtf(1.f + minorStep * minorStep));
+
+			float horizon(-std::numeric_limits<float>::infinity());
+
+			for(unsigned int s(1); s < k; s++)
+			{
+				float minorPosition(float(isTransposed ? observerI : observerJ) + minorStep * float(s));
+				unsigned int lower((unsigned int)(floorf(minorPosition)));
+				unsigned int upper((unsigned int)(ceilf(minorPosition)));
+				float weight(minorPosition - float(lower));
+
+				unsigned int major((unsigned int)(int(isTransposed ? observerJ : observerI) + majorSign * int(s)));
+				float lowerHeight(isTransposed ? heights[lower][major] : heights[major][lower]);
+				float upperHeight(isTransposed ? heights[upper][major] : heights[major][upper]);
+
+				float height(lowerHeight + weight * (upperHeight - lowerHeight));
+				horizon = std::max(horizon, (height * heightScale - observerZ) / (float(s) * stepDistance));
+			}
+
+			float slope((heights[i][j] * heightScale - observerZ) / sqrtf(float(di) * di + float(dj) * dj));
+			visibility[i][j] = slope >= horizon ? 1.f : 0.f;
+		}
+	}
+}
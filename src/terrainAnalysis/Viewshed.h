@@ -0,0 +1,133 @@
+#ifndef VIEWSHED_H
+#define VIEWSHED_H
+
+/**
+*******************************************************************************
+*
+*  @file       Viewshed.h
+*
+*  @brief      Class to compute which pixels of a height map an observer sees,
+*				by radial sweeps from the observer
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include "tools/Types.h"
+
+//==============================================================================
+/**
+*  @class  Viewshed
+*  @brief  Viewshed is a class to compute the visibility mask of an observer
+*			standing on a height map.
+*			A pixel is visible if the slope from the observer to it is at least
+*			the highest slope towards the terrain between them.
+*			The grid is split into eight octants around the observer, where
+*			the distance along the major axis is the ring k and the distance along
+*			the minor axis q is at most k. The algorithms trade accuracy for speed:
+*			- R3 walks the line of sight of every pixel: exact, O(n^3)
+*			- R2 walks the rays to the border only and sets the pixels each ray
+*			passes closest to: O(n^2), a few pixels differ from R3
+*			- XDRAW interpolates the horizon of each ring from the previous one,
+*			as the reference planes of Wang: O(n^2) with the smallest constant,
+*			the errors grow with the distance to the observer
+*/
+//==============================================================================
+class Viewshed
+{
+public:
+	/**
+	 * @brief The Algorithm enum how the lines of sight are evaluated
+	 */
+	enum Algorithm
+	{
+		R3, //exact, one line of sight per pixel, for small height maps
+		R2, //one ray per pixel of the border
+		XDRAW //ring by ring, interpolated horizons
+	};
+
+	/**
+	 * @brief compute compute the pixels seen from an observer
+	 * @param heights the heights in the [0,1] range
+	 * @param n number of rows
+	 * @param m number of columns
+	 * @param observerI row of the observer
+	 * @param observerJ column of the observer
+	 * @param observerHeight height of the eyes of the observer above the terrain,
+	 * in units of the distance between two pixels
+	 * @param heightScale height of a pixel of value 1, in units of the distance between two pixels
+	 * @param algorithm the algorithm, R2 by default
+	 * @return a n*m matrix containing 1 for the visible pixels and 0 for the hidden ones
+	 * @throws std::runtime_error if the size of the heights is not n*m
+	 * or if the observer is outside of the height map
+	 */
+	static Types::float_matrix compute(Types::float_matrix const& heights, unsigned int n, unsigned int m,
+		unsigned int observerI, unsigned int observerJ, float observerHeight, float heightScale,
+		Algorithm algorithm = R2);
+
+//******************************************************************************
+private:
+	//No instance
+	Viewshed();
+
+	///@cond
+	/**
+	 * @brief The Octant struct the eighth of the grid between an axis and a diagonal.
+	 * The pixel at the ring k and at q along the minor axis, 0 <= q <= k, is at
+	 * observer + majorSign * k along the major axis and observer + minorSign * q along the minor axis
+	 */
+	struct Octant
+	{
+		bool isTransposed; //the major axis is the columns
+		int majorSign;
+		int minorSign;
+		unsigned int ringCount; //last ring inside the height map
+		unsigned int minorLimit; //last q inside the height map
+	};
+	///@endcond
+
+	/**
+	 * @brief getOctants
+	 * @return the eight octants around the observer, with their limits in the height map
+	 */
+	static std::vector<Octant> getOctants(unsigned int n, unsigned int m,
+										  unsigned int observerI, unsigned int observerJ);
+
+	/**
+	 * @brief isOwned know if an octant writes a pixel.
+	 * The axes and the diagonals belong to two octants, only one of them writes them
+	 * so that no two threads write the same pixel
+	 */
+	static bool isOwned(Octant const& octant, unsigned int k, unsigned int q);
+
+	/**
+	 * @brief sweepRays R2 in an octant: march the rays towards the pixels of the last ring
+	 * @param leftIndex first ray, the end of the ray e is at q = e in the last ring
+	 * @param rightIndex one past the last ray
+	 */
+	static void sweepRays(Types::float_matrix const& heights, Types::float_matrix &visibility,
+		Octant const& octant, unsigned int observerI, unsigned int observerJ,
+		float observerZ, float heightScale, unsigned int leftIndex, unsigned int rightIndex);
+
+	/**
+	 * @brief sweepRings XDRAW in an octant: the horizon of each pixel is interpolated
+	 * between the two pixels of the previous ring on its line of sight
+	 */
+	static void sweepRings(Types::float_matrix const& heights, Types::float_matrix &visibility,
+		Octant const& octant, unsigned int observerI, unsigned int observerJ,
+		float observerZ, float heightScale);
+
+	/**
+	 * @brief traceRows R3: walk the line of sight of each pixel of some rows
+	 * @param leftIndex first row
+	 * @param rightIndex one past the last row
+	 */
+	static void traceRows(Types::float_matrix const& heights, Types::float_matrix &visibility,
+		unsigned int m, unsigned int observerI, unsigned int observerJ,
+		float observerZ, float heightScale, unsigned int leftIndex, unsigned int rightIndex);
+};
+
+#endif // VIEWSHED_H
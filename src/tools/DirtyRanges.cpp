@@ -0,0 +1,83 @@
+/**
+*******************************************************************************
+*
+*  @file       DirtyRanges.cpp
+*
+*  @brief      Class to gather the ranges of elements changed since
+*				the last upload of a buffer
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <algorithm>
+
+#include "DirtyRanges.h"
+
+//------------------------------------------------------------------------------
+DirtyRanges::DirtyRanges():
+//------------------------------------------------------------------------------
+	m_ranges()
+//------------------------------------------------------------------------------
+{
+}
+
+//------------------------------------------------------------------------------
+void DirtyRanges::add(unsigned int first, unsigned int count)
+//------------------------------------------------------------------------------
+{
+	if(!count)
+		return;
+
+	std::pair<unsigned int, unsigned int> range(first, first + count);
+
+	//Keep the ranges sorted and disjoint: the overlapping and adjacent ones are merged
+	auto next(std::lower_bound(m_ranges.begin(), m_ranges.end(), range));
+
+	if(next != m_ranges.begin() && (next - 1)->second >= range.first)
+	{
+		--next;
+		range.first = next->first;
+	}
+
+	auto last(next);
+
+	while(last != m_ranges.end() && last->first <= range.second)
+	{
+		range.second = std::max(range.second, last->second);
+		++last;
+	}
+
+	m_ranges.insert(m_ranges.erase(next, last), range);
+}
+
+//------------------------------------------------------------------------------
+void DirtyRanges::clear()
+//------------------------------------------------------------------------------
+{
+	m_ranges.clear();
+}
+
+//------------------------------------------------------------------------------
+bool DirtyRanges::isEmpty() const
+//------------------------------------------------------------------------------
+{
+	return m_ranges.empty();
+}
+
+//------------------------------------------------------------------------------
+unsigned int DirtyRanges::getEnd() const
+//------------------------------------------------------------------------------
+{
+	return m_ranges.empty() ? 0 : m_ranges.back().second;
+}
+
+//------------------------------------------------------------------------------
+std::vector<std::pair<unsigned int, unsigned int>> const& DirtyRanges::getRanges() const
+//------------------------------------------------------------------------------
+{
+	return m_ranges;
+}
@@ -0,0 +1,73 @@
+#ifndef DIRTYRANGES_H
+#define DIRTYRANGES_H
+
+/**
+*******************************************************************************
+*
+*  @file       DirtyRanges.h
+*
+*  @brief      Class to gather the ranges of elements changed since
+*				the last upload of a buffer
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <vector>
+#include <utility>
+
+
+//==============================================================================
+/**
+*  @class  DirtyRanges
+*  @brief  DirtyRanges is a class to gather the ranges of elements changed in a buffer.
+*			The ranges are kept sorted and disjoint: the overlapping and adjacent
+*			ones are merged, so each element is uploaded at most once
+*/
+//==============================================================================
+class DirtyRanges
+{
+public:
+	DirtyRanges();
+
+	/**
+	 * @brief add note that some elements changed
+	 * @param first first element changed
+	 * @param count number of elements changed, nothing is added if 0
+	 */
+	void add(unsigned int first, unsigned int count);
+
+	/**
+	 * @brief clear forget all the ranges, after an upload
+	 */
+	void clear();
+
+	/**
+	 * @brief isEmpty
+	 * @return true if no element changed
+	 */
+	bool isEmpty() const;
+
+	/**
+	 * @brief getEnd
+	 * @return one past the last element changed, 0 if none
+	 */
+	unsigned int getEnd() const;
+
+	/**
+	 * @brief getRanges
+	 * @return the first element and one past the last element of each range, sorted
+	 */
+	std::vector<std::pair<unsigned int, unsigned int>> const& getRanges() const;
+
+//******************************************************************************
+private:
+	//first element and one past the last element of each range
+	std::vector<std::pair<unsigned int, unsigned int>> m_ranges;
+};
+
+#endif // DIRTYRANGES_H
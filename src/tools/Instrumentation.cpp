@@ -0,0 +1,272 @@
+/**
+*******************************************************************************
+*
+*  @file       Instrumentation.cpp
+*
+*  @brief      Classes to measure the time spent in the processing and
+*				the rendering functions and the memory they hold
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+#include "Instrumentation.h"
+#include "ParallelTool.h"
+
+//******************************************************************************
+//  static variables
+//******************************************************************************
+std::mutex Instrumentation::s_mutex;
+
+Instrumentation::TimerShard Instrumentation::s_timerShards[TIMER_SHARD_COUNT];
+
+std::map<const char*, long long> Instrumentation::s_bytes;
+
+std::map<const char*, ProcessingStats::CounterStats> Instrumentation::s_counters;
+
+std::atomic<bool> Instrumentation::s_isEnabled(true);
+
+//------------------------------------------------------------------------------
+std::string ProcessingStats::toString() const
+//------------------------------------------------------------------------------
+{
+	std::ostringstream stream;
+	stream << std::fixed << std::setprecision(1);
+
+	for(auto const& timer : timers)
+	{
+		TimerStats const& stats(timer.second);
+
+		//The busiest worker shows how well the work is balanced
+		double busiestWorkerMs(0.);
+
+		for(auto const& busyMs : stats.busyMsPerWorker)
+			busiestWorkerMs = std::max(busiestWorkerMs, busyMs.second);
+
+		stream << timer.first << ": " << stats.callCount << " calls, "
+			<< stats.totalMs << " ms total, " << stats.maxMs << " ms max, "
+			<< stats.busyMsPerWorker.size() << " threads, busiest "
+			<< busiestWorkerMs << " ms" << std::endl;
+	}
+
+	for(auto const& counter : counters)
+	{
+		CounterStats const& stats(counter.second);
+		long long const *values(stats.values.values);
+
+		stream << counter.first << ": ";
+
+		if(values[PerfCounters::CYCLES] > 0 && values[PerfCounters::INSTRUCTIONS] >= 0)
+		{
+			stream << std::setprecision(2) << "IPC "
+				<< double(values[PerfCounters::INSTRUCTIONS]) / double(values[PerfCounters::CYCLES]);
+		}
+		else
+			stream << "IPC unavailable";
+
+		//Misses per pixel tell if a stage is memory bound
+		for(int missCounter : {PerfCounters::CACHE_MISSES, PerfCounters::BRANCH_MISSES})
+		{
+			stream << ", " << PerfCounters::getCounterName(PerfCounters::Counter(missCounter));
+
+			if(values[missCounter] >= 0 && stats.pixelCount > 0)
+			{
+				stream << std::setprecision(3) << " per pixel "
+					<< double(values[missCounter]) / double(stats.pixelCount);
+			}
+			else
+				stream << " unavailable";
+		}
+
+		stream << std::setprecision(1) << std::endl;
+	}
+
+	for(auto const& counter : bytes)
+	{
+		stream << counter.first << ": " << double(counter.second) / (1024. * 1024.)
+			<< " MiB" << std::endl;
+	}
+
+	return stream.str();
+}
+
+//------------------------------------------------------------------------------
+void Instrumentation::setEnabled(bool isEnabled)
+//------------------------------------------------------------------------------
+{
+	s_isEnabled = isEnabled;
+}
+
+//------------------------------------------------------------------------------
+bool Instrumentation::isEnabled()
+//------------------------------------------------------------------------------
+{
+	return s_isEnabled;
+}
+
+//------------------------------------------------------------------------------
+void Instrumentation::addDuration(const char *name, double durationMs)
+//------------------------------------------------------------------------------
+{
+	unsigned int workerSlot(ParallelTool::getWorkerSlot());
+	TimerShard &shard(s_timerShards[workerSlot % TIMER_SHARD_COUNT]);
+
+	std::lock_guard<std::mutex> lock(shard.mutex);
+
+	ProcessingStats::TimerStats &stats(shard.timers[name]);
+
+	stats.callCount++;
+	stats.totalMs += durationMs;
+	stats.maxMs = std::max(stats.maxMs, durationMs);
+	stats.busyMsPerWorker[workerSlot] += durationMs;
+}
+
+//------------------------------------------------------------------------------
+void Instrumentation::addBytes(const char *name, long long bytes)
+//------------------------------------------------------------------------------
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+
+	s_bytes[name] += bytes;
+}
+
+//------------------------------------------------------------------------------
+void Instrumentation::setBytes(const char *name, long long bytes)
+//------------------------------------------------------------------------------
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+
+	s_bytes[name] = bytes;
+}
+
+//------------------------------------------------------------------------------
+void Instrumentation::addCounters(const char *name, PerfCounters::Sample const& sample,
+								  long long pixelCount)
+//------------------------------------------------------------------------------
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+
+	addCounterStats(s_counters[name], sample, 1, pixelCount);
+}
+
+//------------------------------------------------------------------------------
+ProcessingStats Instrumentation::getStats()
+//------------------------------------------------------------------------------
+{
+	ProcessingStats stats;
+
+	for(TimerShard &shard : s_timerShards)
+	{
+		std::lock_guard<std::mutex> lock(shard.mutex);
+
+		//The same literal may have several addresses if it is used in several files
+		for(auto const& timer : shard.timers)
+		{
+			ProcessingStats::TimerStats &timerStats(stats.timers[timer.first]);
+
+			timerStats.callCount += timer.second.callCount;
+			timerStats.totalMs += timer.second.totalMs;
+			timerStats.maxMs = std::max(timerStats.maxMs, timer.second.maxMs);
+
+			for(auto const& busyMs : timer.second.busyMsPerWorker)
+				timerStats.busyMsPerWorker[busyMs.first] += busyMs.second;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(s_mutex);
+
+	for(auto const& counter : s_counters)
+	{
+		addCounterStats(stats.counters[counter.first], counter.second.values,
+			counter.second.sampleCount, counter.second.pixelCount);
+	}
+
+	for(auto const& counter : s_bytes)
+		stats.bytes[counter.first] += counter.second;
+
+	return stats;
+}
+
+//------------------------------------------------------------------------------
+void Instrumentation::resetTimers()
+//------------------------------------------------------------------------------
+{
+	for(TimerShard &shard : s_timerShards)
+	{
+		std::lock_guard<std::mutex> lock(shard.mutex);
+
+		shard.timers.clear();
+	}
+
+	std::lock_guard<std::mutex> lock(s_mutex);
+
+	s_counters.clear();
+}
+
+//------------------------------------------------------------------------------
+void Instrumentation::addCounterStats(ProcessingStats::CounterStats &counterStats,
+		PerfCounters::Sample const& sample, unsigned int sampleCount, long long pixelCount)
+//------------------------------------------------------------------------------
+{
+	for(unsigned int counter(0); counter < PerfCounters::COUNTER_COUNT; counter++)
+	{
+		//A counter missing once makes the sum meaningless
+		if(sample.values[counter] < 0 || counterStats.values.values[counter] < 0)
+			counterStats.values.values[counter] = -1;
+		else
+			counterStats.values.values[counter] += sample.values[counter];
+	}
+
+	counterStats.sampleCount += sampleCount;
+	counterStats.pixelCount += pixelCount;
+}
+
+//------------------------------------------------------------------------------
+ScopedTimer::ScopedTimer(const char *name):
+//------------------------------------------------------------------------------
+	m_name(name),
+	m_isEnabled(Instrumentation::isEnabled()),
+	m_trace(name, "timer")
+//------------------------------------------------------------------------------
+{
+	if(m_isEnabled)
+		m_start = std::chrono::steady_clock::now();
+}
+
+//------------------------------------------------------------------------------
+ScopedTimer::~ScopedTimer()
+//------------------------------------------------------------------------------
+{
+	if(m_isEnabled)
+	{
+		std::chrono::duration<double, std::milli> duration(
+			std::chrono::steady_clock::now() - m_start);
+
+		Instrumentation::addDuration(m_name, duration.count());
+	}
+}
+
+//------------------------------------------------------------------------------
+ScopedCounters::ScopedCounters(const char *name, long long pixelCount):
+//------------------------------------------------------------------------------
+	m_name(name),
+	m_pixelCount(pixelCount),
+	m_isEnabled(PerfCounters::isEnabled())
+//------------------------------------------------------------------------------
+{
+}
+
+//------------------------------------------------------------------------------
+ScopedCounters::~ScopedCounters()
+//------------------------------------------------------------------------------
+{
+	if(m_isEnabled)
+		Instrumentation::addCounters(m_name, m_counters.stop(), m_pixelCount);
+}
@@ -0,0 +1,277 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+/**
+*******************************************************************************
+*
+*  @file       Instrumentation.h
+*
+*  @brief      Classes to measure the time spent in the processing and
+*				the rendering functions and the memory they hold
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <string>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+#include "Tracer.h"
+#include "PerfCounters.h"
+
+
+//==============================================================================
+/**
+*  @struct ProcessingStats
+*  @brief  ProcessingStats is a snapshot of the measures of the instrumentation
+*/
+//==============================================================================
+struct ProcessingStats
+{
+	/**
+	 * @brief The TimerStats struct gather the measures of the timers with the same name
+	 */
+	struct TimerStats
+	{
+		//number of measures
+		unsigned int callCount = 0;
+
+		//sum of the measures, of all the threads
+		double totalMs = 0.;
+
+		//longest measure
+		double maxMs = 0.;
+
+		//sum of the measures of each worker slot of ParallelTool since the last reset
+		std::map<unsigned int, double> busyMsPerWorker;
+	};
+
+	/**
+	 * @brief The CounterStats struct gather the hardware counters of the scopes with the same name
+	 */
+	struct CounterStats
+	{
+		//number of samples
+		unsigned int sampleCount = 0;
+
+		//sum of the samples, negative if a counter was not available
+		PerfCounters::Sample values = {{0, 0, 0, 0}};
+
+		//number of pixels processed by the scopes
+		long long pixelCount = 0;
+	};
+
+	//Timers by name
+	std::map<std::string, TimerStats> timers;
+
+	//Hardware counters by name, empty unless PerfCounters are enabled
+	std::map<std::string, CounterStats> counters;
+
+	//Memory held, by name
+	std::map<std::string, long long> bytes;
+
+	/**
+	 * @brief toString format the stats to display them
+	 * @return one line per timer and per byte counter
+	 */
+	std::string toString() const;
+};
+
+//==============================================================================
+/**
+*  @class  Instrumentation
+*  @brief  Instrumentation is a class to gather the measures of the whole application.
+*			Thread safe. The names have to be string literals: they are stored without copy.
+*/
+//==============================================================================
+class Instrumentation
+{
+public:
+	/**
+	 * @brief setEnabled start or stop the measures, enabled by default
+	 * @param isEnabled true to measure
+	 */
+	static void setEnabled(bool isEnabled);
+
+	/**
+	 * @brief isEnabled
+	 * @return true if the measures are enabled
+	 */
+	static bool isEnabled();
+
+	/**
+	 * @brief addDuration add a measure to a timer, from the calling thread.
+	 * Only the threads of the same worker slot wait for each other
+	 * @param name name of the timer, a string literal
+	 * @param durationMs the measure in milliseconds
+	 */
+	static void addDuration(const char *name, double durationMs);
+
+	/**
+	 * @brief addBytes change a byte counter
+	 * @param name name of the counter, a string literal
+	 * @param bytes the number of bytes allocated, or released if negative
+	 */
+	static void addBytes(const char *name, long long bytes);
+
+	/**
+	 * @brief setBytes set a byte counter
+	 * @param name name of the counter, a string literal
+	 * @param bytes the number of bytes held
+	 */
+	static void setBytes(const char *name, long long bytes);
+
+	/**
+	 * @brief addCounters add a sample of the hardware counters
+	 * @param name name of the scope, a string literal
+	 * @param sample the values of the counters
+	 * @param pixelCount the number of pixels processed in the scope
+	 */
+	static void addCounters(const char *name, PerfCounters::Sample const& sample, long long pixelCount);
+
+	/**
+	 * @brief getStats
+	 * @return a copy of all the measures
+	 */
+	static ProcessingStats getStats();
+
+	/**
+	 * @brief resetTimers forget the timers and hardware counters measures,
+	 * the byte counters are kept
+	 */
+	static void resetTimers();
+
+//******************************************************************************
+private:
+	//No instance
+	Instrumentation();
+
+	/**
+	 * @brief addCounterStats add samples to the stats of a scope. s_mutex has to be locked
+	 * @param counterStats the stats to update
+	 * @param sample the sum of the samples
+	 * @param sampleCount the number of samples
+	 * @param pixelCount the number of pixels processed
+	 */
+	static void addCounterStats(ProcessingStats::CounterStats &counterStats,
+		PerfCounters::Sample const& sample, unsigned int sampleCount, long long pixelCount);
+
+	///@cond
+	/**
+	 * @brief The TimerShard struct the timers measured by the threads of some worker slots
+	 */
+	struct TimerShard
+	{
+		//protect the timers
+		std::mutex mutex;
+
+		//Timers by name, the names are literals so their addresses are enough
+		std::map<const char*, ProcessingStats::TimerStats> timers;
+	};
+	///@endcond
+
+	//number of TimerShard, the worker slots share them modulo this count
+	static const unsigned int TIMER_SHARD_COUNT = 64;
+
+	//protect the byte and hardware counters
+	static std::mutex s_mutex;
+
+	//Timers, by worker slot
+	static TimerShard s_timerShards[TIMER_SHARD_COUNT];
+
+	//Byte counters by name
+	static std::map<const char*, long long> s_bytes;
+
+	//Hardware counters by name
+	static std::map<const char*, ProcessingStats::CounterStats> s_counters;
+
+	static std::atomic<bool> s_isEnabled;
+};
+
+//==============================================================================
+/**
+*  @class  ScopedTimer
+*  @brief  ScopedTimer measures the time until the end of the scope
+*			and adds it to the instrumentation. Also records a trace event
+*			when the tracer is enabled
+*/
+//==============================================================================
+class ScopedTimer
+{
+public:
+	/**
+	 * @brief ScopedTimer start the measure
+	 * @param name name of the timer, a string literal
+	 */
+	explicit ScopedTimer(const char *name);
+
+	/**
+	 * @brief ~ScopedTimer stop the measure and record it
+	 */
+	~ScopedTimer();
+
+//******************************************************************************
+private:
+	//No copy constructor
+	ScopedTimer(ScopedTimer const&);
+
+	//name of the timer
+	const char *m_name;
+
+	//time of the creation
+	std::chrono::steady_clock::time_point m_start;
+
+	//measures disabled when the timer was created
+	bool m_isEnabled;
+
+	//trace event of the same scope
+	ScopedTrace m_trace;
+};
+
+//==============================================================================
+/**
+*  @class  ScopedCounters
+*  @brief  ScopedCounters counts the hardware events until the end of the scope,
+*			in the calling thread and in the threads it launches,
+*			and adds them to the instrumentation. Does nothing unless PerfCounters are enabled
+*/
+//==============================================================================
+class ScopedCounters
+{
+public:
+	/**
+	 * @brief ScopedCounters start counting
+	 * @param name name of the scope, a string literal
+	 * @param pixelCount the number of pixels processed in the scope
+	 */
+	ScopedCounters(const char *name, long long pixelCount);
+
+	/**
+	 * @brief ~ScopedCounters stop counting and record the counts
+	 */
+	~ScopedCounters();
+
+//******************************************************************************
+private:
+	//No copy constructor
+	ScopedCounters(ScopedCounters const&);
+
+	const char *m_name;
+
+	long long m_pixelCount;
+
+	//counters disabled when the scope started
+	bool m_isEnabled;
+
+	PerfCounters m_counters;
+};
+
+#endif // INSTRUMENTATION_H
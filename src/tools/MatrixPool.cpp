@@ -0,0 +1,143 @@
+/**
+*******************************************************************************
+*
+*  @file       MatrixPool.cpp
+*
+*  @brief      Class to reuse the float matrices of the image processing
+*				between runs and between images of the same size
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include "MatrixPool.h"
+#include "Instrumentation.h"
+
+//******************************************************************************
+//  constant variables
+//******************************************************************************
+//name of the byte counter of all the pools
+const char * const BYTE_COUNTER_NAME = "Matrix pools";
+
+//------------------------------------------------------------------------------
+MatrixPool::MatrixPool(std::size_t byteBudget):
+//------------------------------------------------------------------------------
+	m_byteBudget(byteBudget),
+	m_pooledBytes(0),
+	m_allocationCount(0)
+//------------------------------------------------------------------------------
+{
+}
+
+//------------------------------------------------------------------------------
+MatrixPool::~MatrixPool()
+//------------------------------------------------------------------------------
+{
+	Instrumentation::addBytes(BYTE_COUNTER_NAME, -(long long)(m_pooledBytes));
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<MatrixPool> const& MatrixPool::getSharedPool()
+//------------------------------------------------------------------------------
+{
+	static std::shared_ptr<MatrixPool> sharedPool(std::make_shared<MatrixPool>());
+
+	return sharedPool;
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<Types::float_matrix> MatrixPool::acquire(unsigned int n, unsigned int m)
+//------------------------------------------------------------------------------
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	std::pair<unsigned int, unsigned int> size(n, m);
+	auto sizeIte(m_matrices.find(size));
+
+	if(sizeIte != m_matrices.end())
+	{
+		//A matrix only referenced by the pool is free. Nobody else can get a new reference
+		//to it without the lock, so it stays free
+		for(std::shared_ptr<Types::float_matrix> const& matrix : sizeIte->second)
+		{
+			if(matrix.use_count() == 1)
+				return matrix;
+		}
+	}
+
+	//Make room for the new matrix before allocating it
+	releaseFreeMatrices(m_byteBudget > getBytes(size) ? m_byteBudget - getBytes(size) : 0);
+
+	std::vector<std::shared_ptr<Types::float_matrix>> &matrices(m_matrices[size]);
+
+	matrices.push_back(std::make_shared<Types::float_matrix>(n, Types::float_line(m)));
+	m_pooledBytes += getBytes(size);
+	m_allocationCount++;
+	Instrumentation::addBytes(BYTE_COUNTER_NAME, (long long)(getBytes(size)));
+
+	return matrices.back();
+}
+
+//------------------------------------------------------------------------------
+void MatrixPool::trim()
+//------------------------------------------------------------------------------
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	releaseFreeMatrices(0);
+}
+
+//------------------------------------------------------------------------------
+void MatrixPool::releaseFreeMatrices(std::size_t byteBudget)
+//------------------------------------------------------------------------------
+{
+	for(auto sizeIte(m_matrices.begin()); sizeIte != m_matrices.end() && m_pooledBytes > byteBudget;)
+	{
+		std::vector<std::shared_ptr<Types::float_matrix>> &matrices(sizeIte->second);
+
+		for(auto ite(matrices.begin()); ite != matrices.end() && m_pooledBytes > byteBudget;)
+		{
+			if(ite->use_count() == 1)
+			{
+				ite = matrices.erase(ite);
+				m_pooledBytes -= getBytes(sizeIte->first);
+				Instrumentation::addBytes(BYTE_COUNTER_NAME, -(long long)(getBytes(sizeIte->first)));
+			}
+			else
+				++ite;
+		}
+
+		if(matrices.empty())
+			sizeIte = m_matrices.erase(sizeIte);
+		else
+			++sizeIte;
+	}
+}
+
+//------------------------------------------------------------------------------
+std::size_t MatrixPool::getBytes(std::pair<unsigned int, unsigned int> const& size)
+//------------------------------------------------------------------------------
+{
+	return std::size_t(size.first) * size.second * sizeof(float);
+}
+
+//------------------------------------------------------------------------------
+unsigned int MatrixPool::getAllocationCount() const
+//------------------------------------------------------------------------------
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return m_allocationCount;
+}
+
+//------------------------------------------------------------------------------
+std::size_t MatrixPool::getPooledBytes() const
+//------------------------------------------------------------------------------
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return m_pooledBytes;
+}
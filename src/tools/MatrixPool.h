@@ -0,0 +1,127 @@
+#ifndef MATRIXPOOL_H
+#define MATRIXPOOL_H
+
+/**
+*******************************************************************************
+*
+*  @file       MatrixPool.h
+*
+*  @brief      Class to reuse the float matrices of the image processing
+*				between runs and between images of the same size
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <map>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <cstddef>
+
+#include "Types.h"
+
+
+//==============================================================================
+/**
+*  @class  MatrixPool
+*  @brief  MatrixPool is a class to reuse the float matrices of the image processing.
+*			The matrices are sorted by size. A matrix handed out by acquire() is free again
+*			once every other shared_ptr to it has been released: no deleter nor
+*			control block is allocated, so the stage buffers of a steady state do not
+*			touch the heap. The worker threads of ParallelTool are still started, and
+*			allocated, on each call.
+*			Thread safe.
+*/
+//==============================================================================
+class MatrixPool
+{
+public:
+	/**
+	 * @brief MatrixPool constructor
+	 * @param byteBudget free matrices are released above this amount of memory
+	 */
+	MatrixPool(std::size_t byteBudget = DEFAULT_BYTE_BUDGET);
+
+	/**
+	 * @brief ~MatrixPool release all the matrices, the ones still used are kept by their users
+	 */
+	~MatrixPool();
+
+	/**
+	 * @brief getSharedPool get the pool shared by all the image processors
+	 * @return the shared pool
+	 */
+	static std::shared_ptr<MatrixPool> const& getSharedPool();
+
+	/**
+	 * @brief acquire get a matrix of a given size that nobody else uses.
+	 * Its content is undefined
+	 * @param n number of rows
+	 * @param m number of columns
+	 * @return the matrix, shared with the pool
+	 */
+	std::shared_ptr<Types::float_matrix> acquire(unsigned int n, unsigned int m);
+
+	/**
+	 * @brief trim release the free matrices
+	 */
+	void trim();
+
+	/**
+	 * @brief getAllocationCount
+	 * @return the number of matrices allocated since the creation of the pool
+	 */
+	unsigned int getAllocationCount() const;
+
+	/**
+	 * @brief getPooledBytes
+	 * @return the memory held by the pool, used or not
+	 */
+	std::size_t getPooledBytes() const;
+
+	//Default maximum amount of memory kept by a pool: 512 MiB
+	static const std::size_t DEFAULT_BYTE_BUDGET = std::size_t(512) << 20;
+
+//******************************************************************************
+private:
+	//No copy constructor
+	MatrixPool(MatrixPool const&);
+
+	/**
+	 * @brief releaseFreeMatrices release free matrices until the memory held
+	 * is below the budget. m_mutex has to be locked
+	 * @param byteBudget the memory to reach
+	 */
+	void releaseFreeMatrices(std::size_t byteBudget);
+
+	/**
+	 * @brief getBytes
+	 * @param size the size of a matrix
+	 * @return the memory used by a matrix of this size
+	 */
+	static std::size_t getBytes(std::pair<unsigned int, unsigned int> const& size);
+
+	//Matrices by size (rows, columns)
+	std::map<std::pair<unsigned int, unsigned int>,
+		std::vector<std::shared_ptr<Types::float_matrix>>> m_matrices;
+
+	//protect all the members
+	mutable std::mutex m_mutex;
+
+	//maximum memory kept when matrices are free
+	std::size_t m_byteBudget;
+
+	//memory held by m_matrices
+	std::size_t m_pooledBytes;
+
+	//number of matrices allocated
+	unsigned int m_allocationCount;
+};
+
+#endif // MATRIXPOOL_H
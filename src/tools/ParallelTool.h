@@ -17,12 +17,18 @@
 //  Include
 //******************************************************************************
 #include <thread>
+#include <atomic>
+#include <algorithm>
+
+#include "Tracer.h"
 
 
 //==============================================================================
 /**
 *  @class  ParallelTool
-*  @brief  ParallelTool is Class to lhandle functions to simplify parallel processing
+*  @brief  ParallelTool is Class to lhandle functions to simplify parallel processing.
+*			Header only, but each range is traced by a ScopedTrace:
+*			Tracer.cpp has to be linked with the code using it
 */
 //==============================================================================
 class ParallelTool
@@ -34,43 +40,88 @@ public:
 	*  @param functor: the functor to apply
 	*  @param leftIndex: the index of the begining of the part where processing is needed
 	*  @param rightIndex: the index of the end of the part where processing is needed
-	*  @param maxParallelism: maximum number of thread launched at the same time.
-	*	@default: std::thread::hardware_concurrency() (number of concurrent threads supported)
-	*  @param parallelismLvl: current level of parallelism @default: 1
+	*  @param maxParallelism: number of threads running the functor, the calling one included,
+	*	each on a range of the same size, at most one per index. @default: getDefaultParallelism()
 	*/
 	//--------------------------------------------------------------------------
 	template<class F> static void performInParallel(F const& functor, unsigned int leftIndex, unsigned int rightIndex,
-			unsigned char maxParallelism = std::thread::hardware_concurrency(),
-			unsigned char parallelismLvl = 1);
+			unsigned char maxParallelism = getDefaultParallelism());
+
+	//--------------------------------------------------------------------------
+	///Set the maximum number of threads used when none is given to performInParallel
+	/**
+	*  @param parallelism: the number of threads, 1 to process sequentially
+	*/
+	//--------------------------------------------------------------------------
+	static void setDefaultParallelism(unsigned char parallelism);
+
+	//--------------------------------------------------------------------------
+	///Get the maximum number of threads used when none is given to performInParallel
+	/**
+	*  @return the number of threads
+	*	@default: std::thread::hardware_concurrency() (number of concurrent threads supported)
+	*/
+	//--------------------------------------------------------------------------
+	static unsigned char getDefaultParallelism();
+
+	//--------------------------------------------------------------------------
+	///Get the slot of the calling thread in its performInParallel call
+	/**
+	*  @return 0 for the thread calling performInParallel, and outside of it,
+	*	1 to the number of threads - 1 for the threads it launches
+	*/
+	//--------------------------------------------------------------------------
+	static unsigned int getWorkerSlot();
+
+private:
+	//--------------------------------------------------------------------------
+	///Storage of the default parallelism, shared by all the translation units
+	//--------------------------------------------------------------------------
+	static std::atomic<unsigned char> &defaultParallelism();
+
+	//--------------------------------------------------------------------------
+	///Storage of the slot of the calling thread
+	//--------------------------------------------------------------------------
+	static unsigned int &workerSlot();
 
 };
 
 //------------------------------------------------------------------------------
 template<class F> void ParallelTool::performInParallel(
 		F const& functor, unsigned int leftIndex, unsigned int rightIndex,
-		unsigned char maxParallelism, unsigned char parallelismLvl)
+		unsigned char maxParallelism)
 //------------------------------------------------------------------------------
 {
-	parallelismLvl *= 2;
+	unsigned int indexCount(rightIndex > leftIndex ? rightIndex - leftIndex : 0);
+	unsigned int threadCount(std::min((unsigned int)(maxParallelism), indexCount));
 
-	//If we can increase parralelism, we split the workload into to threads
-	if(parallelismLvl <= maxParallelism)
+	//If we can increase parralelism, we split the workload and the threads into two
+	if(threadCount > 1)
 	{
-		unsigned int midIndex((unsigned int)(rightIndex / 2));
+		unsigned int leftThreadCount(threadCount / 2);
 
-		//launch a thread that perform the functor on the left side of the array
+		//the threads of the right side take the slots after the ones of the left side
+		unsigned int rightSlot(workerSlot() + leftThreadCount);
+
+		//each side gets a share of the indices proportional to its threads
+		unsigned int midIndex(leftIndex + (unsigned int)(
+			(unsigned long long)(indexCount) * leftThreadCount / threadCount));
+
+		//launch a thread that perform the functor on the right side of the array
 		std::thread parallelProcessing(
-			[&functor, midIndex, rightIndex, maxParallelism, parallelismLvl]()
+			[&functor, midIndex, rightIndex, threadCount, leftThreadCount, rightSlot]()
 			{
+				workerSlot() = rightSlot;
+
 				performInParallel(functor,
 						midIndex, rightIndex,
-						maxParallelism, maxParallelism);
+						(unsigned char)(threadCount - leftThreadCount));
 			});
 
-		//perform the functor on the right side
+		//perform the functor on the left side
 		performInParallel(functor,
 					leftIndex, midIndex,
-					maxParallelism, parallelismLvl);
+					(unsigned char)(leftThreadCount));
 
 		//wait for the first thread to end processing
 		parallelProcessing.join();
@@ -78,9 +129,50 @@ template<class F> void ParallelTool::performInParallel(
 	else
 	{
 		//Use the sequential function
+		ScopedTrace trace("performInParallel", "parallel", leftIndex, rightIndex);
+
 		functor(leftIndex, rightIndex);
 	}
 }
 
+//------------------------------------------------------------------------------
+inline void ParallelTool::setDefaultParallelism(unsigned char parallelism)
+//------------------------------------------------------------------------------
+{
+	defaultParallelism() = parallelism;
+}
+
+//------------------------------------------------------------------------------
+inline unsigned char ParallelTool::getDefaultParallelism()
+//------------------------------------------------------------------------------
+{
+	return defaultParallelism();
+}
+
+//------------------------------------------------------------------------------
+inline std::atomic<unsigned char> &ParallelTool::defaultParallelism()
+//------------------------------------------------------------------------------
+{
+	static std::atomic<unsigned char> parallelism(
+		(unsigned char)(std::thread::hardware_concurrency()));
+
+	return parallelism;
+}
+
+//------------------------------------------------------------------------------
+inline unsigned int ParallelTool::getWorkerSlot()
+//------------------------------------------------------------------------------
+{
+	return workerSlot();
+}
+
+//------------------------------------------------------------------------------
+inline unsigned int &ParallelTool::workerSlot()
+//------------------------------------------------------------------------------
+{
+	static thread_local unsigned int slot(0);
+
+	return slot;
+}
 
 #endif // PARALLELTOOL_H
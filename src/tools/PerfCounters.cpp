@@ -0,0 +1,164 @@
+/**
+*******************************************************************************
+*
+*  @file       PerfCounters.cpp
+*
+*  @brief      Class to count hardware events (cycles, instructions, cache and
+*				branch misses) of the calling thread and of the threads it launches
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+#include "PerfCounters.h"
+
+//******************************************************************************
+//  static variables
+//******************************************************************************
+std::atomic<bool> PerfCounters::s_isEnabled(false);
+
+#ifdef __linux__
+//******************************************************************************
+//  constant variables
+//******************************************************************************
+//perf configuration of each counter, in the order of PerfCounters::Counter
+const unsigned long long COUNTER_CONFIGS[PerfCounters::COUNTER_COUNT] =
+	{PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+	 PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+#endif
+
+//------------------------------------------------------------------------------
+PerfCounters::PerfCounters()
+//------------------------------------------------------------------------------
+{
+	for(unsigned int counter(0); counter < COUNTER_COUNT; counter++)
+		m_fileDescriptors[counter] = -1;
+
+#ifdef __linux__
+	if(s_isEnabled)
+	{
+		for(unsigned int counter(0); counter < COUNTER_COUNT; counter++)
+		{
+			perf_event_attr attributes;
+			memset(&attributes, 0, sizeof(attributes));
+
+			attributes.size = sizeof(attributes);
+			attributes.type = PERF_TYPE_HARDWARE;
+			attributes.config = COUNTER_CONFIGS[counter];
+			attributes.disabled = 1;
+			//count the worker threads launched by ParallelTool
+			attributes.inherit = 1;
+			//allowed with perf_event_paranoid up to 2
+			attributes.exclude_kernel = 1;
+			attributes.exclude_hv = 1;
+
+			//this thread, any cpu. Fails without a PMU or without permission
+			m_fileDescriptors[counter] = (int)(syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0));
+		}
+
+		for(unsigned int counter(0); counter < COUNTER_COUNT; counter++)
+		{
+			if(m_fileDescriptors[counter] >= 0)
+			{
+				ioctl(m_fileDescriptors[counter], PERF_EVENT_IOC_RESET, 0);
+				ioctl(m_fileDescriptors[counter], PERF_EVENT_IOC_ENABLE, 0);
+			}
+		}
+	}
+#endif
+}
+
+//------------------------------------------------------------------------------
+PerfCounters::~PerfCounters()
+//------------------------------------------------------------------------------
+{
+#ifdef __linux__
+	for(unsigned int counter(0); counter < COUNTER_COUNT; counter++)
+	{
+		if(m_fileDescriptors[counter] >= 0)
+			close(m_fileDescriptors[counter]);
+	}
+#endif
+}
+
+//------------------------------------------------------------------------------
+PerfCounters::Sample PerfCounters::stop()
+//------------------------------------------------------------------------------
+{
+	Sample sample;
+
+	for(unsigned int counter(0); counter < COUNTER_COUNT; counter++)
+	{
+		sample.values[counter] = -1;
+
+#ifdef __linux__
+		if(m_fileDescriptors[counter] >= 0)
+		{
+			ioctl(m_fileDescriptors[counter], PERF_EVENT_IOC_DISABLE, 0);
+
+			//the counts of the ended inherited threads are included
+			unsigned long long value;
+
+			if(read(m_fileDescriptors[counter], &value, sizeof(value)) == sizeof(value))
+				sample.values[counter] = (long long)(value);
+		}
+#endif
+	}
+
+	return sample;
+}
+
+//------------------------------------------------------------------------------
+void PerfCounters::setEnabled(bool isEnabled)
+//------------------------------------------------------------------------------
+{
+	s_isEnabled = isEnabled && isSupported();
+}
+
+//------------------------------------------------------------------------------
+bool PerfCounters::isEnabled()
+//------------------------------------------------------------------------------
+{
+	return s_isEnabled;
+}
+
+//------------------------------------------------------------------------------
+bool PerfCounters::isSupported()
+//------------------------------------------------------------------------------
+{
+#ifdef __linux__
+	return true;
+#else
+	return false;
+#endif
+}
+
+//------------------------------------------------------------------------------
+const char *PerfCounters::getCounterName(Counter counter)
+//------------------------------------------------------------------------------
+{
+	switch(counter)
+	{
+	case CYCLES:
+		return "cycles";
+	case INSTRUCTIONS:
+		return "instructions";
+	case CACHE_MISSES:
+		return "cache misses";
+	case BRANCH_MISSES:
+		return "branch misses";
+	default:
+		return "unknown";
+	}
+}
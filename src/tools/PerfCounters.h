@@ -0,0 +1,108 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+/**
+*******************************************************************************
+*
+*  @file       PerfCounters.h
+*
+*  @brief      Class to count hardware events (cycles, instructions, cache and
+*				branch misses) of the calling thread and of the threads it launches
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <atomic>
+
+
+//==============================================================================
+/**
+*  @class  PerfCounters
+*  @brief  PerfCounters is a class to count hardware events with perf_event_open.
+*			The counters of the calling thread are inherited by the threads
+*			it launches afterwards, their counts are added once they have ended.
+*			Only available on Linux, disabled by default. A counter that cannot be opened
+*			(no PMU in a virtual machine, restrictive perf_event_paranoid) stays invalid.
+*/
+//==============================================================================
+class PerfCounters
+{
+public:
+	/**
+	 * @brief The Counter enum lists the hardware events counted
+	 */
+	enum Counter
+	{
+		CYCLES,
+		INSTRUCTIONS,
+		CACHE_MISSES, //last level cache misses on most processors
+		BRANCH_MISSES,
+		COUNTER_COUNT
+	};
+
+	/**
+	 * @brief The Sample struct values of the counters, negative if not available
+	 */
+	struct Sample
+	{
+		long long values[COUNTER_COUNT];
+	};
+
+	/**
+	 * @brief PerfCounters open and start the counters if they are enabled
+	 */
+	PerfCounters();
+
+	/**
+	 * @brief ~PerfCounters close the counters
+	 */
+	~PerfCounters();
+
+	/**
+	 * @brief stop stop the counters and read them
+	 * @return the counts since the construction
+	 */
+	Sample stop();
+
+	/**
+	 * @brief setEnabled enable the counters created afterwards, stay disabled if not supported
+	 * @param isEnabled true to count
+	 */
+	static void setEnabled(bool isEnabled);
+
+	/**
+	 * @brief isEnabled
+	 * @return true if the counters are enabled
+	 */
+	static bool isEnabled();
+
+	/**
+	 * @brief isSupported
+	 * @return true if the counters can be used on this platform
+	 */
+	static bool isSupported();
+
+	/**
+	 * @brief getCounterName
+	 * @param counter a counter
+	 * @return a displayable name
+	 */
+	static const char *getCounterName(Counter counter);
+
+//******************************************************************************
+private:
+	//No copy constructor
+	PerfCounters(PerfCounters const&);
+
+	//file descriptors of the counters, negative if not opened
+	int m_fileDescriptors[COUNTER_COUNT];
+
+	static std::atomic<bool> s_isEnabled;
+};
+
+#endif // PERFCOUNTERS_H
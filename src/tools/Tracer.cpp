@@ -0,0 +1,163 @@
+/**
+*******************************************************************************
+*
+*  @file       Tracer.cpp
+*
+*  @brief      Classes to record when and on which thread the processing and
+*				the rendering functions run, exported as Chrome trace events
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <fstream>
+#include <stdexcept>
+
+#include "Tracer.h"
+
+//******************************************************************************
+//  static variables
+//******************************************************************************
+std::mutex Tracer::s_mutex;
+
+std::vector<Tracer::Event> Tracer::s_events;
+
+std::map<std::thread::id, unsigned int> Tracer::s_threadIndices;
+
+std::atomic<long long> Tracer::s_startUs(0);
+
+std::atomic<bool> Tracer::s_isEnabled(false);
+
+//------------------------------------------------------------------------------
+void Tracer::start()
+//------------------------------------------------------------------------------
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+
+	s_events.clear();
+	s_threadIndices.clear();
+	s_startUs = std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+	s_isEnabled = true;
+}
+
+//------------------------------------------------------------------------------
+void Tracer::stop()
+//------------------------------------------------------------------------------
+{
+	s_isEnabled = false;
+}
+
+//------------------------------------------------------------------------------
+bool Tracer::isEnabled()
+//------------------------------------------------------------------------------
+{
+	return s_isEnabled;
+}
+
+//------------------------------------------------------------------------------
+long long Tracer::getTime()
+//------------------------------------------------------------------------------
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count() - s_startUs;
+}
+
+//------------------------------------------------------------------------------
+void Tracer::addEvent(const char *name, const char *category, long long beginUs, long long endUs,
+					  long long leftIndex, long long rightIndex)
+//------------------------------------------------------------------------------
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+
+	//The tracer may have been stopped or restarted since the begin of the event
+	if(s_isEnabled && s_events.size() < MAX_EVENT_COUNT)
+	{
+		auto threadIndex(s_threadIndices.insert(std::make_pair(std::this_thread::get_id(),
+			(unsigned int)(s_threadIndices.size()))).first);
+
+		Event event = {name, category, beginUs, endUs - beginUs, threadIndex->second,
+			leftIndex, rightIndex};
+
+		s_events.push_back(event);
+	}
+}
+
+//------------------------------------------------------------------------------
+unsigned int Tracer::getEventCount()
+//------------------------------------------------------------------------------
+{
+	std::lock_guard<std::mutex> lock(s_mutex);
+
+	return (unsigned int)(s_events.size());
+}
+
+//------------------------------------------------------------------------------
+void Tracer::writeJson(std::string const& fileName)
+//------------------------------------------------------------------------------
+{
+	std::ofstream file(fileName.c_str());
+
+	if(!file)
+		throw std::runtime_error("Cannot write the trace file " + fileName);
+
+	std::lock_guard<std::mutex> lock(s_mutex);
+
+	file << "{\"traceEvents\":[" << std::endl;
+
+	for(unsigned int event(0); event < s_events.size(); event++)
+	{
+		Event const& currentEvent(s_events[event]);
+
+		//The names are literals without quotes nor backslashes
+		file << "{\"name\":\"" << currentEvent.name << "\",\"cat\":\"" << currentEvent.category
+			<< "\",\"ph\":\"X\",\"ts\":" << currentEvent.beginUs
+			<< ",\"dur\":" << currentEvent.durationUs
+			<< ",\"pid\":1,\"tid\":" << currentEvent.threadIndex;
+
+		if(currentEvent.leftIndex >= 0)
+		{
+			file << ",\"args\":{\"leftIndex\":" << currentEvent.leftIndex
+				<< ",\"rightIndex\":" << currentEvent.rightIndex << "}";
+		}
+
+		file << "}";
+
+		if(event + 1 < s_events.size())
+			file << ",";
+
+		file << std::endl;
+	}
+
+	file << "],\"displayTimeUnit\":\"ms\"}" << std::endl;
+
+	if(!file)
+		throw std::runtime_error("Cannot write the trace file " + fileName);
+}
+
+//------------------------------------------------------------------------------
+ScopedTrace::ScopedTrace(const char *name, const char *category,
+						 long long leftIndex, long long rightIndex):
+//------------------------------------------------------------------------------
+	m_name(name),
+	m_category(category),
+	m_beginUs(0),
+	m_leftIndex(leftIndex),
+	m_rightIndex(rightIndex),
+	m_isEnabled(Tracer::isEnabled())
+//------------------------------------------------------------------------------
+{
+	if(m_isEnabled)
+		m_beginUs = Tracer::getTime();
+}
+
+//------------------------------------------------------------------------------
+ScopedTrace::~ScopedTrace()
+//------------------------------------------------------------------------------
+{
+	if(m_isEnabled)
+		Tracer::addEvent(m_name, m_category, m_beginUs, Tracer::getTime(), m_leftIndex, m_rightIndex);
+}
@@ -0,0 +1,159 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+/**
+*******************************************************************************
+*
+*  @file       Tracer.h
+*
+*  @brief      Classes to record when and on which thread the processing and
+*				the rendering functions run, exported as Chrome trace events
+*
+*  @author     Andréas Meuleman
+*******************************************************************************
+*/
+
+
+//******************************************************************************
+//  Include
+//******************************************************************************
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+
+//==============================================================================
+/**
+*  @class  Tracer
+*  @brief  Tracer is a class to record begin and end times of named scopes.
+*			Disabled by default. The events are written in the Chrome trace event
+*			JSON format, readable by chrome://tracing and Perfetto.
+*			Thread safe. The names have to be string literals: they are stored without copy.
+*/
+//==============================================================================
+class Tracer
+{
+public:
+	/**
+	 * @brief start forget the previous events and start recording
+	 */
+	static void start();
+
+	/**
+	 * @brief stop stop recording, the events are kept until the next start
+	 */
+	static void stop();
+
+	/**
+	 * @brief isEnabled
+	 * @return true if the events are recorded
+	 */
+	static bool isEnabled();
+
+	/**
+	 * @brief getTime
+	 * @return the time in microseconds since the start of the recording
+	 */
+	static long long getTime();
+
+	/**
+	 * @brief addEvent record a complete event of the calling thread
+	 * @param name name of the event, a string literal
+	 * @param category category of the event, a string literal
+	 * @param beginUs begin of the event, as given by getTime()
+	 * @param endUs end of the event, as given by getTime()
+	 * @param leftIndex first index processed, not written if negative
+	 * @param rightIndex index after the last one processed
+	 */
+	static void addEvent(const char *name, const char *category, long long beginUs, long long endUs,
+						 long long leftIndex = -1, long long rightIndex = -1);
+
+	/**
+	 * @brief getEventCount
+	 * @return the number of events recorded since the start
+	 */
+	static unsigned int getEventCount();
+
+	/**
+	 * @brief writeJson write the recorded events
+	 * @param fileName name of the JSON file
+	 * @throws std::runtime_error if the file cannot be written
+	 */
+	static void writeJson(std::string const& fileName);
+
+	//Maximum number of events kept, the next ones are dropped
+	static const unsigned int MAX_EVENT_COUNT = 1u << 20;
+
+//******************************************************************************
+private:
+	//No instance
+	Tracer();
+
+	/**
+	 * @brief The Event struct a complete event
+	 */
+	struct Event
+	{
+		const char *name, *category;
+		long long beginUs, durationUs;
+		unsigned int threadIndex;
+		long long leftIndex, rightIndex;
+	};
+
+	//protect the members
+	static std::mutex s_mutex;
+
+	//recorded events
+	static std::vector<Event> s_events;
+
+	//small consecutive ids given to the threads, in order of appearance
+	static std::map<std::thread::id, unsigned int> s_threadIndices;
+
+	//time of start() in microseconds, since the epoch of the steady clock
+	static std::atomic<long long> s_startUs;
+
+	static std::atomic<bool> s_isEnabled;
+};
+
+//==============================================================================
+/**
+*  @class  ScopedTrace
+*  @brief  ScopedTrace records an event lasting until the end of the scope
+*/
+//==============================================================================
+class ScopedTrace
+{
+public:
+	/**
+	 * @brief ScopedTrace start the event
+	 * @param name name of the event, a string literal
+	 * @param category category of the event, a string literal
+	 * @param leftIndex first index processed, not written if negative
+	 * @param rightIndex index after the last one processed
+	 */
+	ScopedTrace(const char *name, const char *category,
+				long long leftIndex = -1, long long rightIndex = -1);
+
+	/**
+	 * @brief ~ScopedTrace end the event and record it
+	 */
+	~ScopedTrace();
+
+//******************************************************************************
+private:
+	//No copy constructor
+	ScopedTrace(ScopedTrace const&);
+
+	const char *m_name, *m_category;
+
+	long long m_beginUs, m_leftIndex, m_rightIndex;
+
+	//the tracer was disabled when the event started
+	bool m_isEnabled;
+};
+
+#endif // TRACER_H
@@ -17,6 +17,7 @@
 //******************************************************************************
 #include <QVector3D>
 #include <vector>
+#include <memory>
 
 
 //==============================================================================
@@ -43,6 +44,11 @@ public:
 	 */
 	typedef std::vector<float_line> float_matrix;
 
+	/**
+	 * @brief shared_matrix immutable image data shared without copy
+	 */
+	typedef std::shared_ptr<const float_matrix> shared_matrix;
+
 	/**
 	 * @brief int_line
 	 */
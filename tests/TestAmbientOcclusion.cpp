@@ -0,0 +1,39 @@
+#include "TestAmbientOcclusion.h"
+#include <algorithm>
+
+#include "terrainAnalysis/AmbientOcclusion.h"
+
+TestAmbientOcclusion::TestAmbientOcclusion()
+{
+}
+
+void TestAmbientOcclusion::testFlatGroundOpen()
+{
+	Types::float_matrix heights(40, Types::float_line(30, 0.5f));
+
+	Types::float_matrix accessibility(AmbientOcclusion::bake(heights, 40, 30, 10.f));
+
+	QCOMPARE(accessibility[0][0], 1.f);
+	QCOMPARE(accessibility[20][15], 1.f);
+}
+
+void TestAmbientOcclusion::testPitOccluded()
+{
+	//a bowl: the bottom sees less sky than the rim
+	Types::float_matrix heights(64, Types::float_line(64));
+
+	for(unsigned int i(0); i < 64; i++)
+	{
+		for(unsigned int j(0); j < 64; j++)
+		{
+			float distance((float(i) - 32.f) * (float(i) - 32.f) + (float(j) - 32.f) * (float(j) - 32.f));
+			heights[i][j] = std::min(1.f, distance / 400.f);
+		}
+	}
+
+	Types::float_matrix accessibility(AmbientOcclusion::bake(heights, 64, 64, 10.f));
+
+	QVERIFY(accessibility[32][32] < 0.8f);
+	QVERIFY(accessibility[32][32] < accessibility[32][45]);
+	QCOMPARE(accessibility[32][60], 1.f);
+}
@@ -0,0 +1,19 @@
+#ifndef TESTAMBIENTOCCLUSION_H
+#define TESTAMBIENTOCCLUSION_H
+
+#include <QString>
+#include <QtTest>
+
+class TestAmbientOcclusion : public QObject
+{
+	Q_OBJECT
+
+public:
+	TestAmbientOcclusion();
+
+private Q_SLOTS:
+	void testFlatGroundOpen();
+	void testPitOccluded();
+};
+
+#endif // TESTAMBIENTOCCLUSION_H
@@ -0,0 +1,50 @@
+#include "TestColourRamp.h"
+
+#include "rendering/ColourRamp.h"
+
+TestColourRamp::TestColourRamp()
+{
+}
+
+static bool isClose(QVector3D const& colour, float red, float green, float blue)
+{
+	return qAbs(colour.x() - red) < 1e-5f && qAbs(colour.y() - green) < 1e-5f && qAbs(colour.z() - blue) < 1e-5f;
+}
+
+void TestColourRamp::testEnds()
+{
+	//the former colour of the vertices, (h, 0, 1 - h)
+	QVERIFY(isClose(ColourRamp::getColour(ColourRamp::RED_BLUE, 0.f), 0.f, 0.f, 1.f));
+	QVERIFY(isClose(ColourRamp::getColour(ColourRamp::RED_BLUE, 0.5f), 0.5f, 0.f, 0.5f));
+	QVERIFY(isClose(ColourRamp::getColour(ColourRamp::RED_BLUE, 1.f), 1.f, 0.f, 0.f));
+
+	QVERIFY(isClose(ColourRamp::getColour(ColourRamp::GREYSCALE, 0.5f), 0.55f, 0.55f, 0.55f));
+
+	//the values are clamped
+	QVERIFY(isClose(ColourRamp::getColour(ColourRamp::RED_BLUE, -1.f), 0.f, 0.f, 1.f));
+	QVERIFY(isClose(ColourRamp::getColour(ColourRamp::RED_BLUE, 2.f), 1.f, 0.f, 0.f));
+
+	//the first and the last texels are the ends of the palette
+	std::vector<unsigned char> texels(ColourRamp::createTexels(ColourRamp::RED_BLUE, 256));
+	QCOMPARE(texels.size(), size_t(256 * 3));
+	QCOMPARE(int(texels[0]), 0);
+	QCOMPARE(int(texels[2]), 255);
+	QCOMPARE(int(texels[255 * 3]), 255);
+	QCOMPARE(int(texels[255 * 3 + 2]), 0);
+}
+
+void TestColourRamp::testTerrainStops()
+{
+	//on the stops: water, grass, rock and snow
+	QVERIFY(isClose(ColourRamp::getColour(ColourRamp::TERRAIN, 0.f), 0.1f, 0.2f, 0.6f));
+	QVERIFY(isClose(ColourRamp::getColour(ColourRamp::TERRAIN, 0.25f), 0.2f, 0.6f, 0.2f));
+	QVERIFY(isClose(ColourRamp::getColour(ColourRamp::TERRAIN, 0.6f), 0.55f, 0.45f, 0.3f));
+	QVERIFY(isClose(ColourRamp::getColour(ColourRamp::TERRAIN, 1.f), 1.f, 1.f, 1.f));
+
+	//between two stops, 0.5 is at 5/7 of the way from grass to rock
+	QVERIFY(isClose(ColourRamp::getColour(ColourRamp::TERRAIN, 0.5f),
+					0.2f + 5.f / 7.f * 0.35f, 0.6f - 5.f / 7.f * 0.15f, 0.2f + 5.f / 7.f * 0.1f));
+
+	//halfway between the rock and the snow stops
+	QVERIFY(isClose(ColourRamp::getColour(ColourRamp::TERRAIN, 0.925f), 0.8f, 0.8f, 0.8f));
+}
@@ -0,0 +1,19 @@
+#ifndef TESTCOLOURRAMP_H
+#define TESTCOLOURRAMP_H
+
+#include <QString>
+#include <QtTest>
+
+class TestColourRamp : public QObject
+{
+	Q_OBJECT
+
+public:
+	TestColourRamp();
+
+private Q_SLOTS:
+	void testEnds();
+	void testTerrainStops();
+};
+
+#endif // TESTCOLOURRAMP_H
@@ -0,0 +1,57 @@
+#include "TestContourExtractor.h"
+
+#include "terrainAnalysis/ContourExtractor.h"
+
+TestContourExtractor::TestContourExtractor()
+{
+}
+
+void TestContourExtractor::testSlope()
+{
+	//the heights grow along the rows: the isoline is a straight line across the columns
+	Types::float_matrix heights(11, Types::float_line(7));
+
+	for(unsigned int i(0); i < 11; i++)
+	{
+		for(unsigned int j(0); j < 7; j++)
+			heights[i][j] = float(i) / 10.f;
+	}
+
+	ContourExtractor extractor(std::make_shared<const Types::float_matrix>(heights), 11, 7);
+
+	for(float level : {0.55f, 0.25f})
+	{
+		Types::vertices_data segments(extractor.extract(level));
+
+		//two segments per cell of the row crossed, one per triangle
+		QCOMPARE(segments.size(), size_t(6 * 2 * 2));
+
+		for(QVector3D const& vertex : segments)
+		{
+			QVERIFY(qAbs(vertex.x() - level * 10.f) < 1e-4f);
+			QVERIFY(vertex.y() >= 0.f && vertex.y() <= 6.f);
+			QCOMPARE(vertex.z(), level);
+		}
+	}
+
+	QVERIFY(extractor.extract(1.5f).empty());
+}
+
+void TestContourExtractor::testCandidates()
+{
+	//a single peak on a flat ground: only the four cells around it are visited above the ground
+	Types::float_matrix heights(9, Types::float_line(9, 0.f));
+	heights[4][4] = 1.f;
+
+	ContourExtractor extractor(std::make_shared<const Types::float_matrix>(heights), 9, 9);
+
+	QCOMPARE(extractor.getCandidateCount(0.5f), 4u);
+	QCOMPARE(extractor.getCandidateCount(0.f), 64u);
+
+	//a closed line around the peak: one segment in each of the six triangles touching it
+	Types::vertices_data segments(extractor.extract(0.5f));
+	QCOMPARE(segments.size(), size_t(6 * 2));
+
+	for(QVector3D const& vertex : segments)
+		QVERIFY(qAbs(vertex.x() - 4.f) <= 0.5f && qAbs(vertex.y() - 4.f) <= 0.5f);
+}
@@ -0,0 +1,19 @@
+#ifndef TESTCONTOUREXTRACTOR_H
+#define TESTCONTOUREXTRACTOR_H
+
+#include <QString>
+#include <QtTest>
+
+class TestContourExtractor : public QObject
+{
+	Q_OBJECT
+
+public:
+	TestContourExtractor();
+
+private Q_SLOTS:
+	void testSlope();
+	void testCandidates();
+};
+
+#endif // TESTCONTOUREXTRACTOR_H
@@ -0,0 +1,70 @@
+#include "TestDirtyRanges.h"
+
+#include <algorithm>
+
+#include "tools/DirtyRanges.h"
+
+typedef std::vector<std::pair<unsigned int, unsigned int>> Ranges;
+
+TestDirtyRanges::TestDirtyRanges()
+{
+}
+
+void TestDirtyRanges::testMerging()
+{
+	DirtyRanges ranges;
+
+	QVERIFY(ranges.isEmpty());
+	QCOMPARE(ranges.getEnd(), 0u);
+
+	//added out of order, nothing for an empty range
+	ranges.add(20, 5);
+	ranges.add(2, 3);
+	ranges.add(10, 0);
+	QVERIFY(ranges.getRanges() == Ranges({{2, 5}, {20, 25}}));
+
+	//adjacent to the first one, overlapping the second one
+	ranges.add(5, 2);
+	ranges.add(18, 4);
+	QVERIFY(ranges.getRanges() == Ranges({{2, 7}, {18, 25}}));
+
+	//across both of them
+	ranges.add(4, 30);
+	QVERIFY(ranges.getRanges() == Ranges({{2, 34}}));
+	QCOMPARE(ranges.getEnd(), 34u);
+
+	ranges.clear();
+	QVERIFY(ranges.isEmpty());
+}
+
+void TestDirtyRanges::testPartialUpload()
+{
+	//the buffer holds the previous vertices, as Mesh::updateVBO leaves it
+	std::vector<float> vertices(100);
+
+	for(unsigned int vertex(0); vertex < vertices.size(); vertex++)
+		vertices[vertex] = float(vertex);
+
+	std::vector<float> buffer(vertices);
+	DirtyRanges ranges;
+
+	for(unsigned int vertex : {3u, 4u, 50u, 51u, 52u, 99u, 5u, 60u})
+	{
+		vertices[vertex] = -vertices[vertex];
+		ranges.add(vertex, 1);
+	}
+
+	//only the ranges, as glBufferSubData
+	unsigned int uploadedCount(0);
+
+	for(std::pair<unsigned int, unsigned int> const& range : ranges.getRanges())
+	{
+		std::copy(vertices.begin() + range.first, vertices.begin() + range.second, buffer.begin() + range.first);
+		uploadedCount += range.second - range.first;
+	}
+
+	//same content as a full upload, each vertex changed uploaded once
+	QVERIFY(buffer == vertices);
+	QCOMPARE(uploadedCount, 8u);
+	QCOMPARE(ranges.getRanges().size(), size_t(4));
+}
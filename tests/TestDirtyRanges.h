@@ -0,0 +1,19 @@
+#ifndef TESTDIRTYRANGES_H
+#define TESTDIRTYRANGES_H
+
+#include <QString>
+#include <QtTest>
+
+class TestDirtyRanges : public QObject
+{
+	Q_OBJECT
+
+public:
+	TestDirtyRanges();
+
+private Q_SLOTS:
+	void testMerging();
+	void testPartialUpload();
+};
+
+#endif // TESTDIRTYRANGES_H
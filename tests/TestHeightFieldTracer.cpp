@@ -0,0 +1,75 @@
+#include "TestHeightFieldTracer.h"
+
+#include <memory>
+
+#include "terrainAnalysis/HeightFieldTracer.h"
+
+TestHeightFieldTracer::TestHeightFieldTracer()
+{
+}
+
+void TestHeightFieldTracer::testVerticalRay()
+{
+	//a flat height map, lower in its first rows
+	Types::float_matrix heights(9, Types::float_line(9, 0.5f));
+
+	for(unsigned int j(0); j < 9; j++)
+		heights[0][j] = heights[1][j] = 0.f;
+
+	HeightFieldTracer tracer(std::make_shared<const Types::float_matrix>(heights), 9, 9, 10.f);
+
+	float tHit;
+	QVector3D normal;
+
+	QVERIFY(tracer.intersect(QVector3D(5.5f, 3.5f, 100.f), QVector3D(0.f, 0.f, -1.f),
+							 0.f, 1000.f, tHit, normal));
+	QVERIFY(qAbs(tHit - 95.f) < 1e-3f);
+	QVERIFY(qAbs(normal.z() - 1.f) < 1e-3f);
+
+	QVERIFY(tracer.intersect(QVector3D(0.5f, 3.5f, 100.f), QVector3D(0.f, 0.f, -1.f),
+							 0.f, 1000.f, tHit, normal));
+	QVERIFY(qAbs(tHit - 100.f) < 1e-3f);
+
+	//outside of the height map
+	QVERIFY(!tracer.intersect(QVector3D(12.f, 3.5f, 100.f), QVector3D(0.f, 0.f, -1.f),
+							  0.f, 1000.f, tHit, normal));
+
+	//the search stops before the ground
+	QVERIFY(!tracer.intersect(QVector3D(5.5f, 3.5f, 100.f), QVector3D(0.f, 0.f, -1.f),
+							  0.f, 90.f, tHit, normal));
+}
+
+void TestHeightFieldTracer::testLineOfSight()
+{
+	//a wall across the middle row
+	Types::float_matrix heights(17, Types::float_line(17, 0.f));
+
+	for(unsigned int j(0); j < 17; j++)
+		heights[8][j] = 1.f;
+
+	HeightFieldTracer tracer(std::make_shared<const Types::float_matrix>(heights), 17, 17, 4.f);
+
+	QVERIFY(!tracer.isVisible(QVector3D(2.f, 8.f, 1.f), QVector3D(14.f, 8.f, 1.f)));
+	QVERIFY(tracer.isVisible(QVector3D(2.f, 8.f, 6.f), QVector3D(14.f, 8.f, 6.f)));
+
+	//on the same side of the wall
+	QVERIFY(tracer.isVisible(QVector3D(2.f, 2.f, 1.f), QVector3D(6.f, 14.f, 1.f)));
+
+	QVERIFY(tracer.isOccluded(QVector3D(2.f, 8.f, 1.f), QVector3D(1.f, 0.f, 0.f), 100.f));
+	QVERIFY(!tracer.isOccluded(QVector3D(2.f, 8.f, 1.f), QVector3D(-1.f, 0.f, 0.f), 100.f));
+}
+
+void TestHeightFieldTracer::testDistantOrigin()
+{
+	//a wall across the middle row, seen from far enough for t + 1e-3 to round back to t
+	Types::float_matrix heights(17, Types::float_line(17, 0.f));
+
+	for(unsigned int j(0); j < 17; j++)
+		heights[8][j] = 1.f;
+
+	HeightFieldTracer tracer(std::make_shared<const Types::float_matrix>(heights), 17, 17, 4.f);
+
+	QVERIFY(tracer.isOccluded(QVector3D(40014.f, 8.5f, 1.f), QVector3D(-1.f, 0.f, 0.f), 1e5f));
+	QVERIFY(!tracer.isOccluded(QVector3D(40014.f, 8.5f, 6.f), QVector3D(-1.f, 0.f, 0.f), 1e5f));
+	QVERIFY(tracer.isVisible(QVector3D(-40000.f, 8.5f, 6.f), QVector3D(40000.f, 8.5f, 6.f)));
+}
@@ -0,0 +1,20 @@
+#ifndef TESTHEIGHTFIELDTRACER_H
+#define TESTHEIGHTFIELDTRACER_H
+
+#include <QString>
+#include <QtTest>
+
+class TestHeightFieldTracer : public QObject
+{
+	Q_OBJECT
+
+public:
+	TestHeightFieldTracer();
+
+private Q_SLOTS:
+	void testVerticalRay();
+	void testLineOfSight();
+	void testDistantOrigin();
+};
+
+#endif // TESTHEIGHTFIELDTRACER_H
@@ -0,0 +1,64 @@
+#include "TestHeightPyramid.h"
+
+#include "terrainAnalysis/HeightPyramid.h"
+
+TestHeightPyramid::TestHeightPyramid()
+{
+}
+
+void TestHeightPyramid::testCellMaximum()
+{
+	//a single peak raises the four cells around it
+	Types::float_matrix heights(4, Types::float_line(4, 0.f));
+	heights[1][2] = 1.f;
+
+	HeightPyramid pyramid(heights, 4, 4);
+
+	QCOMPARE(pyramid.getRowCount(0), 3u);
+	QCOMPARE(pyramid.getColumnCount(0), 3u);
+	QCOMPARE(pyramid.getMax(0, 0, 1), 1.f);
+	QCOMPARE(pyramid.getMax(0, 1, 2), 1.f);
+	QCOMPARE(pyramid.getMax(0, 0, 0), 0.f);
+	QCOMPARE(pyramid.getMax(0, 2, 0), 0.f);
+}
+
+void TestHeightPyramid::testOddSizeLevels()
+{
+	//6*4 cells, the last row and column of blocks are incomplete
+	Types::float_matrix heights(7, Types::float_line(5, 0.f));
+	heights[6][4] = 0.5f;
+	heights[0][0] = 0.25f;
+
+	HeightPyramid pyramid(heights, 7, 5);
+
+	QCOMPARE(pyramid.getLevelCount(), 4u);
+	QCOMPARE(pyramid.getRowCount(1), 3u);
+	QCOMPARE(pyramid.getColumnCount(1), 2u);
+	QCOMPARE(pyramid.getMax(1, 2, 1), 0.5f);
+	QCOMPARE(pyramid.getMax(1, 0, 0), 0.25f);
+	QCOMPARE(pyramid.getMax(1, 1, 0), 0.f);
+
+	unsigned int top(pyramid.getLevelCount() - 1);
+	QCOMPARE(pyramid.getRowCount(top), 1u);
+	QCOMPARE(pyramid.getColumnCount(top), 1u);
+	QCOMPARE(pyramid.getMax(top, 0, 0), 0.5f);
+}
+
+void TestHeightPyramid::testCellMinimum()
+{
+	//a single pit lowers the four cells around it and every block above them
+	Types::float_matrix heights(5, Types::float_line(5, 1.f));
+	heights[2][2] = 0.25f;
+
+	HeightPyramid pyramid(heights, 5, 5);
+
+	QCOMPARE(pyramid.getMin(0, 1, 1), 0.25f);
+	QCOMPARE(pyramid.getMin(0, 2, 2), 0.25f);
+	QCOMPARE(pyramid.getMin(0, 0, 0), 1.f);
+	QCOMPARE(pyramid.getMin(0, 3, 3), 1.f);
+	QCOMPARE(pyramid.getMax(0, 1, 1), 1.f);
+
+	unsigned int top(pyramid.getLevelCount() - 1);
+	QCOMPARE(pyramid.getMin(top, 0, 0), 0.25f);
+	QCOMPARE(pyramid.getMax(top, 0, 0), 1.f);
+}
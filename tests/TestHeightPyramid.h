@@ -0,0 +1,20 @@
+#ifndef TESTHEIGHTPYRAMID_H
+#define TESTHEIGHTPYRAMID_H
+
+#include <QString>
+#include <QtTest>
+
+class TestHeightPyramid : public QObject
+{
+	Q_OBJECT
+
+public:
+	TestHeightPyramid();
+
+private Q_SLOTS:
+	void testCellMaximum();
+	void testOddSizeLevels();
+	void testCellMinimum();
+};
+
+#endif // TESTHEIGHTPYRAMID_H
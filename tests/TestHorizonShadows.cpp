@@ -0,0 +1,105 @@
+#include "TestHorizonShadows.h"
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <math.h>
+
+#include "terrainAnalysis/HorizonShadows.h"
+#include "terrainAnalysis/HeightFieldTracer.h"
+
+TestHorizonShadows::TestHorizonShadows()
+{
+}
+
+void TestHorizonShadows::testWallShadow()
+{
+	//a wall of height 10 on the row 40, the light comes from +x at 45 degrees
+	Types::float_matrix heights(64, Types::float_line(48, 0.f));
+	heights[40] = Types::float_line(48, 1.f);
+
+	Types::float_matrix mask(HorizonShadows::computeShadowMask(heights, 64, 48,
+		QVector3D(1.f, 0.f, 1.f), 10.f));
+
+	for(unsigned int j(0); j < 48; j++)
+	{
+		QCOMPARE(mask[50][j], 1.f);
+		QCOMPARE(mask[40][j], 1.f);
+		QCOMPARE(mask[35][j], 0.f);
+		QCOMPARE(mask[31][j], 0.f);
+		QCOMPARE(mask[20][j], 1.f);
+	}
+}
+
+void TestHorizonShadows::testFlatGroundLit()
+{
+	Types::float_matrix heights(32, Types::float_line(40, 0.5f));
+
+	//oblique directions along both axes
+	for(QVector3D const& lightDir : {QVector3D(0.3f, -1.f, 0.1f), QVector3D(-1.f, 0.7f, 0.2f)})
+	{
+		Types::float_matrix mask(HorizonShadows::computeShadowMask(heights, 32, 40, lightDir, 10.f));
+
+		for(Types::float_line const& line : mask)
+			QVERIFY(std::all_of(line.begin(), line.end(), [](float lit){return lit == 1.f;}));
+	}
+}
+
+void TestHorizonShadows::testLightUnderHorizon()
+{
+	Types::float_matrix heights(8, Types::float_line(8, 0.5f));
+
+	Types::float_matrix mask(HorizonShadows::computeShadowMask(heights, 8, 8,
+		QVector3D(1.f, 1.f, -0.5f), 10.f));
+
+	QCOMPARE(mask[4][4], 0.f);
+}
+
+void TestHorizonShadows::testObliqueLightAsTracer()
+{
+	//rough hills: ridges are crossed between the rows, on the diagonals of the cells
+	unsigned int n(61), m(47);
+	Types::float_matrix heights(n, Types::float_line(m));
+
+	for(unsigned int i(0); i < n; i++)
+	{
+		for(unsigned int j(0); j < m; j++)
+		{
+			heights[i][j] = 0.5f + 0.3f * sinf(0.37f * float(i)) * cosf(0.29f * float(j)) +
+				0.1f * float((i * 7919u + j * 104729u) % 97u) / 97.f;
+		}
+	}
+
+	HeightFieldTracer tracer(std::make_shared<const Types::float_matrix>(heights), n, m, 10.f);
+
+	for(QVector3D const& lightDir : {QVector3D(0.7f, -0.4f, 0.35f), QVector3D(-0.2f, 1.f, 0.3f),
+									 QVector3D(-1.f, -0.9f, 0.5f), QVector3D(0.3f, 0.6f, 0.2f)})
+	{
+		Types::float_matrix mask(HorizonShadows::computeShadowMask(heights, n, m, lightDir, 10.f));
+
+		unsigned int wrongCount(0), grazingCount(0);
+
+		for(unsigned int i(0); i < n; i++)
+		{
+			for(unsigned int j(0); j < m; j++)
+			{
+				//slightly above the pixel, so that its own triangles do not hide it
+				auto isOccluded = [&](float offset)
+					{
+						return tracer.isOccluded(QVector3D(float(i), float(j), 10.f * heights[i][j] + offset),
+							lightDir.normalized(), std::numeric_limits<float>::infinity());
+					};
+
+				bool isOccludedAbove(isOccluded(1e-3f));
+
+				//the light grazes the terrain, the offset decides
+				if(isOccludedAbove != isOccluded(1e-4f))
+					grazingCount++;
+				else if(mask[i][j] != (isOccludedAbove ? 0.f : 1.f))
+					wrongCount++;
+			}
+		}
+
+		QVERIFY(grazingCount < n * m / 100);
+		QCOMPARE(wrongCount, 0u);
+	}
+}
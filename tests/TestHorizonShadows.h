@@ -0,0 +1,21 @@
+#ifndef TESTHORIZONSHADOWS_H
+#define TESTHORIZONSHADOWS_H
+
+#include <QString>
+#include <QtTest>
+
+class TestHorizonShadows : public QObject
+{
+	Q_OBJECT
+
+public:
+	TestHorizonShadows();
+
+private Q_SLOTS:
+	void testWallShadow();
+	void testFlatGroundLit();
+	void testLightUnderHorizon();
+	void testObliqueLightAsTracer();
+};
+
+#endif // TESTHORIZONSHADOWS_H
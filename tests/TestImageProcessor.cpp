@@ -1,4 +1,32 @@
 #include "TestImageProcessor.h"
+#include "imageProcessing/ImageProcessor.h"
+#include "tools/Instrumentation.h"
+#include "tools/ParallelTool.h"
+#include "tools/PerfCounters.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+//the allocations of the whole test program are counted while isCountingAllocations
+static std::atomic<bool> isCountingAllocations(false);
+static std::atomic<unsigned int> heapAllocationCount(0);
+
+void *operator new(std::size_t size)
+{
+	if(isCountingAllocations)
+		heapAllocationCount++;
+
+	void *pointer(std::malloc(size > 0 ? size : 1));
+	if(!pointer)
+		throw std::bad_alloc();
+
+	return pointer;
+}
+
+void operator delete(void *pointer) noexcept
+{
+	std::free(pointer);
+}
 
 TestImageProcessor::TestImageProcessor()
 {
@@ -8,3 +36,165 @@ void TestImageProcessor::testCase1()
 {
 	QVERIFY2(true, "Failure");
 }
+
+void TestImageProcessor::testStageBuffersReused()
+{
+	std::shared_ptr<MatrixPool> matrixPool(std::make_shared<MatrixPool>());
+
+	ImageProcessor imageProcessor;
+	imageProcessor.setMatrixPool(matrixPool);
+
+	Types::shared_matrix imageData(std::make_shared<const Types::float_matrix>(
+		64, Types::float_line(48, 0.5f)));
+
+	imageProcessor.setRawData(imageData, 64, 48);
+	unsigned int allocationCount(matrixPool->getAllocationCount());
+
+	//Same size, the results of the first run are not used anymore
+	for(int run(0); run < 3; run++)
+		imageProcessor.setRawData(imageData, 64, 48);
+
+	QCOMPARE(matrixPool->getAllocationCount(), allocationCount);
+}
+
+void TestImageProcessor::testSteadyStateWithoutHeap()
+{
+	//The worker threads started by performInParallel allocate their state: one thread only
+	unsigned char defaultParallelism(ParallelTool::getDefaultParallelism());
+	ParallelTool::setDefaultParallelism(1);
+
+	ImageProcessor imageProcessor;
+	imageProcessor.setMatrixPool(std::make_shared<MatrixPool>());
+
+	Types::shared_matrix imageData(std::make_shared<const Types::float_matrix>(
+		64, Types::float_line(48, 0.5f)));
+
+	//Fills the pool and the instrumentation entries
+	for(int run(0); run < 2; run++)
+		imageProcessor.setRawData(imageData, 64, 48);
+
+	heapAllocationCount = 0;
+	isCountingAllocations = true;
+
+	for(int run(0); run < 3; run++)
+		imageProcessor.setRawData(imageData, 64, 48);
+
+	isCountingAllocations = false;
+	ParallelTool::setDefaultParallelism(defaultParallelism);
+
+	QCOMPARE(heapAllocationCount.load(), 0u);
+}
+
+void TestImageProcessor::testStageBuffersKeptWhileShared()
+{
+	std::shared_ptr<MatrixPool> matrixPool(std::make_shared<MatrixPool>());
+
+	ImageProcessor imageProcessor;
+	imageProcessor.setMatrixPool(matrixPool);
+
+	Types::shared_matrix imageData(std::make_shared<const Types::float_matrix>(
+		16, Types::float_line(16, 0.5f)));
+
+	imageProcessor.setRawData(imageData, 16, 16);
+	Types::shared_matrix cannyData(imageProcessor.getCannyData());
+
+	imageProcessor.setRawData(imageData, 16, 16);
+
+	//The buffer still used must not be written again
+	QVERIFY(imageProcessor.getCannyData() != cannyData);
+}
+
+void TestImageProcessor::testStagesInstrumented()
+{
+	Instrumentation::resetTimers();
+
+	ImageProcessor imageProcessor;
+	imageProcessor.setRawData(Types::float_matrix(64, Types::float_line(48, 0.5f)), 64, 48);
+
+	ProcessingStats stats(Instrumentation::getStats());
+
+	QCOMPARE(stats.timers["Linear filtering"].callCount, 1u);
+	QVERIFY(stats.timers["applyLinearFilter"].callCount >= 2u);
+	QVERIFY(!stats.timers["applyCannyAlgorithm"].busyMsPerWorker.empty());
+	QVERIFY(stats.bytes["Canny data"] >= 64 * 48 * (long long)(sizeof(float)));
+	QVERIFY(stats.bytes["Raw data"] >= 64 * 48 * (long long)(sizeof(float)));
+}
+
+void TestImageProcessor::testBusyTimeByWorker()
+{
+	Instrumentation::resetTimers();
+
+	//Each call launches new threads, they take the same slots
+	for(int run(0); run < 3; run++)
+	{
+		ParallelTool::performInParallel([](unsigned int, unsigned int)
+		{
+			ScopedTimer timer("testBusyTimeByWorker");
+		}, 0, 4, 4);
+	}
+
+	ProcessingStats::TimerStats stats(Instrumentation::getStats().timers["testBusyTimeByWorker"]);
+
+	QCOMPARE(stats.callCount, 12u);
+	QCOMPARE((unsigned int)(stats.busyMsPerWorker.size()), 4u);
+
+	for(unsigned int slot(0); slot < 4; slot++)
+		QVERIFY(stats.busyMsPerWorker.count(slot) == 1);
+}
+
+void TestImageProcessor::testStagesWithoutCounters()
+{
+	bool hasThrown(false);
+
+	//Disabled, nothing is counted
+	PerfCounters::setEnabled(false);
+	Instrumentation::resetTimers();
+
+	try
+	{
+		ImageProcessor imageProcessor;
+		imageProcessor.setRawData(Types::float_matrix(64, Types::float_line(48, 0.5f)), 64, 48);
+	}
+	catch(...)
+	{
+		hasThrown = true;
+	}
+
+	QVERIFY(!hasThrown);
+	QVERIFY(Instrumentation::getStats().counters.empty());
+
+	PerfCounters::Sample sample(PerfCounters().stop());
+
+	for(unsigned int counter(0); counter < PerfCounters::COUNTER_COUNT; counter++)
+		QCOMPARE(sample.values[counter], -1ll);
+
+	//Enabled only where supported, the counters missing (no PMU, no permission) are negative
+	PerfCounters::setEnabled(true);
+	QCOMPARE(PerfCounters::isEnabled(), PerfCounters::isSupported());
+	Instrumentation::resetTimers();
+
+	try
+	{
+		ImageProcessor imageProcessor;
+		imageProcessor.setRawData(Types::float_matrix(64, Types::float_line(48, 0.5f)), 64, 48);
+	}
+	catch(...)
+	{
+		hasThrown = true;
+	}
+
+	PerfCounters::setEnabled(false);
+	QVERIFY(!hasThrown);
+
+	ProcessingStats stats(Instrumentation::getStats());
+	QCOMPARE(stats.counters.empty(), !PerfCounters::isSupported());
+
+	for(auto const& counter : stats.counters)
+	{
+		for(unsigned int value(0); value < PerfCounters::COUNTER_COUNT; value++)
+			QVERIFY(counter.second.values.values[value] >= -1);
+
+		if(counter.second.values.values[PerfCounters::CYCLES] < 0)
+			QVERIFY(stats.toString().find("IPC unavailable") != std::string::npos);
+	}
+}
@@ -13,6 +13,12 @@ public:
 
 private Q_SLOTS:
 	void testCase1();
+	void testStageBuffersReused();
+	void testSteadyStateWithoutHeap();
+	void testStageBuffersKeptWhileShared();
+	void testStagesInstrumented();
+	void testBusyTimeByWorker();
+	void testStagesWithoutCounters();
 };
 
 #endif // TESTIMAGEPROCESSOR_H
@@ -0,0 +1,64 @@
+#include "TestLevelStatistics.h"
+
+#include "terrainAnalysis/LevelStatistics.h"
+
+TestLevelStatistics::TestLevelStatistics()
+{
+}
+
+void TestLevelStatistics::testSmallImage()
+{
+	Types::float_matrix heights = {
+		{0.f, 0.5f, 1.f},
+		{0.25f, 0.75f, 0.5f}
+	};
+
+	LevelStatistics statistics(heights, 2, 3);
+
+	QCOMPARE(statistics.getPixelCount(), 6ull);
+	QCOMPARE(statistics.getPixelCountAbove(0.5f), 2ull);
+	QCOMPARE(statistics.getPixelCountAbove(-1.f), 6ull);
+	QCOMPARE(statistics.getPixelCountAbove(1.f), 0ull);
+	QVERIFY(qAbs(statistics.getAreaAbove(0.4f) - 4.f / 6.f) < 1e-6f);
+
+	//0.5 + 0.25 above 0.5, then 0.6 + 0.35 + 0.1 + 0.1 above 0.4
+	QVERIFY(qAbs(statistics.getVolumeAbove(0.5f) - 0.75) < 1e-6);
+	QVERIFY(qAbs(statistics.getVolumeAbove(0.4f) - 1.15) < 1e-6);
+	QVERIFY(qAbs(statistics.getVolumeAbove(1.f)) < 1e-6);
+}
+
+void TestLevelStatistics::testBruteForce()
+{
+	//enough pixels for several blocks of partial sums and several sorted ranges to merge
+	const unsigned int n(97), m(53);
+	Types::float_matrix heights(n, Types::float_line(m));
+
+	for(unsigned int i(0); i < n; i++)
+	{
+		for(unsigned int j(0); j < m; j++)
+			heights[i][j] = float((i * 37 + j * 101) % 211) / 210.f;
+	}
+
+	LevelStatistics statistics(heights, n, m);
+
+	for(float level : {0.f, 0.1f, 0.33f, 0.5f, 0.87f, 1.f})
+	{
+		unsigned long long count(0);
+		double volume(0.);
+
+		for(unsigned int i(0); i < n; i++)
+		{
+			for(unsigned int j(0); j < m; j++)
+			{
+				if(heights[i][j] > level)
+				{
+					count++;
+					volume += heights[i][j] - level;
+				}
+			}
+		}
+
+		QCOMPARE(statistics.getPixelCountAbove(level), count);
+		QVERIFY(qAbs(statistics.getVolumeAbove(level) - volume) < 1e-3);
+	}
+}
@@ -0,0 +1,19 @@
+#ifndef TESTLEVELSTATISTICS_H
+#define TESTLEVELSTATISTICS_H
+
+#include <QString>
+#include <QtTest>
+
+class TestLevelStatistics : public QObject
+{
+	Q_OBJECT
+
+public:
+	TestLevelStatistics();
+
+private Q_SLOTS:
+	void testSmallImage();
+	void testBruteForce();
+};
+
+#endif // TESTLEVELSTATISTICS_H
@@ -0,0 +1,44 @@
+#include "TestNormalMap.h"
+#include <math.h>
+
+#include "terrainAnalysis/NormalMap.h"
+
+TestNormalMap::TestNormalMap()
+{
+}
+
+void TestNormalMap::testFlatGroundUp()
+{
+	Types::float_matrix heights(5, Types::float_line(7, 0.3f));
+
+	std::vector<unsigned char> texels(NormalMap::bake(heights, 5, 7, 10.f));
+
+	QCOMPARE(texels.size(), size_t(5 * 7 * 2));
+
+	QVector3D normal(NormalMap::unpack(texels[2 * (2 * 7 + 3)], texels[2 * (2 * 7 + 3) + 1]));
+	QVERIFY(normal.z() > 0.999f);
+}
+
+void TestNormalMap::testSlope()
+{
+	//rising by 0.1 per row, so by 1 per row with a height scale of 10: the normal is (-1, 0, 1)/sqrt(2)
+	Types::float_matrix heights(6, Types::float_line(4));
+
+	for(unsigned int i(0); i < 6; i++)
+	{
+		for(unsigned int j(0); j < 4; j++)
+			heights[i][j] = 0.1f * float(i);
+	}
+
+	std::vector<unsigned char> texels(NormalMap::bake(heights, 6, 4, 10.f));
+
+	//inside and on the borders, where the differences are one sided
+	for(unsigned int pixel : {0u, 2u * 4u + 1u, 5u * 4u + 3u})
+	{
+		QVector3D normal(NormalMap::unpack(texels[2 * pixel], texels[2 * pixel + 1]));
+
+		QVERIFY(qAbs(normal.x() + 1.f / sqrtf(2.f)) < 0.01f);
+		QVERIFY(qAbs(normal.y()) < 0.01f);
+		QVERIFY(qAbs(normal.z() - 1.f / sqrtf(2.f)) < 0.01f);
+	}
+}
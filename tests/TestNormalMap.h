@@ -0,0 +1,19 @@
+#ifndef TESTNORMALMAP_H
+#define TESTNORMALMAP_H
+
+#include <QString>
+#include <QtTest>
+
+class TestNormalMap : public QObject
+{
+	Q_OBJECT
+
+public:
+	TestNormalMap();
+
+private Q_SLOTS:
+	void testFlatGroundUp();
+	void testSlope();
+};
+
+#endif // TESTNORMALMAP_H
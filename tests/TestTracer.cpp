@@ -0,0 +1,67 @@
+#include "TestTracer.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "tools/Tracer.h"
+#include "tools/Instrumentation.h"
+#include "tools/ParallelTool.h"
+
+//Record the events, write them and read the JSON back
+static std::string writeJson()
+{
+	std::string fileName(QDir::temp().filePath("TestTracer.json").toStdString());
+	Tracer::writeJson(fileName);
+
+	std::ifstream file(fileName.c_str());
+	std::ostringstream json;
+	json << file.rdbuf();
+
+	return json.str();
+}
+
+TestTracer::TestTracer()
+{
+}
+
+void TestTracer::testStageAndParallelEvents()
+{
+	Tracer::start();
+
+	{
+		ScopedTimer timer("testStage");
+	}
+
+	//The calling thread takes the left half, a new thread the right half
+	ParallelTool::performInParallel([](unsigned int, unsigned int){}, 0, 8, 2);
+
+	Tracer::stop();
+
+	QCOMPARE(Tracer::getEventCount(), 3u);
+
+	std::string json(writeJson());
+
+	QVERIFY(json.find("{\"traceEvents\":[") == 0);
+	QVERIFY(json.find("\"name\":\"testStage\",\"cat\":\"timer\",\"ph\":\"X\"") != std::string::npos);
+	QVERIFY(json.find("\"ph\":\"B\"") == std::string::npos);
+
+	//The thread of the stage is the first seen
+	QVERIFY(json.find("\"pid\":1,\"tid\":0}") != std::string::npos);
+	QVERIFY(json.find("\"tid\":0,\"args\":{\"leftIndex\":0,\"rightIndex\":4}") != std::string::npos);
+	QVERIFY(json.find("\"tid\":1,\"args\":{\"leftIndex\":4,\"rightIndex\":8}") != std::string::npos);
+}
+
+void TestTracer::testDisabled()
+{
+	Tracer::start();
+	Tracer::stop();
+
+	{
+		ScopedTimer timer("testStage");
+	}
+
+	ParallelTool::performInParallel([](unsigned int, unsigned int){}, 0, 8, 2);
+
+	QCOMPARE(Tracer::getEventCount(), 0u);
+	QVERIFY(writeJson().find("\"name\"") == std::string::npos);
+}
@@ -0,0 +1,19 @@
+#ifndef TESTTRACER_H
+#define TESTTRACER_H
+
+#include <QString>
+#include <QtTest>
+
+class TestTracer : public QObject
+{
+	Q_OBJECT
+
+public:
+	TestTracer();
+
+private Q_SLOTS:
+	void testStageAndParallelEvents();
+	void testDisabled();
+};
+
+#endif // TESTTRACER_H
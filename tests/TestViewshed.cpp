@@ -0,0 +1,46 @@
+#include "TestViewshed.h"
+
+#include "terrainAnalysis/Viewshed.h"
+
+TestViewshed::TestViewshed()
+{
+}
+
+void TestViewshed::testFlatGround()
+{
+	//everything is seen from above a flat ground, whatever the algorithm
+	Types::float_matrix heights(21, Types::float_line(13, 0.5f));
+
+	for(Viewshed::Algorithm algorithm : {Viewshed::R3, Viewshed::R2, Viewshed::XDRAW})
+	{
+		Types::float_matrix visibility(Viewshed::compute(heights, 21, 13, 4, 9, 1.f, 10.f, algorithm));
+
+		for(unsigned int i(0); i < 21; i++)
+		{
+			for(unsigned int j(0); j < 13; j++)
+				QCOMPARE(visibility[i][j], 1.f);
+		}
+	}
+}
+
+void TestViewshed::testWall()
+{
+	//a wall across the row 10 hides the rows behind it, the wall itself is seen
+	Types::float_matrix heights(21, Types::float_line(21, 0.f));
+
+	for(unsigned int j(0); j < 21; j++)
+		heights[10][j] = 1.f;
+
+	for(Viewshed::Algorithm algorithm : {Viewshed::R3, Viewshed::R2, Viewshed::XDRAW})
+	{
+		Types::float_matrix visibility(Viewshed::compute(heights, 21, 21, 5, 10, 1.f, 10.f, algorithm));
+
+		for(unsigned int j(0); j < 21; j++)
+		{
+			QCOMPARE(visibility[2][j], 1.f);
+			QCOMPARE(visibility[10][j], 1.f);
+			QCOMPARE(visibility[15][j], 0.f);
+			QCOMPARE(visibility[20][j], 0.f);
+		}
+	}
+}
@@ -0,0 +1,19 @@
+#ifndef TESTVIEWSHED_H
+#define TESTVIEWSHED_H
+
+#include <QString>
+#include <QtTest>
+
+class TestViewshed : public QObject
+{
+	Q_OBJECT
+
+public:
+	TestViewshed();
+
+private Q_SLOTS:
+	void testFlatGround();
+	void testWall();
+};
+
+#endif // TESTVIEWSHED_H
@@ -1,6 +1,17 @@
 #include "TestImageProcessor.h"
 #include "TestHeightMapMesh.h"
 #include "TestLvlPlanMesh.h"
+#include "TestHorizonShadows.h"
+#include "TestAmbientOcclusion.h"
+#include "TestHeightPyramid.h"
+#include "TestHeightFieldTracer.h"
+#include "TestViewshed.h"
+#include "TestContourExtractor.h"
+#include "TestLevelStatistics.h"
+#include "TestNormalMap.h"
+#include "TestDirtyRanges.h"
+#include "TestColourRamp.h"
+#include "TestTracer.h"
 
 int main(int argc, char *argv[])
 {
@@ -13,5 +24,38 @@ int main(int argc, char *argv[])
 	TestLvlPlanMesh testLvlPlanMesh ;
 	QTest::qExec (&testLvlPlanMesh, argc, argv);
 
+	TestHorizonShadows testHorizonShadows ;
+	QTest::qExec (&testHorizonShadows, argc, argv);
+
+	TestAmbientOcclusion testAmbientOcclusion ;
+	QTest::qExec (&testAmbientOcclusion, argc, argv);
+
+	TestHeightPyramid testHeightPyramid ;
+	QTest::qExec (&testHeightPyramid, argc, argv);
+
+	TestHeightFieldTracer testHeightFieldTracer ;
+	QTest::qExec (&testHeightFieldTracer, argc, argv);
+
+	TestViewshed testViewshed ;
+	QTest::qExec (&testViewshed, argc, argv);
+
+	TestContourExtractor testContourExtractor ;
+	QTest::qExec (&testContourExtractor, argc, argv);
+
+	TestLevelStatistics testLevelStatistics ;
+	QTest::qExec (&testLevelStatistics, argc, argv);
+
+	TestNormalMap testNormalMap ;
+	QTest::qExec (&testNormalMap, argc, argv);
+
+	TestDirtyRanges testDirtyRanges ;
+	QTest::qExec (&testDirtyRanges, argc, argv);
+
+	TestColourRamp testColourRamp ;
+	QTest::qExec (&testColourRamp, argc, argv);
+
+	TestTracer testTracer ;
+	QTest::qExec (&testTracer, argc, argv);
+
     return 0;
 }
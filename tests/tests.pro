@@ -1,6 +1,4 @@
-QT       += testlib
-
-QT       -= gui
+QT       += testlib gui
 
 TARGET = tests
 CONFIG   += console
@@ -8,15 +6,56 @@ CONFIG   -= app_bundle
 
 TEMPLATE = app
 
+CONFIG += c++11
+
 DEFINES += QT_DEPRECATED_WARNINGS
 
 HEADERS += TestImageProcessor.h \
     TestHeightMapMesh.h \
-    TestLvlPlanMesh.h
+    TestLvlPlanMesh.h \
+    TestHorizonShadows.h \
+    TestAmbientOcclusion.h \
+    TestNormalMap.h \
+    TestHeightPyramid.h \
+    TestHeightFieldTracer.h \
+    TestViewshed.h \
+    TestContourExtractor.h \
+    TestLevelStatistics.h \
+    TestDirtyRanges.h \
+    TestColourRamp.h \
+    TestTracer.h
 
 SOURCES += main.cpp\
     TestImageProcessor.cpp \
     TestHeightMapMesh.cpp \
-    TestLvlPlanMesh.cpp
+    TestLvlPlanMesh.cpp \
+    TestHorizonShadows.cpp \
+    TestAmbientOcclusion.cpp \
+    TestNormalMap.cpp \
+    TestHeightPyramid.cpp \
+    TestHeightFieldTracer.cpp \
+    TestViewshed.cpp \
+    TestContourExtractor.cpp \
+    TestLevelStatistics.cpp \
+    TestDirtyRanges.cpp \
+    TestColourRamp.cpp \
+    TestTracer.cpp \
+    ../src/imageProcessing/ImageProcessor.cpp \
+    ../src/terrainAnalysis/HorizonShadows.cpp \
+    ../src/terrainAnalysis/AmbientOcclusion.cpp \
+    ../src/terrainAnalysis/NormalMap.cpp \
+    ../src/terrainAnalysis/HeightPyramid.cpp \
+    ../src/terrainAnalysis/HeightFieldTracer.cpp \
+    ../src/terrainAnalysis/Viewshed.cpp \
+    ../src/terrainAnalysis/ContourExtractor.cpp \
+    ../src/terrainAnalysis/LevelStatistics.cpp \
+    ../src/rendering/ColourRamp.cpp \
+    ../src/tools/MatrixPool.cpp \
+    ../src/tools/DirtyRanges.cpp \
+    ../src/tools/Instrumentation.cpp \
+    ../src/tools/Tracer.cpp \
+    ../src/tools/PerfCounters.cpp
+
+INCLUDEPATH += ../src
 
 DEFINES += SRCDIR=\\\"$$PWD/\\\"